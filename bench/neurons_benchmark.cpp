@@ -0,0 +1,313 @@
+/**
+ * @file   neurons_benchmark.cpp
+ * @author Jonathan Haab
+ * @date   Automn, 2017
+ * @brief  Contains the Google benchmarks of the simulation, run
+ * 		   « ./Neurons_bench --benchmark_out=bench.json --benchmark_out_format=json »
+ * 		   to keep the results of a commit
+ */
+
+
+#include "neuron.hpp"
+#include "network.hpp"
+#include "spikeFile.hpp"
+#include "spikeIndex.hpp"
+#include "spikeStatistics.hpp"
+#include "benchmark/benchmark.h"
+#include <vector>
+#include <random>
+#include <fstream>
+#include <algorithm>
+#include <string>
+#include <cstdio>
+
+/** scaled
+ *
+ * @param size 		the number of neurons
+ * @param threads 	the number of threads
+ * @param mode 		the connectivity
+ * @return the parameters of constants.hpp for size neurons, each one
+ * 		   receiving at most C_e excitatory connections so that the
+ * 		   stored connections of the largest networks fit in memory
+ */
+static Parameters scaled(int size, int threads, ConnectivityMode mode)
+{
+	Parameters parameters;
+	parameters.N = size;
+	parameters.connectionRatio = std::min(parameters.connectionRatio, double(C_e)/parameters.N_e());
+	parameters.threads = threads;
+	parameters.connectivity = mode;
+	parameters.seed = 2017;
+	parameters.plotStartTime = 0;
+	parameters.plotStopTime = 1e9; // les spikes ne sont rendus que pendant l'enregistrement
+	parameters.output = "/dev/null";
+	parameters.format = BINARY;
+	parameters.rasterRetention = 100; // le raster ne grandit pas avec le nombre d'itérations
+	return parameters;
+}
+
+/** NeuronUpdate
+ *  one step of a single neuron, driven by the poisson input
+ */
+static void NeuronUpdate(benchmark::State& state)
+{
+	Neuron neuron(EXCITATORY);
+	double step(0);
+
+	for(auto _ : state){
+		neuron.update(++step);
+		benchmark::DoNotOptimize(neuron.getV());
+	}
+	state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(NeuronUpdate);
+
+/** PopulationUpdate
+ *  one step of N neurons, without connections, arguments : N, precision
+ */
+static void PopulationUpdate(benchmark::State& state)
+{
+	Parameters parameters;
+	parameters.precision = Precision(state.range(1));
+	parameters.rasterRetention = 100;
+	NeuronPopulation neurons(state.range(0), int(0.8*state.range(0)), 2017, parameters);
+	std::vector<int> spiking;
+	long step(0);
+
+	for(auto _ : state){
+		spiking.clear();
+		neurons.update(++step, spiking);
+	}
+	state.SetItemsProcessed(state.iterations()*state.range(0));
+}
+BENCHMARK(PopulationUpdate)->ArgsProduct({{1000, 10000, 100000, 1000000}, {DOUBLE_PRECISION, SINGLE_PRECISION, FIXED_POINT}});
+
+/** NetworkUpdate
+ *  one step of the network, arguments : N, threads, connectivity (0 stored, 1 procedural)
+ */
+static void NetworkUpdate(benchmark::State& state)
+{
+	Network network("/dev/null", scaled(state.range(0), state.range(1), ConnectivityMode(state.range(2))));
+
+	// Les 100 premières ms ne sont pas mesurées, le réseau atteint son régime
+	double step(1000);
+	network.update(step);
+
+	for(auto _ : state){
+		step += network.getWindow();
+		network.update(step);
+	}
+	state.SetItemsProcessed(state.iterations()*network.getWindow()); // steps par seconde
+}
+BENCHMARK(NetworkUpdate)
+	->ArgsProduct({{1000, 10000, 100000}, {1, 2, 4, 8}, {STORED, PROCEDURAL}})
+	->Args({1000000, 1, PROCEDURAL})->Args({1000000, 8, PROCEDURAL})
+	->Unit(benchmark::kMillisecond)->UseRealTime();
+
+/** PrecisionUpdate
+ *  one window of a network of 100000 neurons, argument : precision of the potentials and of the inputs
+ */
+static void PrecisionUpdate(benchmark::State& state)
+{
+	Parameters parameters(scaled(100000, 1, STORED));
+	parameters.precision = Precision(state.range(0));
+	Network network("/dev/null", parameters);
+
+	double step(1000);
+	network.update(step);
+
+	for(auto _ : state){
+		step += network.getWindow();
+		network.update(step);
+	}
+	state.SetItemsProcessed(state.iterations()*network.getWindow());
+}
+BENCHMARK(PrecisionUpdate)->Arg(DOUBLE_PRECISION)->Arg(SINGLE_PRECISION)->Arg(FIXED_POINT)->Unit(benchmark::kMillisecond)->UseRealTime();
+
+/** BatchUpdate
+ *  one window of the network of constants.hpp for K instances of the point
+ *  (4.5, 0.9) at once, argument : K
+ */
+static void BatchUpdate(benchmark::State& state)
+{
+	Parameters parameters(scaled(N, 1, STORED));
+	parameters.output = "/tmp/Neurons_bench.bin"; // un fichier par instance : /dev/null ne peut pas être renommé
+	for(int k(0); k < state.range(0); ++k){
+		parameters.batch += (k == 0 ? "" : ",") + std::string("4.5:0.9");
+	}
+
+	{
+		Network network(parameters.output, parameters);
+		double step(1000);
+		network.update(step);
+
+		for(auto _ : state){
+			step += network.getWindow();
+			network.update(step);
+		}
+	}
+	for(int k(0); k < state.range(0); ++k){
+		std::remove((state.range(0) == 1 ? parameters.output : "/tmp/Neurons_bench_" + std::to_string(k) + ".bin").c_str());
+	}
+	state.SetItemsProcessed(state.iterations()*long(parameters.bufferDelay)*state.range(0)); // steps d'instance par seconde
+}
+BENCHMARK(BatchUpdate)->Arg(1)->Arg(2)->Arg(4)->Arg(8)->Unit(benchmark::kMillisecond)->UseRealTime();
+
+/** CreateConnections
+ *  construction of the stored connections of N neurons by a number of threads
+ */
+static void CreateConnections(benchmark::State& state)
+{
+	Parameters parameters(scaled(state.range(0), state.range(1), STORED));
+
+	for(auto _ : state){
+		Network network("/dev/null", parameters);
+		benchmark::DoNotOptimize(&network);
+	}
+	state.SetItemsProcessed(state.iterations()*state.range(0)*(parameters.C_e() + parameters.C_i()));
+}
+BENCHMARK(CreateConnections)->ArgsProduct({{1000, 10000, 100000}, {1, 4}})->Unit(benchmark::kMillisecond)->UseRealTime();
+
+/** DeliverSpikes
+ *  delivery by Network::deliver of the spikes of 5% of N neurons to their C_e+C_i
+ *  sorted targets, second argument : 0 targets in 32 bits, 1 compressed in 16 bits
+ */
+static void DeliverSpikes(benchmark::State& state)
+{
+	Parameters parameters(scaled(state.range(0), 1, STORED));
+	parameters.compressTargets = state.range(1) != 0;
+	Network network("/dev/null", parameters);
+
+	std::vector<int> spiking;
+	for(int i(0); i < parameters.N; i += 20) spiking.push_back(i);
+	long step(0);
+
+	for(auto _ : state){
+		network.deliver(++step, spiking);
+		benchmark::ClobberMemory();
+	}
+	const double synapses(double(parameters.N)*(parameters.C_e() + parameters.C_i()));
+	state.SetItemsProcessed(state.iterations()*long(spiking.size()*synapses/parameters.N));
+	state.counters["bytesPerSynapse"] = network.getConnectionBytes()/synapses;
+}
+BENCHMARK(DeliverSpikes)->ArgsProduct({{1000, 10000, 100000}, {0, 1}});
+
+/** WriteSpikes
+ *  spike times of every neuron after 200 ms, printed by Network::writeSpikes
+ */
+static void WriteSpikes(benchmark::State& state)
+{
+	Network network("/dev/null", scaled(state.range(0), 1, PROCEDURAL));
+	network.update(2000);
+	std::ofstream out("/dev/null");
+
+	for(auto _ : state){
+		network.writeSpikes(out);
+	}
+	state.SetItemsProcessed(state.iterations()*state.range(0));
+}
+BENCHMARK(WriteSpikes)->RangeMultiplier(10)->Range(1000, 100000)->Unit(benchmark::kMillisecond);
+
+/** SpikeFile
+ *  spikes of 1000 steps of 12500 neurons at 4%, argument : 0 text, 1 binary, 3 indexed
+ */
+static void SpikeFile(benchmark::State& state)
+{
+	std::mt19937 generator(2017);
+	std::vector<std::vector<int>> steps(1000);
+	for(size_t s(0); s < steps.size(); ++s){
+		for(int i(0); i < N; ++i){
+			if(generator()%100 < 4) steps[s].push_back(i);
+		}
+	}
+
+	for(auto _ : state){
+		SpikeWriter* writer(SpikeWriter::create(SpikeFormat(state.range(0)), "/dev/null", h, N));
+		for(size_t s(0); s < steps.size(); ++s){
+			writer->writeStep(s, steps[s].data(), steps[s].size());
+		}
+		delete writer;
+	}
+	state.SetItemsProcessed(state.iterations()*steps.size());
+}
+BENCHMARK(SpikeFile)->Arg(TEXT)->Arg(BINARY)->Arg(INDEXED)->Unit(benchmark::kMillisecond);
+
+/** QuerySpikes
+ *  spikes of the neurons [1000, 1100) in the steps [10000, 11000) of 20000 steps
+ *  of 12500 neurons at 1%, argument : 1 read of the whole binary file, 3 indexed query
+ */
+static void QuerySpikes(benchmark::State& state)
+{
+	const SpikeFormat format(SpikeFormat(state.range(0)));
+	const std::string file(format == INDEXED ? "/tmp/neurons_bench.idx" : "/tmp/neurons_bench.bin");
+	const long first(1000), last(1100), from(10000), to(11000);
+
+	{
+		std::mt19937 generator(2017);
+		SpikeWriter* writer(SpikeWriter::create(format, file, h, N));
+		std::vector<int> ids;
+		for(long s(0); s < 20000; ++s){
+			ids.clear();
+			for(int i(0); i < N; ++i){
+				if(generator()%100 == 0) ids.push_back(i);
+			}
+			writer->writeStep(s, ids.data(), ids.size());
+		}
+		delete writer;
+	}
+
+	std::vector<SpikeEvent> spikes;
+	for(auto _ : state){
+		spikes.clear();
+		if(format == INDEXED){
+			SpikeIndex index(file);
+			index.spikes(first, last, from, to, spikes);
+		} else {
+			// Sans index, chaque step est décodé pour n'en garder que la fenêtre
+			SpikeReader reader(file);
+			std::vector<int> ids;
+			for(size_t c(0); c < reader.chunkCount(); ++c){
+				SpikeReader::Chunk chunk(reader.chunk(c));
+				for(uint32_t s(0); s < chunk.steps; ++s){
+					long step(chunk.firstStep + s);
+					if(step < from or step >= to) continue;
+					SpikeReader::readStep(chunk, s, ids);
+					for(size_t k(0); k < ids.size(); ++k){
+						if(ids[k] >= first and ids[k] < last) spikes.push_back(SpikeEvent{step, ids[k]});
+					}
+				}
+			}
+		}
+		benchmark::DoNotOptimize(spikes.data());
+	}
+	state.counters["spikes"] = spikes.size();
+	std::remove(file.c_str());
+}
+BENCHMARK(QuerySpikes)->Arg(BINARY)->Arg(INDEXED)->Unit(benchmark::kMicrosecond);
+
+/** Statistics
+ *  the spikes of SpikeFile kept as statistics instead of a file, summary written at the end
+ */
+static void Statistics(benchmark::State& state)
+{
+	std::mt19937 generator(2017);
+	std::vector<std::vector<int>> steps(1000);
+	for(size_t s(0); s < steps.size(); ++s){
+		for(int i(0); i < N; ++i){
+			if(generator()%100 < 4) steps[s].push_back(i);
+		}
+	}
+
+	for(auto _ : state){
+		SpikeStatistics statistics(N, N_e, h, 10, 1000);
+		for(size_t s(0); s < steps.size(); ++s){
+			statistics.record(s, steps[s].data(), steps[s].size());
+		}
+		std::ofstream out("/dev/null");
+		statistics.write(out);
+	}
+	state.SetItemsProcessed(state.iterations()*steps.size());
+}
+BENCHMARK(Statistics)->Unit(benchmark::kMillisecond);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,224 @@
+/**
+ * @file   accuracy.cpp
+ * @author Jonathan Haab
+ * @date   Automn, 2017
+ * @brief  contains the measures of the drift of the reduced precisions
+ */
+
+#include "accuracy.hpp"
+#include "neuronPopulation.hpp"
+#include "network.hpp"
+#include "precision.hpp"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+using namespace std;
+
+/** SpikeSteps
+ *  steps of the spikes of every neuron of a population
+ */
+typedef vector<vector<long>> SpikeSteps;
+
+/** simulate
+ *
+ * @param population 	a population at step 0
+ * @param current 		the current given to every neuron
+ * @param epspPeriod 	the steps between the EPSP received by a neuron, 0 without EPSP
+ * @param steps 		the number of steps
+ * @param J 			the EPSP
+ * @param potentials 	receives the potentials of every neuron after each step
+ * @return the steps of the spikes of every neuron
+ */
+static SpikeSteps simulate(NeuronPopulation& population, double current, int epspPeriod, long steps, double J, vector<vector<double>>& potentials)
+{
+	int n(population.size());
+	SpikeSteps spikes(n);
+	vector<int> spiking;
+
+	potentials.assign(steps, vector<double>(n));
+
+	for(long step(0); step < steps; ++step){
+
+		// Chaque neurone reçoit ses EPSP avec sa propre phase : les potentiels ne restent pas égaux
+		if(epspPeriod > 0){
+			for(int i(0); i < n; ++i){
+				if((step + i)%epspPeriod == 0) population.deliver(i, step, J);
+			}
+		}
+
+		spiking.clear();
+		population.updateTest(current, step + 1, spiking);
+
+		for(size_t k(0); k < spiking.size(); ++k) spikes[spiking[k]].push_back(step);
+		for(int i(0); i < n; ++i) potentials[step][i] = population.getV(i);
+	}
+	return spikes;
+}
+
+/** populationDrift
+ *
+ * @param precision 	the precision compared with double
+ * @param current 		the current given to every neuron, as in NeuronPopulation::updateTest
+ * @param epspPeriod 	the steps between the EPSP of J_e received by a neuron, each neuron
+ * 						with its own phase, 0 for the current alone
+ * @param neurons 		the number of neurons
+ * @param steps 		the number of steps
+ * @param parameters 	the model of the neurons
+ * @return the drift of the potentials and of the spike times
+ */
+PopulationDrift populationDrift(Precision precision, double current, int epspPeriod, int neurons, long steps, const Parameters& parameters)
+{
+	Parameters model(parameters), reference(parameters);
+	model.precision = precision;
+	model.batch.clear();
+	reference.precision = DOUBLE_PRECISION;
+	reference.batch.clear();
+
+	NeuronPopulation population(neurons, neurons, 0, model), exact(neurons, neurons, 0, reference);
+	vector<vector<double>> v, vExact;
+
+	SpikeSteps spikes(simulate(population, current, epspPeriod, steps, parameters.J_e, v));
+	SpikeSteps exactSpikes(simulate(exact, current, epspPeriod, steps, parameters.J_e, vExact));
+
+	PopulationDrift drift = {current, epspPeriod, 0, 0, 0, 0, 0, 0};
+
+	for(long step(0); step < steps; ++step){
+		for(int i(0); i < neurons; ++i){
+			drift.maxV = max(drift.maxV, fabs(v[step][i] - vExact[step][i]));
+			if(step + 1 == steps) drift.meanV += fabs(v[step][i] - vExact[step][i])/neurons;
+		}
+	}
+
+	// Le k-ième spike d'un neurone est comparé au k-ième en double
+	for(int i(0); i < neurons; ++i){
+
+		drift.spikes += spikes[i].size();
+		drift.referenceSpikes += exactSpikes[i].size();
+
+		size_t common(min(spikes[i].size(), exactSpikes[i].size()));
+		drift.shifted += max(spikes[i].size(), exactSpikes[i].size()) - common;
+
+		for(size_t k(0); k < common; ++k){
+			long shift(labs(spikes[i][k] - exactSpikes[i][k]));
+			if(shift > 0) drift.shifted += 1;
+			drift.maxShift = max(drift.maxShift, shift);
+		}
+	}
+	return drift;
+}
+
+/** networkFiring
+ *
+ * @param parameters 	the simulation, its precision and its seed
+ * @param seeds 		the number of seeds, parameters.seed and the next ones
+ * @return the statistics of the first instance over the recorded steps for each seed, no spike file is written
+ */
+vector<NetworkFiring> networkFiring(const Parameters& parameters, int seeds)
+{
+	vector<NetworkFiring> result;
+
+	for(int s(0); s < seeds; ++s){
+
+		// Les statistiques sont gardées en mémoire : le fichier qui les nomme n'est jamais écrit
+		Parameters run(parameters);
+		run.seed = parameters.seed + s;
+		run.randomSeed = false;
+		run.format = NO_SPIKE_FILE;
+		run.statistics = "accuracy";
+		run.checkpoint.clear();
+		run.restore.clear();
+
+		Network network(run.output, run);
+		double simStep(network.getStep()), totalSteps(run.totalSteps());
+
+		while(simStep < totalSteps){
+			simStep = min(simStep + network.getWindow(), totalSteps);
+			network.update(simStep);
+		}
+
+		const SpikeStatistics& statistics(*network.getStatistics());
+		NetworkFiring firing = {statistics.summary(true), statistics.summary(false)};
+		result.push_back(firing);
+	}
+	return result;
+}
+
+/** compare
+ *
+ * @param name 		the name of the statistic
+ * @param values 		its value for each seed in the precision
+ * @param reference 	its value for each seed in double
+ * @return the drift of the means, with the standard error of two independent samples
+ */
+static FiringDrift compare(const char* name, const vector<double>& values, const vector<double>& reference)
+{
+	double n(values.size()), mean(0), exact(0), variance(0), exactVariance(0);
+
+	for(size_t s(0); s < values.size(); ++s){
+		mean += values[s]/n;
+		exact += reference[s]/n;
+	}
+	for(size_t s(0); s < values.size(); ++s){
+		variance += (values[s] - mean)*(values[s] - mean)/max(n - 1, 1.0);
+		exactVariance += (reference[s] - exact)*(reference[s] - exact)/max(n - 1, 1.0);
+	}
+
+	// Avec une seule graine l'écart entre les graines est inconnu : z n'est défini que si les moyennes sont égales
+	double error(sqrt((variance + exactVariance)/n));
+	double z(mean == exact ? 0 : n < 2 ? numeric_limits<double>::quiet_NaN() : (mean - exact)/error);
+
+	FiringDrift drift = {name, mean, exact, exact != 0 ? (mean - exact)/exact : 0, z};
+	return drift;
+}
+
+/** firingDrift
+ *
+ * @param runs 		the statistics of each seed in the precision
+ * @param reference 	the statistics of the same seeds in double
+ * @return the drift of the rate, of the CV and of the Fano factor of the excitatory neurons
+ * @note a precision is statistically indistinguishable from double if every |z| is below 2
+ */
+vector<FiringDrift> firingDrift(const vector<NetworkFiring>& runs, const vector<NetworkFiring>& reference)
+{
+	vector<double> rate[2], cv[2], fano[2];
+	const vector<NetworkFiring>* sets[2] = {&runs, &reference};
+
+	for(int k(0); k < 2; ++k){
+		for(size_t s(0); s < sets[k]->size(); ++s){
+			rate[k].push_back((*sets[k])[s].excitatory.rate);
+			cv[k].push_back((*sets[k])[s].excitatory.cv);
+			fano[k].push_back((*sets[k])[s].excitatory.fano);
+		}
+	}
+
+	vector<FiringDrift> result;
+	result.push_back(compare("rate", rate[0], rate[1]));
+	result.push_back(compare("cv", cv[0], cv[1]));
+	result.push_back(compare("fano", fano[0], fano[1]));
+	return result;
+}
+
+/** writeDrift
+ *
+ * @param out 	receives the drift : a line for a population, a "key = values" line for each statistic of the network
+ */
+void writeDrift(ostream& out, Precision precision, const PopulationDrift& drift)
+{
+	out << precisionName(precision) << ".current " << drift.current << " epspPeriod " << drift.epspPeriod
+		<< " : maxV = " << drift.maxV << " meanV = " << drift.meanV
+		<< " spikes = " << drift.spikes << " " << drift.referenceSpikes
+		<< " shifted = " << drift.shifted << " maxShift = " << drift.maxShift << "\n";
+}
+
+void writeDrift(ostream& out, Precision precision, const vector<FiringDrift>& drift)
+{
+	bool indistinguishable(true);
+
+	for(size_t k(0); k < drift.size(); ++k){
+		out << precisionName(precision) << "." << drift[k].name << " = " << drift[k].mean << " " << drift[k].reference
+			<< " relative " << drift[k].relative << " z " << drift[k].z << "\n";
+		if(not (fabs(drift[k].z) < 2)) indistinguishable = false;
+	}
+	out << precisionName(precision) << ".indistinguishable = " << indistinguishable << "\n";
+}
@@ -0,0 +1,90 @@
+/**
+ * @file   accuracy.hpp
+ * @author Jonathan Haab
+ * @date   Automn, 2017
+ * @brief  drift of a simulation kept in float or in fixed point, measured against the same simulation in double
+ */
+
+#include <vector>
+#include <ostream>
+#include "parameters.hpp"
+#include "spikeStatistics.hpp"
+
+#ifndef ACCURACY_H
+#define ACCURACY_H
+
+/** PopulationDrift
+ *  difference of the potentials and of the spikes of a population in a
+ *  precision with the same population in double, step after step
+ */
+struct PopulationDrift
+{
+	double current; //!< Current given to every neuron
+	int epspPeriod; //!< Steps between the EPSP received by a neuron, 0 without EPSP
+	double maxV; //!< Largest difference of a potential (mV) over the neurons and the steps
+	double meanV; //!< Mean difference of the potentials at the last step (mV)
+	long spikes; //!< Number of spikes in the precision
+	long referenceSpikes; //!< Number of spikes in double
+	long shifted; //!< Spikes that are not at the same step as the spike of the same rank of their neuron in double, or have none
+	long maxShift; //!< Largest difference of the steps of two spikes of the same rank of a neuron
+};
+
+/** populationDrift
+ *
+ * @param precision 	the precision compared with double
+ * @param current 		the current given to every neuron, as in NeuronPopulation::updateTest
+ * @param epspPeriod 	the steps between the EPSP of J_e received by a neuron, each neuron
+ * 						with its own phase, 0 for the current alone
+ * @param neurons 		the number of neurons
+ * @param steps 		the number of steps
+ * @param parameters 	the model of the neurons
+ * @return the drift of the potentials and of the spike times
+ */
+PopulationDrift populationDrift(Precision precision, double current, int epspPeriod, int neurons, long steps, const Parameters& parameters = Parameters());
+
+/** NetworkFiring
+ *  firing statistics of one simulation of the network
+ */
+struct NetworkFiring
+{
+	PopulationSummary excitatory; //!< Statistics of the excitatory neurons
+	PopulationSummary inhibitory; //!< Statistics of the inhibitory neurons
+};
+
+/** networkFiring
+ *
+ * @param parameters 	the simulation, its precision and its seed
+ * @param seeds 		the number of seeds, parameters.seed and the next ones
+ * @return the statistics of the first instance over the recorded steps for each seed, no spike file is written
+ */
+std::vector<NetworkFiring> networkFiring(const Parameters& parameters, int seeds);
+
+/** FiringDrift
+ *  one statistic of the excitatory neurons over several seeds, in a precision and in double
+ */
+struct FiringDrift
+{
+	const char* name; //!< Name of the statistic
+	double mean; //!< Mean over the seeds in the precision
+	double reference; //!< Mean over the seeds in double
+	double relative; //!< Relative difference of the means
+	double z; //!< Difference of the means over its standard error : the seeds give the spread of the statistic
+};
+
+/** firingDrift
+ *
+ * @param runs 		the statistics of each seed in the precision
+ * @param reference 	the statistics of the same seeds in double
+ * @return the drift of the rate, of the CV and of the Fano factor of the excitatory neurons
+ * @note a precision is statistically indistinguishable from double if every |z| is below 2
+ */
+std::vector<FiringDrift> firingDrift(const std::vector<NetworkFiring>& runs, const std::vector<NetworkFiring>& reference);
+
+/** writeDrift
+ *
+ * @param out 	receives the drift : a line for a population, a "key = values" line for each statistic of the network
+ */
+void writeDrift(std::ostream& out, Precision precision, const PopulationDrift& drift);
+void writeDrift(std::ostream& out, Precision precision, const std::vector<FiringDrift>& drift);
+
+#endif
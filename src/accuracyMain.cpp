@@ -0,0 +1,64 @@
+/**
+ * @file   accuracyMain.cpp
+ * @author Jonathan Haab
+ * @date   Automn, 2017
+ * @brief  Measures the drift of the float and fixed point precisions against double
+ */
+
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <cstdlib>
+#include <algorithm>
+#include <stdexcept>
+#include "accuracy.hpp"
+
+
+using namespace std;
+
+int main(int argc, char* argv[])
+{
+	// --seeds=n est le seul argument du harnais, les autres sont ceux de la simulation
+	int seeds(4);
+	vector<char*> arguments(1, argv[0]);
+	for(int i(1); i < argc; ++i){
+		string argument(argv[i]);
+		if(argument.compare(0, 8, "--seeds=") == 0) seeds = max(1, atoi(argument.c_str() + 8));
+		else arguments.push_back(argv[i]);
+	}
+	
+	Parameters parameters; //!< the network whose firing statistics are compared
+	try {
+		parameters.parse(arguments.size(), arguments.data());
+	} catch(const invalid_argument& error){
+		cerr << error.what() << endl;
+		return 1;
+	}
+	if(parameters.randomSeed) parameters.seed = 1;
+	
+	// Les scénarios de updateTest : sous le seuil, sans courant, au-dessus du seuil, puis avec des EPSP
+	const double currents[] = {1.0, 0.0, 1.01, 1.0};
+	const int periods[] = {0, 0, 0, 7};
+	const Precision reduced[] = {SINGLE_PRECISION, FIXED_POINT};
+	
+	try {
+		parameters.precision = DOUBLE_PRECISION;
+		vector<NetworkFiring> reference(networkFiring(parameters, seeds));
+		
+		for(Precision precision : reduced){
+			
+			for(int s(0); s < 4; ++s){
+				writeDrift(cout, precision, populationDrift(precision, currents[s], periods[s], 64, 10000, parameters));
+			}
+			
+			parameters.precision = precision;
+			writeDrift(cout, precision, firingDrift(networkFiring(parameters, seeds), reference));
+		}
+	} catch(const runtime_error& error){
+		cerr << error.what() << endl;
+		return 1;
+	}
+	
+	return 0;
+}
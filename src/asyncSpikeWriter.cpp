@@ -0,0 +1,119 @@
+/**
+ * @file   asyncSpikeWriter.cpp
+ * @author Jonathan Haab
+ * @date   Automn, 2017
+ * @brief  contains all the methods of the background spike writer
+ */
+
+#include "asyncSpikeWriter.hpp"
+#include <chrono>
+#include <algorithm>
+
+using namespace std;
+
+/** Constructor
+ *
+ * @param writer 	the writer of the file, owned and only used by the background thread
+ * @param memory 	the bound, in bytes, of the memory used by the pages of spikes
+ * 				waiting to be written (two pages at least)
+ * @param pageSpikes 	the number of spikes of a page
+ */
+AsyncSpikeWriter::AsyncSpikeWriter(SpikeWriter* writer, size_t memory, size_t pageSpikes)
+	: writer(writer), pageSpikes(max(pageSpikes, size_t(1))),
+	  pages(max(memory/(this->pageSpikes*sizeof(int)), size_t(2))),
+	  full(pages.size()), empty(pages.size()), stopping(false), stalls(0)
+{
+	for(size_t p(0); p < pages.size(); ++p){
+		pages[p].ids.reserve(this->pageSpikes);
+		if(p > 0) empty.push(&pages[p]);
+	}
+	current = &pages[0];
+
+	background = thread(&AsyncSpikeWriter::write, this);
+}
+
+/** Destructor
+ * @note writes every page left and joins the background thread
+ */
+AsyncSpikeWriter::~AsyncSpikeWriter()
+{
+	if(not current->steps.empty()) send();
+
+	stopping.store(true, memory_order_release);
+	background.join();
+}
+
+/** writeStep
+ *
+ * @note copies the spikes in the current page, only waits when every
+ * 		 page is full and the background thread is late
+ */
+void AsyncSpikeWriter::writeStep(long step, const int* ids, size_t count)
+{
+	// Un step plus grand qu'une page est gardé entier, seul dans sa page
+	if(not current->steps.empty() and current->ids.size() + count > pageSpikes) send();
+
+	current->steps.push_back(step);
+	current->ids.insert(current->ids.end(), ids, ids + count);
+	current->stepEnds.push_back(current->ids.size());
+}
+
+/** getStalls
+ * @return the number of times the simulation waited for a free page
+ */
+long AsyncSpikeWriter::getStalls() const
+{
+	return stalls;
+}
+
+/** send
+ * @note gives the current page to the background thread and takes a free one
+ */
+void AsyncSpikeWriter::send()
+{
+	// Il y a autant de places que de pages : la file des pages pleines n'est jamais pleine
+	full.push(current);
+
+	if(not empty.pop(current)){
+		++stalls;
+		do {
+			this_thread::sleep_for(chrono::microseconds(50));
+		} while(not empty.pop(current));
+	}
+}
+
+/** write
+ * @note loop of the background thread
+ */
+void AsyncSpikeWriter::write()
+{
+	Page* page;
+
+	for(;;){
+
+		// La dernière page est envoyée avant stopping : si stopping est lu avant une file vide, tout est écrit
+		bool last(stopping.load(memory_order_acquire));
+
+		if(full.pop(page)){
+
+			size_t first(0);
+			for(size_t s(0); s < page->steps.size(); ++s){
+				writer->writeStep(page->steps[s], page->ids.data() + first, page->stepEnds[s] - first);
+				first = page->stepEnds[s];
+			}
+
+			page->steps.clear();
+			page->stepEnds.clear();
+			page->ids.clear();
+			empty.push(page);
+
+		} else if(last){
+			break;
+		} else {
+			this_thread::sleep_for(chrono::microseconds(200));
+		}
+	}
+
+	// Le fichier est complet quand le writer est détruit
+	writer.reset();
+}
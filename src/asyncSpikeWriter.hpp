@@ -0,0 +1,83 @@
+/**
+ * @file   asyncSpikeWriter.hpp
+ * @author Jonathan Haab
+ * @date   Automn, 2017
+ * @brief  writes the spikes on a background thread, the simulation only copies them
+ */
+
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <memory>
+#include "spikeFile.hpp"
+#include "spscQueue.hpp"
+
+#ifndef ASYNCSPIKEWRITER_H
+#define ASYNCSPIKEWRITER_H
+
+class AsyncSpikeWriter : public SpikeWriter
+{
+	public :
+
+		/** Constructor
+		 *
+		 * @param writer 	the writer of the file, owned and only used by the background thread
+		 * @param memory 	the bound, in bytes, of the memory used by the pages of spikes
+		 * 				waiting to be written (two pages at least)
+		 * @param pageSpikes 	the number of spikes of a page
+		 */
+		AsyncSpikeWriter(SpikeWriter* writer, size_t memory, size_t pageSpikes = 1 << 16);
+
+		/** Destructor
+		 * @note writes every page left and joins the background thread
+		 */
+		~AsyncSpikeWriter();
+
+		/** writeStep
+		 *
+		 * @note copies the spikes in the current page, only waits when every
+		 * 		 page is full and the background thread is late
+		 */
+		void writeStep(long step, const int* ids, size_t count) override;
+
+		/** getStalls
+		 * @return the number of times the simulation waited for a free page
+		 */
+		long getStalls() const;
+
+	private :
+
+		/** Page
+		 *  spikes of consecutive steps, written at once by the background thread
+		 */
+		struct Page
+		{
+			std::vector<long> steps; //!< Steps of the page
+			std::vector<size_t> stepEnds; //!< For each step, the end of its ids
+			std::vector<int> ids; //!< Ids of the spikes, step after step
+		};
+
+		/** send
+		 * @note gives the current page to the background thread and takes a free one
+		 */
+		void send();
+
+		/** write
+		 * @note loop of the background thread
+		 */
+		void write();
+
+		std::unique_ptr<SpikeWriter> writer; //!< Writer of the file
+		size_t pageSpikes; //!< Number of spikes of a page
+		std::vector<Page> pages; //!< Every page, there are enough of them to fill the memory
+		Page* current; //!< Page filled by the simulation
+
+		SpscQueue<Page*> full; //!< Pages waiting to be written
+		SpscQueue<Page*> empty; //!< Pages written, given back to the simulation
+		std::atomic<bool> stopping; //!< True once the last page is sent
+		long stalls; //!< Number of times the simulation waited for a free page
+
+		std::thread background; //!< Thread that writes the pages
+};
+
+#endif
@@ -0,0 +1,182 @@
+/**
+ * @file   checkpoint.cpp
+ * @author Jonathan Haab
+ * @date   Automn, 2017
+ * @brief  contains all the methods of the checkpoint files
+ */
+
+#include "checkpoint.hpp"
+#include <fstream>
+#include <stdexcept>
+#include <cstring>
+#include <cstdio>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+using namespace std;
+
+static const char checkpointMagic[8] = "NCHECKP";
+static const uint32_t checkpointVersion(1);
+
+/** aligned
+ * @return position rounded up to a multiple of 64 bytes, a cache line
+ */
+static uint64_t aligned(uint64_t position)
+{
+	return (position + 63) & ~uint64_t(63);
+}
+
+/** add
+ *
+ * @param name 	the name of the section, at most 23 characters
+ * @param data 	the array, it must stay valid until write
+ * @param bytes 	the size of the array
+ */
+void CheckpointWriter::add(const string& name, const void* data, size_t bytes)
+{
+	Part part = {name.substr(0, sizeof(CheckpointSection::name) - 1), data, bytes};
+	parts.push_back(part);
+}
+
+/** write
+ *
+ * @param file 	the name of the file
+ * @param step 	the step of the state
+ * @throw std::runtime_error if the file cannot be written
+ */
+void CheckpointWriter::write(const string& file, long step) const
+{
+	CheckpointHeader header;
+	memset(&header, 0, sizeof(header));
+	memcpy(header.magic, checkpointMagic, sizeof(header.magic));
+	header.version = checkpointVersion;
+	header.sectionCount = parts.size();
+	header.step = step;
+
+	vector<CheckpointSection> sections(parts.size());
+	uint64_t position(aligned(sizeof(header) + sections.size()*sizeof(CheckpointSection)));
+
+	for(size_t s(0); s < parts.size(); ++s){
+		memset(&sections[s], 0, sizeof(CheckpointSection));
+		memcpy(sections[s].name, parts[s].name.c_str(), parts[s].name.size());
+		sections[s].offset = position;
+		sections[s].bytes = parts[s].bytes;
+		position = aligned(position + parts[s].bytes);
+	}
+
+	// Écrit sous un autre nom puis renommé : un checkpoint interrompu ne remplace jamais le précédent,
+	// et deux processus qui écrivent le même fichier ne mélangent pas leurs données
+	string temporary(file + ".tmp" + to_string(getpid()));
+	ofstream out(temporary, ios::binary);
+	if(not out) throw runtime_error("cannot write the checkpoint '" + file + "'");
+
+	const char zeros[64] = {0};
+	uint64_t written(sizeof(header) + sections.size()*sizeof(CheckpointSection));
+
+	out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+	out.write(reinterpret_cast<const char*>(sections.data()), sections.size()*sizeof(CheckpointSection));
+
+	for(size_t s(0); s < parts.size(); ++s){
+		out.write(zeros, sections[s].offset - written);
+		out.write(static_cast<const char*>(parts[s].data), parts[s].bytes);
+		written = sections[s].offset + parts[s].bytes;
+	}
+	out.close();
+
+	if(not out or rename(temporary.c_str(), file.c_str()) != 0){
+		throw runtime_error("cannot write the checkpoint '" + file + "'");
+	}
+}
+
+/** Constructor
+ *
+ * @param file 	the name of a checkpoint file
+ * @throw std::runtime_error if the file cannot be mapped or is not a checkpoint
+ */
+CheckpointReader::CheckpointReader(const string& file)
+	: file(file), data(nullptr), size(0), header(nullptr), sections(nullptr)
+{
+	int descriptor(open(file.c_str(), O_RDONLY));
+	if(descriptor < 0) throw runtime_error("cannot read the checkpoint '" + file + "'");
+
+	struct stat status;
+	if(fstat(descriptor, &status) == 0) size = status.st_size;
+
+	if(size >= sizeof(CheckpointHeader)){
+		void* mapped(mmap(nullptr, size, PROT_READ, MAP_PRIVATE, descriptor, 0));
+		if(mapped != MAP_FAILED) data = static_cast<const uint8_t*>(mapped);
+	}
+	close(descriptor);
+
+	if(data == nullptr) throw runtime_error("'" + file + "' is not a checkpoint");
+
+	header = reinterpret_cast<const CheckpointHeader*>(data);
+	sections = reinterpret_cast<const CheckpointSection*>(data + sizeof(CheckpointHeader));
+
+	bool valid(memcmp(header->magic, checkpointMagic, sizeof(checkpointMagic)) == 0 and header->version == checkpointVersion
+			   and sizeof(CheckpointHeader) + header->sectionCount*sizeof(CheckpointSection) <= size);
+
+	for(uint32_t s(0); valid and s < header->sectionCount; ++s){
+		valid = sections[s].offset + sections[s].bytes <= size;
+	}
+
+	if(not valid){
+		munmap(const_cast<uint8_t*>(data), size);
+		throw runtime_error("'" + file + "' is not a valid checkpoint");
+	}
+}
+
+/** Destructor
+ * @note unmaps the file
+ */
+CheckpointReader::~CheckpointReader()
+{
+	munmap(const_cast<uint8_t*>(data), size);
+}
+
+/** getStep
+ * @return the step at which the state was saved
+ */
+long CheckpointReader::getStep() const
+{
+	return header->step;
+}
+
+/** has
+ * @return true if the file contains the section name
+ */
+bool CheckpointReader::has(const string& name) const
+{
+	for(uint32_t s(0); s < header->sectionCount; ++s){
+		if(name == sections[s].name) return true;
+	}
+	return false;
+}
+
+/** read
+ *
+ * @param name 	the name of a section
+ * @param bytes 	receives the size of the section
+ * @return the data of the section, in the mapped file
+ * @throw std::runtime_error if the section is missing
+ */
+const void* CheckpointReader::read(const string& name, size_t& bytes) const
+{
+	for(uint32_t s(0); s < header->sectionCount; ++s){
+		if(name == sections[s].name){
+			bytes = sections[s].bytes;
+			return data + sections[s].offset;
+		}
+	}
+	throw runtime_error("the checkpoint '" + file + "' has no " + name);
+}
+
+/** mismatch
+ * @throw std::runtime_error because the section name has not the expected size
+ */
+void CheckpointReader::mismatch(const string& name) const
+{
+	throw runtime_error("the section " + name + " of the checkpoint '" + file + "' does not match the parameters");
+}
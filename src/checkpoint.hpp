@@ -0,0 +1,178 @@
+/**
+ * @file   checkpoint.hpp
+ * @author Jonathan Haab
+ * @date   Automn, 2017
+ * @brief  binary snapshot of the state of a simulation, read back by mapping the file
+ */
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+#ifndef CHECKPOINT_H
+#define CHECKPOINT_H
+
+/** Checkpoint file
+ *
+ *  CheckpointHeader
+ *  CheckpointSection sections[sectionCount]
+ *  the data of each section, starting at a multiple of 64 bytes
+ */
+struct CheckpointHeader
+{
+	char magic[8]; //!< "NCHECKP" and a 0
+	uint32_t version; //!< Version of the format
+	uint32_t sectionCount; //!< Number of sections
+	int64_t step; //!< Step at which the state was saved
+	uint64_t reserved[5];
+};
+
+struct CheckpointSection
+{
+	char name[24]; //!< Name of the section, ended by a 0
+	uint64_t offset; //!< Position of the data in the file
+	uint64_t bytes; //!< Size of the data
+};
+
+/** CheckpointWriter
+ *  gathers named arrays, then writes them at once
+ */
+class CheckpointWriter
+{
+	public :
+
+		/** add
+		 *
+		 * @param name 	the name of the section, at most 23 characters
+		 * @param data 	the array, it must stay valid until write
+		 * @param bytes 	the size of the array
+		 */
+		void add(const std::string& name, const void* data, size_t bytes);
+
+		/** add
+		 *
+		 * @param name 	the name of the section
+		 * @param values 	the array, it must stay valid until write
+		 */
+		template<typename T, typename A>
+		void add(const std::string& name, const std::vector<T, A>& values)
+		{
+			add(name, values.data(), values.size()*sizeof(T));
+		}
+
+		/** write
+		 *
+		 * @param file 	the name of the file
+		 * @param step 	the step of the state
+		 * @throw std::runtime_error if the file cannot be written
+		 */
+		void write(const std::string& file, long step) const;
+
+	private :
+
+		/** Part
+		 *  section given to add
+		 */
+		struct Part
+		{
+			std::string name;
+			const void* data;
+			size_t bytes;
+		};
+
+		std::vector<Part> parts; //!< Sections to write
+};
+
+/** CheckpointReader
+ *  maps a checkpoint file in memory
+ */
+class CheckpointReader
+{
+	public :
+
+		/** Constructor
+		 *
+		 * @param file 	the name of a checkpoint file
+		 * @throw std::runtime_error if the file cannot be mapped or is not a checkpoint
+		 */
+		explicit CheckpointReader(const std::string& file);
+
+		/** Destructor
+		 * @note unmaps the file
+		 */
+		~CheckpointReader();
+
+		CheckpointReader(const CheckpointReader&) = delete;
+		CheckpointReader& operator=(const CheckpointReader&) = delete;
+
+		/** getStep
+		 * @return the step at which the state was saved
+		 */
+		long getStep() const;
+
+		/** has
+		 * @return true if the file contains the section name
+		 */
+		bool has(const std::string& name) const;
+
+		/** read
+		 *
+		 * @param name 	the name of a section
+		 * @param bytes 	receives the size of the section
+		 * @return the data of the section, in the mapped file
+		 * @throw std::runtime_error if the section is missing
+		 */
+		const void* read(const std::string& name, size_t& bytes) const;
+
+		/** read
+		 *
+		 * @param name 	the name of a section
+		 * @param values 	receives a copy of the section
+		 * @param count 	the number of values expected, any number if 0
+		 * @throw std::runtime_error if the section is missing or has not count values
+		 */
+		template<typename T, typename A>
+		void read(const std::string& name, std::vector<T, A>& values, size_t count = 0) const
+		{
+			size_t bytes;
+			const T* data(static_cast<const T*>(read(name, bytes)));
+
+			if(bytes%sizeof(T) != 0 or (count > 0 and bytes/sizeof(T) != count)){
+				mismatch(name);
+			}
+			values.assign(data, data + bytes/sizeof(T));
+		}
+
+		/** view
+		 *
+		 * @param name 	the name of a section
+		 * @param count 	the number of values expected
+		 * @return the values of the section, read in place in the mapped file : they stay valid as long as the reader
+		 * @throw std::runtime_error if the section is missing or has not count values
+		 */
+		template<typename T>
+		const T* view(const std::string& name, size_t count) const
+		{
+			size_t bytes;
+			const T* data(static_cast<const T*>(read(name, bytes)));
+
+			if(bytes != count*sizeof(T)) mismatch(name);
+			return data;
+		}
+
+	private :
+
+		/** mismatch
+		 * @throw std::runtime_error because the section name has not the expected size
+		 */
+		void mismatch(const std::string& name) const;
+
+		std::string file; //!< Name of the file
+		const uint8_t* data; //!< The mapped file
+		size_t size; //!< Size of the file
+		const CheckpointHeader* header;
+		const CheckpointSection* sections;
+};
+
+#endif
@@ -0,0 +1,390 @@
+/**
+ * @file   connectivity.cpp
+ * @author Jonathan Haab
+ * @date   Automn, 2017
+ * @brief  contains all the methods of the compressed sparse rows
+ */
+
+#include "connectivity.hpp"
+#include <algorithm>
+#include <stdexcept>
+
+using namespace std;
+
+/** reset
+ *
+ * @param sources 	the number of presynaptic neurons
+ * @note removes every connection and starts the counting pass
+ */
+void Connectivity::reset(int sources)
+{
+	offsets.assign(sources + 1, 0);
+	targets.clear();
+	shortTargets.clear();
+	segmentStarts.clear();
+	segmentCount = 0;
+	delays.clear();
+	cursor.clear();
+	attach();
+}
+
+/** count
+ *
+ * @param source 	the presynaptic neuron of a connection
+ * @note first pass : counts the connection without storing it
+ */
+void Connectivity::count(int source)
+{
+	offsets[source+1] += 1;
+}
+
+/** allocate
+ *
+ * @param delayed 			true to keep a delay for each connection
+ * @param compressedTargets 	the number of targets if they are kept in 16 bits, 0 to keep them in 32 bits
+ * @note ends the counting pass, computes the offsets and allocates the targets once
+ */
+void Connectivity::allocate(bool delayed, int compressedTargets)
+{
+	for(size_t i(1); i < offsets.size(); ++i){
+		offsets[i] += offsets[i-1];
+	}
+	allocateTargets(compressedTargets);
+	delays.assign(delayed ? offsets.back() : 0, 0);
+	attach();
+}
+
+/** allocateTargets
+ *
+ * @param compressedTargets 	the number of targets if they are kept in 16 bits, 0 to keep them in 32 bits
+ * @note allocates the targets of the offsets and starts the pass of add
+ */
+void Connectivity::allocateTargets(int compressedTargets)
+{
+	segmentCount = compressedTargets > 0 ? ((compressedTargets - 1) >> segmentBits) + 1 : 0;
+	targets.assign(segmentCount == 0 ? offsets.back() : 0, 0);
+	shortTargets.assign(segmentCount > 0 ? offsets.back() : 0, 0);
+	segmentStarts.clear();
+
+	// Tant qu'aucune cible n'y est ajoutée, un segment commence à la fin de la ligne
+	if(segmentCount > 1){
+		segmentStarts.resize(size_t(sources())*(segmentCount + 1));
+		for(int i(0); i < sources(); ++i){
+			uint32_t* starts(&segmentStarts[size_t(i)*(segmentCount + 1)]);
+			starts[0] = 0;
+			fill(starts + 1, starts + segmentCount + 1, uint32_t(offsets[i+1] - offsets[i]));
+		}
+	}
+	cursor.assign(offsets.begin(), offsets.end() - 1);
+}
+
+/** add
+ *
+ * @param source 	the presynaptic neuron
+ * @param target 	the postsynaptic neuron
+ * @param delay 	the steps added to the delay of the projection, kept if allocate was delayed
+ * @note second pass : the connections must be the counted ones, in the same order,
+ * 		 and the targets of a source in increasing order if they are compressed
+ */
+void Connectivity::add(int source, int target, uint8_t delay)
+{
+	if(not delays.empty()) delays[cursor[source]] = delay;
+
+	if(segmentCount == 0){
+		targets[cursor[source]++] = target;
+		return;
+	}
+
+	// Les cibles arrivent dans l'ordre : le segment de target et ceux d'avant commencent au plus tard ici
+	if(segmentCount > 1){
+		uint32_t* starts(&segmentStarts[size_t(source)*(segmentCount + 1)]);
+		uint32_t position(cursor[source] - offsets[source]);
+		for(int s(1); s <= (target >> segmentBits); ++s){
+			starts[s] = min(starts[s], position);
+		}
+	}
+	shortTargets[cursor[source]++] = uint16_t(target);
+}
+
+/** build
+ *
+ * @param workers 		the threads, each one adds the connections of a contiguous range of targets
+ * @param targetCount 	the number of targets
+ * @param inputs 		the number of sources of each target
+ * @param drawn 		the sources of every target, inputs after inputs, target after target
+ * @param drawnDelays 	the delay of each source in the same order, nullptr to keep no delays
+ * @param compressedTargets 	the number of targets if they are kept in 16 bits, 0 to keep them in 32 bits
+ * @note replaces count, allocate and add after reset : each thread counts the sources of its
+ * 		 targets, then writes them in place after those of the threads before it, so that
+ * 		 the targets of each source stay sorted whatever the number of threads
+ */
+void Connectivity::build(WorkerPool& workers, int targetCount, int inputs, const int* drawn, const uint8_t* drawnDelays, int compressedTargets)
+{
+	const int threads(workers.size()), n(sources());
+	vector<vector<uint32_t>> counts(threads);
+
+	workers.run([&](int t){
+		counts[t].assign(n, 0);
+		for(size_t k(size_t(targetCount)*t/threads*inputs); k < size_t(targetCount)*(t + 1)/threads*inputs; ++k){
+			counts[t][drawn[k]] += 1;
+		}
+	});
+
+	// Les comptes des threads deviennent, source par source, où chacun commence dans la ligne
+	workers.run([&](int t){
+		for(int s(long(n)*t/threads); s < long(n)*(t + 1)/threads; ++s){
+			uint32_t row(0);
+			for(int u(0); u < threads; ++u){
+				uint32_t count(counts[u][s]);
+				counts[u][s] = row;
+				row += count;
+			}
+			offsets[s+1] = row;
+		}
+	});
+	for(int s(0); s < n; ++s) offsets[s+1] += offsets[s];
+
+	// Les pages des cibles sont écrites la première fois par les threads qui les remplissent
+	targets.resize(offsets.back());
+	delays.resize(drawnDelays ? offsets.back() : 0);
+
+	workers.run([&](int t){
+		uint32_t* start(counts[t].data());
+		for(int i(long(targetCount)*t/threads); i < long(targetCount)*(t + 1)/threads; ++i){
+			for(size_t k(size_t(i)*inputs); k < size_t(i + 1)*inputs; ++k){
+				size_t position(offsets[drawn[k]] + start[drawn[k]]++);
+				targets[position] = i;
+				if(drawnDelays) delays[position] = drawnDelays[k];
+			}
+		}
+	});
+
+	attach();
+	if(compressedTargets > 0) compress(compressedTargets, &workers);
+}
+
+/** compress
+ *
+ * @param compressedTargets 	the number of targets, they are kept in 16 bits instead of targets
+ * @param workers 				the threads that compress a slice of the sources each, nullptr for the calling thread
+ */
+void Connectivity::compress(int compressedTargets, WorkerPool* workers)
+{
+	PlacedVector<int> plain;
+	plain.swap(targets);
+	allocateTargets(compressedTargets);
+
+	// Les lignes sont indépendantes : add ne touche que celle de sa source
+	auto compressSlice = [&](int t, int slices){
+		for(int i(long(sources())*t/slices); i < long(sources())*(t + 1)/slices; ++i){
+			for(size_t k(offsets[i]); k < offsets[i+1]; ++k){
+				add(i, plain[k], delays.empty() ? 0 : delays[k]);
+			}
+		}
+	};
+	if(workers) workers->run([&](int t){ compressSlice(t, workers->size()); });
+	else compressSlice(0, 1);
+	cursor.clear();
+	attach();
+}
+
+/** expand
+ *
+ * @note keeps the compressed targets in 32 bits again
+ */
+void Connectivity::expand()
+{
+	targets.resize(shortTargets.size());
+
+	for(int i(0); i < sources(); ++i){
+		int* out(targets.data() + offsets[i]);
+		for(int s(0); s < segmentCount; ++s){
+			ShortSpan row(shortTargetsOf(i, s));
+			for(const uint16_t* target(row.first); target != row.last; ++target) *out++ = row.base + *target;
+		}
+	}
+
+	shortTargets.clear();
+	shortTargets.shrink_to_fit();
+	segmentStarts.clear();
+	segmentCount = 0;
+	attach();
+}
+
+/** attach
+ *
+ * @note reads the connections in the owned arrays again, once they are allocated
+ */
+void Connectivity::attach()
+{
+	mapped.reset();
+	sourceCount = offsets.empty() ? 0 : offsets.size() - 1;
+	offsetData = offsets.data();
+	targetData = segmentCount == 0 ? targets.data() : nullptr;
+	shortData = segmentCount > 0 ? shortTargets.data() : nullptr;
+	startData = segmentStarts.empty() ? nullptr : segmentStarts.data();
+	delayData = delays.empty() ? nullptr : delays.data();
+}
+
+/** sources
+ * @return the number of presynaptic neurons
+ */
+int Connectivity::sources() const
+{
+	return sourceCount;
+}
+
+/** size
+ * @return the number of connections
+ */
+size_t Connectivity::size() const
+{
+	return offsetData ? offsetData[sourceCount] : 0;
+}
+
+/** bytes
+ * @return the memory used to store the connections, mapped or not
+ */
+size_t Connectivity::bytes() const
+{
+	if(mapped){
+		return (sourceCount + 1)*sizeof(size_t) + size()*(targetData ? sizeof(int) : sizeof(uint16_t))
+			   + (startData ? size_t(sourceCount)*(segmentCount + 1)*sizeof(uint32_t) : 0) + (delayData ? size() : 0);
+	}
+	return offsets.capacity()*sizeof(size_t) + targets.capacity()*sizeof(int) + shortTargets.capacity()*sizeof(uint16_t)
+		   + segmentStarts.capacity()*sizeof(uint32_t) + delays.capacity();
+}
+
+/** isMapped
+ * @return true if the connections are read in place in a mapped file, shared with the other processes that map it
+ */
+bool Connectivity::isMapped() const
+{
+	return bool(mapped);
+}
+
+/** placeSlices
+ *
+ * @param workers 		the threads
+ * @param values 		an array, copied to a new one slice by slice, one slice per thread
+ * @param hugePages 	true to advise huge pages for the new array
+ */
+template<typename T>
+static void placeSlices(WorkerPool& workers, PlacedVector<T>& values, bool hugePages)
+{
+	PlacedVector<T> placed((PlacedAllocator<T>(hugePages)));
+	placed.resize(values.size());
+
+	workers.run([&](int t){
+		size_t first(values.size()*t/workers.size()), last(values.size()*(t + 1)/workers.size());
+		copy(values.begin() + first, values.begin() + last, placed.begin() + first);
+	});
+	values.swap(placed);
+}
+
+/** place
+ *
+ * @param workers 		the threads that deliver the spikes
+ * @param hugePages 	true to advise huge pages for the targets
+ * @note every thread reads the targets of every source : each thread copies
+ * 		 a slice of the targets, so that their pages are spread over the NUMA
+ * 		 nodes of the threads instead of all on the node of the builder
+ * @note mapped connections are not copied : their pages stay shared
+ */
+void Connectivity::place(WorkerPool& workers, bool hugePages)
+{
+	if(mapped) return;
+
+	placeSlices(workers, targets, hugePages);
+	placeSlices(workers, shortTargets, hugePages);
+	placeSlices(workers, delays, hugePages);
+	attach();
+}
+
+/** save
+ *
+ * @param out 	receives the offsets, the targets and their delays
+ */
+void Connectivity::save(CheckpointWriter& out) const
+{
+	out.add("offsets", offsetData, offsetData ? (sourceCount + 1)*sizeof(size_t) : 0);
+	if(segmentCount == 0) out.add("targets", targetData, size()*sizeof(int));
+	else out.add("shortTargets", shortData, size()*sizeof(uint16_t));
+	if(startData) out.add("segmentStarts", startData, size_t(sourceCount)*(segmentCount + 1)*sizeof(uint32_t));
+	if(delayData) out.add("delays", delayData, size());
+}
+
+/** restore
+ *
+ * @param in 		a checkpoint written by save
+ * @param sources 	the number of presynaptic neurons expected
+ * @param delayed 	true if the connections must have their delays
+ * @param compressedTargets 	the number of targets if they are kept in 16 bits, 0 to keep them in 32 bits
+ * @throw std::runtime_error if the checkpoint has no connections for sources neurons
+ * @note the targets are converted if the checkpoint keeps them the other way
+ */
+void Connectivity::restore(const CheckpointReader& in, int sources, bool delayed, int compressedTargets)
+{
+	in.read("offsets", offsets, sources + 1);
+	targets.clear();
+	shortTargets.clear();
+	segmentStarts.clear();
+	segmentCount = 0;
+
+	if(in.has("shortTargets")){
+		in.read("shortTargets", shortTargets, offsets.back());
+		if(in.has("segmentStarts")) in.read("segmentStarts", segmentStarts);
+		segmentCount = segmentStarts.empty() ? 1 : segmentStarts.size()/max(sources, 1) - 1;
+	} else {
+		in.read("targets", targets, offsets.back());
+	}
+
+	if(delayed) in.read("delays", delays, offsets.back());
+	else delays.clear();
+
+	cursor.clear();
+	attach();
+	if(compressedTargets > 0 and segmentCount == 0) compress(compressedTargets);
+	if(compressedTargets == 0 and segmentCount > 0) expand();
+}
+
+/** map
+ *
+ * @param in 		a checkpoint written by save, kept mapped as long as the connections use it
+ * @param sources 	the number of presynaptic neurons expected
+ * @param delayed 	true if the connections must have their delays
+ * @param compressedTargets 	the number of targets if they are kept in 16 bits, 0 to keep them in 32 bits
+ * @throw std::runtime_error if the checkpoint has no connections for sources neurons in this form
+ * @note like restore without any copy : the connections are read in place in the file,
+ * 		 whose pages are shared by every process that maps it
+ */
+void Connectivity::map(const shared_ptr<const CheckpointReader>& in, int sources, bool delayed, int compressedTargets)
+{
+	int segments(compressedTargets > 0 ? ((compressedTargets - 1) >> segmentBits) + 1 : 0);
+
+	// Rien n'est converti : le fichier doit déjà garder les cibles dans la forme demandée
+	if(in->has("shortTargets") != (segments > 0)) throw runtime_error("the mapped connections are not in the form asked");
+
+	const size_t* rows(in->view<size_t>("offsets", sources + 1));
+	const int* plain(segments == 0 ? in->view<int>("targets", rows[sources]) : nullptr);
+	const uint16_t* compressed(segments > 0 ? in->view<uint16_t>("shortTargets", rows[sources]) : nullptr);
+	const uint32_t* starts(segments > 1 ? in->view<uint32_t>("segmentStarts", size_t(sources)*(segments + 1)) : nullptr);
+	const uint8_t* steps(delayed ? in->view<uint8_t>("delays", rows[sources]) : nullptr);
+
+	reset(0);
+	offsets.clear();
+	offsets.shrink_to_fit();
+	targets.shrink_to_fit();
+	shortTargets.shrink_to_fit();
+	segmentStarts.shrink_to_fit();
+	delays.shrink_to_fit();
+
+	segmentCount = segments;
+	sourceCount = sources;
+	offsetData = rows;
+	targetData = plain;
+	shortData = compressed;
+	startData = starts;
+	delayData = steps;
+	mapped = in;
+}
@@ -0,0 +1,281 @@
+/**
+ * @file   connectivity.hpp
+ * @author Jonathan Haab
+ * @date   Automn, 2017
+ * @brief  connections of the network stored as compressed sparse rows
+ */
+
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include "checkpoint.hpp"
+#include "topology.hpp"
+#include "workerPool.hpp"
+
+#ifndef CONNECTIVITY_H
+#define CONNECTIVITY_H
+
+/** Span
+ *  contiguous targets of one neuron, in increasing order
+ */
+struct Span
+{
+	const int* first; //!< First target
+	const int* last; //!< After the last target
+
+	/** size
+	 * @return the number of targets
+	 */
+	size_t size() const { return last - first; }
+};
+
+/** ShortSpan
+ *  targets of one neuron in a segment of 65536 neurons, kept in 16 bits
+ *  relative to the first neuron of the segment, in increasing order
+ */
+struct ShortSpan
+{
+	const uint16_t* first; //!< First target, minus base
+	const uint16_t* last; //!< After the last target
+	int base; //!< First neuron of the segment
+
+	/** size
+	 * @return the number of targets
+	 */
+	size_t size() const { return last - first; }
+};
+
+/** spreadDelay
+ *
+ * @param word 		a random word
+ * @param spread 	the largest delay
+ * @return a delay drawn uniformly in [0, spread] from word, with a product instead of a division
+ */
+inline uint8_t spreadDelay(uint32_t word, int spread)
+{
+	return uint8_t((uint64_t(word)*uint64_t(spread + 1)) >> 32);
+}
+
+/** Connectivity
+ *  the targets of every neuron are stored one after the other in a single
+ *  array, offsets gives where the targets of each neuron begin. It is built
+ *  in two passes over the same connections : count, allocate, then add,
+ *  or by build, which does both passes with every thread.
+ *  The delay of each connection, if they differ, is kept in one byte next
+ *  to its target. The targets can be compressed in 16 bits : the targets
+ *  of a row are sorted, so those of each segment of 65536 neurons follow
+ *  each other and only their place in the segment is kept. The arrays
+ *  are either owned or read in place in a mapped checkpoint file.
+ */
+class Connectivity
+{
+	public :
+
+		Connectivity() = default;
+
+		/// Les pointeurs de lecture désignent les tableaux de l'objet : il n'est pas copié
+		Connectivity(const Connectivity&) = delete;
+		Connectivity& operator=(const Connectivity&) = delete;
+
+		/** reset
+		 *
+		 * @param sources 	the number of presynaptic neurons
+		 * @note removes every connection and starts the counting pass
+		 */
+		void reset(int sources);
+
+		/** count
+		 *
+		 * @param source 	the presynaptic neuron of a connection
+		 * @note first pass : counts the connection without storing it
+		 */
+		void count(int source);
+
+		static const int segmentBits = 16; //!< A compressed target is kept in 16 bits, relative to its segment of 65536 neurons
+
+		/** allocate
+		 *
+		 * @param delayed 			true to keep a delay for each connection
+		 * @param compressedTargets 	the number of targets if they are kept in 16 bits, 0 to keep them in 32 bits
+		 * @note ends the counting pass, computes the offsets and allocates the targets once
+		 */
+		void allocate(bool delayed = false, int compressedTargets = 0);
+
+		/** add
+		 *
+		 * @param source 	the presynaptic neuron
+		 * @param target 	the postsynaptic neuron
+		 * @param delay 	the steps added to the delay of the projection, kept if allocate was delayed
+		 * @note second pass : the connections must be the counted ones, in the same order,
+		 * 		 and the targets of a source in increasing order if they are compressed
+		 */
+		void add(int source, int target, uint8_t delay = 0);
+
+		/** build
+		 *
+		 * @param workers 		the threads, each one adds the connections of a contiguous range of targets
+		 * @param targetCount 	the number of targets
+		 * @param inputs 		the number of sources of each target
+		 * @param drawn 		the sources of every target, inputs after inputs, target after target
+		 * @param drawnDelays 	the delay of each source in the same order, nullptr to keep no delays
+		 * @param compressedTargets 	the number of targets if they are kept in 16 bits, 0 to keep them in 32 bits
+		 * @note replaces count, allocate and add after reset : each thread counts the sources of its
+		 * 		 targets, then writes them in place after those of the threads before it, so that
+		 * 		 the targets of each source stay sorted whatever the number of threads
+		 */
+		void build(WorkerPool& workers, int targetCount, int inputs, const int* drawn, const uint8_t* drawnDelays, int compressedTargets = 0);
+
+		/** targetsOf
+		 *
+		 * @param source 	the presynaptic neuron
+		 * @return the targets of source, if they are not compressed
+		 */
+		Span targetsOf(int source) const
+		{
+			return Span{targetData + offsetData[source], targetData + offsetData[source+1]};
+		}
+
+		/** segments
+		 * @return the number of segments of 65536 targets if the targets are compressed, 0 otherwise
+		 */
+		int segments() const
+		{
+			return segmentCount;
+		}
+
+		/** shortTargetsOf
+		 *
+		 * @param source 	the presynaptic neuron
+		 * @param segment 	a segment in [0, segments())
+		 * @return the targets of source in the segment, if the targets are compressed
+		 * @note the targets of a source in every segment follow each other, in the same order as its delays
+		 */
+		ShortSpan shortTargetsOf(int source, int segment) const
+		{
+			const uint16_t* row(shortData + offsetData[source]);
+
+			// Avec un seul segment la ligne entière en est un : pas de table
+			if(segmentCount == 1) return ShortSpan{row, shortData + offsetData[source+1], 0};
+
+			const uint32_t* starts(startData + size_t(source)*(segmentCount + 1));
+			return ShortSpan{row + starts[segment], row + starts[segment+1], segment << segmentBits};
+		}
+
+		/** delaysOf
+		 *
+		 * @param source 	the presynaptic neuron
+		 * @return the delays of the targets of source, in the same order, nullptr if they are not kept
+		 */
+		const uint8_t* delaysOf(int source) const
+		{
+			return delayData ? delayData + offsetData[source] : nullptr;
+		}
+
+		/** sources
+		 * @return the number of presynaptic neurons
+		 */
+		int sources() const;
+
+		/** size
+		 * @return the number of connections
+		 */
+		size_t size() const;
+
+		/** bytes
+		 * @return the memory used to store the connections, mapped or not
+		 */
+		size_t bytes() const;
+
+		/** isMapped
+		 * @return true if the connections are read in place in a mapped file, shared with the other processes that map it
+		 */
+		bool isMapped() const;
+
+		/** place
+		 *
+		 * @param workers 		the threads that deliver the spikes
+		 * @param hugePages 	true to advise huge pages for the targets
+		 * @note every thread reads the targets of every source : each thread copies
+		 * 		 a slice of the targets, so that their pages are spread over the NUMA
+		 * 		 nodes of the threads instead of all on the node of the builder
+		 * @note mapped connections are not copied : their pages stay shared
+		 */
+		void place(WorkerPool& workers, bool hugePages);
+
+		/** save
+		 *
+		 * @param out 	receives the offsets, the targets and their delays
+		 */
+		void save(CheckpointWriter& out) const;
+
+		/** restore
+		 *
+		 * @param in 		a checkpoint written by save
+		 * @param sources 	the number of presynaptic neurons expected
+		 * @param delayed 	true if the connections must have their delays
+		 * @param compressedTargets 	the number of targets if they are kept in 16 bits, 0 to keep them in 32 bits
+		 * @throw std::runtime_error if the checkpoint has no connections for sources neurons
+		 * @note the targets are converted if the checkpoint keeps them the other way
+		 */
+		void restore(const CheckpointReader& in, int sources, bool delayed = false, int compressedTargets = 0);
+
+		/** map
+		 *
+		 * @param in 		a checkpoint written by save, kept mapped as long as the connections use it
+		 * @param sources 	the number of presynaptic neurons expected
+		 * @param delayed 	true if the connections must have their delays
+		 * @param compressedTargets 	the number of targets if they are kept in 16 bits, 0 to keep them in 32 bits
+		 * @throw std::runtime_error if the checkpoint has no connections for sources neurons in this form
+		 * @note like restore without any copy : the connections are read in place in the file,
+		 * 		 whose pages are shared by every process that maps it
+		 */
+		void map(const std::shared_ptr<const CheckpointReader>& in, int sources, bool delayed = false, int compressedTargets = 0);
+
+	private :
+
+		/** compress
+		 *
+		 * @param compressedTargets 	the number of targets, they are kept in 16 bits instead of targets
+		 * @param workers 				the threads that compress a slice of the sources each, nullptr for the calling thread
+		 */
+		void compress(int compressedTargets, WorkerPool* workers = nullptr);
+
+		/** allocateTargets
+		 *
+		 * @param compressedTargets 	the number of targets if they are kept in 16 bits, 0 to keep them in 32 bits
+		 * @note allocates the targets of the offsets and starts the pass of add
+		 */
+		void allocateTargets(int compressedTargets);
+
+		/** expand
+		 *
+		 * @note keeps the compressed targets in 32 bits again
+		 */
+		void expand();
+
+		/** attach
+		 *
+		 * @note reads the connections in the owned arrays again, once they are allocated
+		 */
+		void attach();
+
+		std::vector<size_t> offsets; //!< The targets of i are targets[offsets[i]] to targets[offsets[i+1]-1]
+		PlacedVector<int> targets; //!< Targets of every neuron, one neuron after the other
+		PlacedVector<uint16_t> shortTargets; //!< Targets in 16 bits relative to their segment, instead of targets if they are compressed
+		std::vector<uint32_t> segmentStarts; //!< Where each segment of 65536 targets begins in the row of each source, segments+1 per source, empty with one segment
+		int segmentCount = 0; //!< Number of segments of the compressed targets, 0 if they are kept in 32 bits
+		PlacedVector<uint8_t> delays; //!< Delay of each target, empty if every connection of a projection has the same
+		std::vector<size_t> cursor; //!< Where the next target of each neuron is added
+
+		// Les lectures passent par ces pointeurs : sur les tableaux ci-dessus, ou dans le fichier mappé
+		int sourceCount = 0; //!< Number of presynaptic neurons
+		const size_t* offsetData = nullptr; //!< Offsets read by targetsOf
+		const int* targetData = nullptr; //!< Targets in 32 bits, nullptr if they are compressed
+		const uint16_t* shortData = nullptr; //!< Targets in 16 bits, nullptr if they are not compressed
+		const uint32_t* startData = nullptr; //!< Segment starts, nullptr with at most one segment
+		const uint8_t* delayData = nullptr; //!< Delays, nullptr if they are not kept
+		std::shared_ptr<const CheckpointReader> mapped; //!< File in which the connections are read, none if they are owned
+};
+
+#endif
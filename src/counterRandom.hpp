@@ -0,0 +1,130 @@
+/**
+ * @file   counterRandom.hpp
+ * @author Jonathan Haab
+ * @date   Automn, 2017
+ * @brief  counter-based random numbers : the n-th number of a stream is a
+ * 		   pure function of (seed, stream, n)
+ */
+
+#include <cstdint>
+#include <limits>
+
+#ifndef COUNTERRANDOM_H
+#define COUNTERRANDOM_H
+
+/** philox
+ *
+ * @param seed 	the key of the generator
+ * @param c 		the counter (4 words), replaced by 4 random words
+ * @note Philox4x32-10 of Salmon et al. (Random123)
+ */
+inline void philox(uint64_t seed, uint32_t c[4])
+{
+	uint32_t k0 = uint32_t(seed);
+	uint32_t k1 = uint32_t(seed >> 32);
+
+	for(int round(0); round < 10; ++round){
+
+		uint64_t p0(uint64_t(0xD2511F53u)*c[0]);
+		uint64_t p1(uint64_t(0xCD9E8D57u)*c[2]);
+
+		uint32_t c0(uint32_t(p1 >> 32) ^ c[1] ^ k0);
+		uint32_t c2(uint32_t(p0 >> 32) ^ c[3] ^ k1);
+		c[1] = uint32_t(p1);
+		c[3] = uint32_t(p0);
+		c[0] = c0;
+		c[2] = c2;
+
+		k0 += 0x9E3779B9u;
+		k1 += 0xBB67AE85u;
+	}
+}
+
+/** deriveSeed
+ *
+ * @param seed 	the seed of the simulation
+ * @param use 		what the derived seed is used for (external input, connections, ...)
+ * @return an independent seed for each use of the same simulation seed
+ */
+inline uint64_t deriveSeed(uint64_t seed, uint32_t use)
+{
+	uint32_t c[4] = {0, 0, use, 0xFFFFFFFFu};
+	philox(seed, c);
+	return (uint64_t(c[1]) << 32) | c[0];
+}
+
+/** CounterStream
+ *  stream number stream of the generator seed, usable with the
+ *  distributions of <random>. Two streams never overlap and a stream
+ *  can be rebuilt at any time without any stored state.
+ */
+class CounterStream
+{
+	public :
+
+		typedef uint32_t result_type;
+
+		/** Constructor
+		 *
+		 * @param seed 	the key of the generator
+		 * @param stream 	the id of the stream (a neuron, a block of targets, ...)
+		 * @param position 	the number of words already drawn
+		 */
+		CounterStream(uint64_t seed = 0, uint64_t stream = 0, uint64_t position = 0)
+			: seed(seed), stream(stream), block(position/4), used(position%4)
+		{
+			generate();
+		}
+
+		/** operator()
+		 * @return the next random word of the stream
+		 */
+		result_type operator()()
+		{
+			if(used == 4){
+				block += 1;
+				used = 0;
+				generate();
+			}
+			return words[used++];
+		}
+
+		/** uniform
+		 * @return a double in (0, 1], never 0 so that its log is finite
+		 */
+		double uniform()
+		{
+			return ((*this)() + 1.0)*(1.0/4294967296.0);
+		}
+
+		/** position
+		 * @return the number of words drawn since the beginning of the stream
+		 */
+		uint64_t position() const { return block*4 + used; }
+
+		static constexpr result_type min() { return 0; }
+		static constexpr result_type max() { return std::numeric_limits<result_type>::max(); }
+
+	private :
+
+		uint64_t seed; //!< Key of the generator
+		uint64_t stream; //!< Id of the stream
+		uint64_t block; //!< Counter of the current block of 4 words
+		int used; //!< Number of words of the block already returned
+		uint32_t words[4]; //!< Current block
+
+		/** generate
+		 *
+		 * @note computes the block of 4 words for the counter (block, stream)
+		 */
+		void generate()
+		{
+			words[0] = uint32_t(block);
+			words[1] = uint32_t(block >> 32);
+			words[2] = uint32_t(stream);
+			words[3] = uint32_t(stream >> 32);
+			philox(seed, words);
+		}
+};
+
+#endif
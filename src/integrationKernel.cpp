@@ -0,0 +1,395 @@
+/**
+ * @file   integrationKernel.cpp
+ * @author Jonathan Haab
+ * @date   Automn, 2017
+ * @brief  scalar, SSE2, AVX2 and AVX-512 versions of the integration kernel
+ */
+
+#include "integrationKernel.hpp"
+#include "precision.hpp"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define KERNEL_X86
+#include <immintrin.h>
+// c1*v + drive + input must be rounded like the scalar code, without fused multiply-add
+#pragma GCC optimize("fp-contract=off")
+#endif
+
+using namespace std;
+
+/** integrateScalar
+ *
+ * @note reference kernel, one neuron at a time without any branch, in the type CellTraits<Cell>::Real
+ */
+template<typename Cell>
+static int integrateScalar(const BasicIntegrationArgs<Cell>& a, int begin)
+{
+	typedef typename CellTraits<Cell>::Real Real;
+
+	const Real c1(a.model.c1);
+	const Real v_th(a.model.v_th);
+	const Real v_res(a.model.v_res);
+	const Real refractorySteps(a.model.refractorySteps);
+
+	int count(0);
+
+	for(int i(begin); i < a.n; ++i){
+
+		Real refractory(a.refractory[i]);
+		bool active(refractory < 1);
+		Real v(c1*Real(CellTraits<Cell>::decode(a.v[i])) + a.drive[i] + Real(CellTraits<Cell>::decode(a.input[i])));
+		bool spike(active and v > v_th);
+
+		a.v[i] = CellTraits<Cell>::encode((active and not spike) ? v : v_res);
+		a.refractory[i] = spike ? refractorySteps : (active ? refractory : refractory - 1);
+		a.input[i] = 0;
+
+		a.spiking[count] = i;
+		count += spike;
+	}
+	return count;
+}
+
+#ifdef KERNEL_X86
+
+// Les cellules en virgule fixe sont converties en double à la lecture et arrondies à l'écriture, comme encode
+__attribute__((target("sse2"))) static inline __m128d load2(const double* p) { return _mm_loadu_pd(p); }
+__attribute__((target("sse2"))) static inline __m128d load2(const int32_t* p)
+{
+	return _mm_mul_pd(_mm_cvtepi32_pd(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(p))), _mm_set1_pd(1/fixedScale));
+}
+__attribute__((target("sse2"))) static inline void store2(double* p, __m128d x) { _mm_storeu_pd(p, x); }
+__attribute__((target("sse2"))) static inline void store2(int32_t* p, __m128d x)
+{
+	_mm_storel_epi64(reinterpret_cast<__m128i*>(p), _mm_cvtpd_epi32(_mm_mul_pd(x, _mm_set1_pd(fixedScale))));
+}
+
+__attribute__((target("avx2"))) static inline __m256d load4(const double* p) { return _mm256_loadu_pd(p); }
+__attribute__((target("avx2"))) static inline __m256d load4(const int32_t* p)
+{
+	return _mm256_mul_pd(_mm256_cvtepi32_pd(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p))), _mm256_set1_pd(1/fixedScale));
+}
+__attribute__((target("avx2"))) static inline void store4(double* p, __m256d x) { _mm256_storeu_pd(p, x); }
+__attribute__((target("avx2"))) static inline void store4(int32_t* p, __m256d x)
+{
+	_mm_storeu_si128(reinterpret_cast<__m128i*>(p), _mm256_cvtpd_epi32(_mm256_mul_pd(x, _mm256_set1_pd(fixedScale))));
+}
+
+// Les conversions sans masque partent d'une source indéfinie (-Wmaybe-uninitialized) : le masque plein les écrit toutes
+static const __mmask8 allLanes(0xFF);
+
+__attribute__((target("avx512f"))) static inline __m512d load8(const double* p) { return _mm512_loadu_pd(p); }
+__attribute__((target("avx512f"))) static inline __m512d load8(const int32_t* p)
+{
+	return _mm512_mul_pd(_mm512_maskz_cvtepi32_pd(allLanes, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p))), _mm512_set1_pd(1/fixedScale));
+}
+__attribute__((target("avx512f"))) static inline void store8(double* p, __m512d x) { _mm512_storeu_pd(p, x); }
+__attribute__((target("avx512f"))) static inline void store8(int32_t* p, __m512d x)
+{
+	_mm256_storeu_si256(reinterpret_cast<__m256i*>(p), _mm512_maskz_cvtpd_epi32(allLanes, _mm512_mul_pd(x, _mm512_set1_pd(fixedScale))));
+}
+
+/** compact
+ *
+ * @note writes the ids of the lanes set in mask without any branch
+ */
+static inline int compact(int* spiking, int count, int base, unsigned mask, int lanes)
+{
+	for(int l(0); l < lanes; ++l){
+		spiking[count] = base + l;
+		count += (mask >> l) & 1;
+	}
+	return count;
+}
+
+/** integrateSSE2
+ *
+ * @note two neurons per instruction
+ */
+template<typename Cell>
+__attribute__((target("sse2")))
+static int integrateSSE2(const BasicIntegrationArgs<Cell>& a)
+{
+	const __m128d vc1(_mm_set1_pd(a.model.c1));
+	const __m128d vth(_mm_set1_pd(a.model.v_th));
+	const __m128d vres(_mm_set1_pd(a.model.v_res));
+	const __m128d refr(_mm_set1_pd(a.model.refractorySteps));
+	const __m128d one(_mm_set1_pd(1));
+
+	int count(0);
+	int i(0);
+
+	for(; i + 2 <= a.n; i += 2){
+
+		__m128d refractory(_mm_loadu_pd(a.refractory + i));
+		__m128d active(_mm_cmplt_pd(refractory, one));
+		__m128d v(_mm_add_pd(_mm_add_pd(_mm_mul_pd(vc1, load2(a.v + i)), _mm_loadu_pd(a.drive + i)), load2(a.input + i)));
+		__m128d spike(_mm_and_pd(active, _mm_cmpgt_pd(v, vth)));
+		__m128d keep(_mm_andnot_pd(spike, active));
+
+		store2(a.v + i, _mm_or_pd(_mm_and_pd(keep, v), _mm_andnot_pd(keep, vres)));
+		__m128d countdown(_mm_or_pd(_mm_and_pd(active, refractory), _mm_andnot_pd(active, _mm_sub_pd(refractory, one))));
+		_mm_storeu_pd(a.refractory + i, _mm_or_pd(_mm_and_pd(spike, refr), _mm_andnot_pd(spike, countdown)));
+		store2(a.input + i, _mm_setzero_pd());
+
+		count = compact(a.spiking, count, i, _mm_movemask_pd(spike), 2);
+	}
+
+	BasicIntegrationArgs<Cell> tail(a);
+	tail.spiking += count;
+	return count + integrateScalar(tail, i);
+}
+
+/** integrateSSE2
+ *
+ * @note four float neurons per instruction
+ */
+__attribute__((target("sse2")))
+static int integrateSSE2(const BasicIntegrationArgs<float>& a)
+{
+	const __m128 vc1(_mm_set1_ps(a.model.c1));
+	const __m128 vth(_mm_set1_ps(a.model.v_th));
+	const __m128 vres(_mm_set1_ps(a.model.v_res));
+	const __m128 refr(_mm_set1_ps(a.model.refractorySteps));
+	const __m128 one(_mm_set1_ps(1));
+
+	int count(0);
+	int i(0);
+
+	for(; i + 4 <= a.n; i += 4){
+
+		__m128 refractory(_mm_loadu_ps(a.refractory + i));
+		__m128 active(_mm_cmplt_ps(refractory, one));
+		__m128 v(_mm_add_ps(_mm_add_ps(_mm_mul_ps(vc1, _mm_loadu_ps(a.v + i)), _mm_loadu_ps(a.drive + i)), _mm_loadu_ps(a.input + i)));
+		__m128 spike(_mm_and_ps(active, _mm_cmpgt_ps(v, vth)));
+		__m128 keep(_mm_andnot_ps(spike, active));
+
+		_mm_storeu_ps(a.v + i, _mm_or_ps(_mm_and_ps(keep, v), _mm_andnot_ps(keep, vres)));
+		__m128 countdown(_mm_or_ps(_mm_and_ps(active, refractory), _mm_andnot_ps(active, _mm_sub_ps(refractory, one))));
+		_mm_storeu_ps(a.refractory + i, _mm_or_ps(_mm_and_ps(spike, refr), _mm_andnot_ps(spike, countdown)));
+		_mm_storeu_ps(a.input + i, _mm_setzero_ps());
+
+		count = compact(a.spiking, count, i, _mm_movemask_ps(spike), 4);
+	}
+
+	BasicIntegrationArgs<float> tail(a);
+	tail.spiking += count;
+	return count + integrateScalar(tail, i);
+}
+
+/** integrateAVX2
+ *
+ * @note four neurons per instruction
+ */
+template<typename Cell>
+__attribute__((target("avx2")))
+static int integrateAVX2(const BasicIntegrationArgs<Cell>& a)
+{
+	const __m256d vc1(_mm256_set1_pd(a.model.c1));
+	const __m256d vth(_mm256_set1_pd(a.model.v_th));
+	const __m256d vres(_mm256_set1_pd(a.model.v_res));
+	const __m256d refr(_mm256_set1_pd(a.model.refractorySteps));
+	const __m256d one(_mm256_set1_pd(1));
+
+	int count(0);
+	int i(0);
+
+	for(; i + 4 <= a.n; i += 4){
+
+		__m256d refractory(_mm256_loadu_pd(a.refractory + i));
+		__m256d active(_mm256_cmp_pd(refractory, one, _CMP_LT_OQ));
+		__m256d v(_mm256_add_pd(_mm256_add_pd(_mm256_mul_pd(vc1, load4(a.v + i)), _mm256_loadu_pd(a.drive + i)), load4(a.input + i)));
+		__m256d spike(_mm256_and_pd(active, _mm256_cmp_pd(v, vth, _CMP_GT_OQ)));
+		__m256d keep(_mm256_andnot_pd(spike, active));
+
+		store4(a.v + i, _mm256_blendv_pd(vres, v, keep));
+		__m256d countdown(_mm256_blendv_pd(_mm256_sub_pd(refractory, one), refractory, active));
+		_mm256_storeu_pd(a.refractory + i, _mm256_blendv_pd(countdown, refr, spike));
+		store4(a.input + i, _mm256_setzero_pd());
+
+		count = compact(a.spiking, count, i, _mm256_movemask_pd(spike), 4);
+	}
+
+	BasicIntegrationArgs<Cell> tail(a);
+	tail.spiking += count;
+	return count + integrateScalar(tail, i);
+}
+
+/** integrateAVX2
+ *
+ * @note eight float neurons per instruction
+ */
+__attribute__((target("avx2")))
+static int integrateAVX2(const BasicIntegrationArgs<float>& a)
+{
+	const __m256 vc1(_mm256_set1_ps(a.model.c1));
+	const __m256 vth(_mm256_set1_ps(a.model.v_th));
+	const __m256 vres(_mm256_set1_ps(a.model.v_res));
+	const __m256 refr(_mm256_set1_ps(a.model.refractorySteps));
+	const __m256 one(_mm256_set1_ps(1));
+
+	int count(0);
+	int i(0);
+
+	for(; i + 8 <= a.n; i += 8){
+
+		__m256 refractory(_mm256_loadu_ps(a.refractory + i));
+		__m256 active(_mm256_cmp_ps(refractory, one, _CMP_LT_OQ));
+		__m256 v(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(vc1, _mm256_loadu_ps(a.v + i)), _mm256_loadu_ps(a.drive + i)), _mm256_loadu_ps(a.input + i)));
+		__m256 spike(_mm256_and_ps(active, _mm256_cmp_ps(v, vth, _CMP_GT_OQ)));
+		__m256 keep(_mm256_andnot_ps(spike, active));
+
+		_mm256_storeu_ps(a.v + i, _mm256_blendv_ps(vres, v, keep));
+		__m256 countdown(_mm256_blendv_ps(_mm256_sub_ps(refractory, one), refractory, active));
+		_mm256_storeu_ps(a.refractory + i, _mm256_blendv_ps(countdown, refr, spike));
+		_mm256_storeu_ps(a.input + i, _mm256_setzero_ps());
+
+		count = compact(a.spiking, count, i, _mm256_movemask_ps(spike), 8);
+	}
+
+	BasicIntegrationArgs<float> tail(a);
+	tail.spiking += count;
+	return count + integrateScalar(tail, i);
+}
+
+/** integrateAVX512
+ *
+ * @note eight neurons per instruction
+ */
+template<typename Cell>
+__attribute__((target("avx512f")))
+static int integrateAVX512(const BasicIntegrationArgs<Cell>& a)
+{
+	const __m512d vc1(_mm512_set1_pd(a.model.c1));
+	const __m512d vth(_mm512_set1_pd(a.model.v_th));
+	const __m512d vres(_mm512_set1_pd(a.model.v_res));
+	const __m512d refr(_mm512_set1_pd(a.model.refractorySteps));
+	const __m512d one(_mm512_set1_pd(1));
+
+	int count(0);
+	int i(0);
+
+	for(; i + 8 <= a.n; i += 8){
+
+		__m512d refractory(_mm512_loadu_pd(a.refractory + i));
+		__mmask8 active(_mm512_cmp_pd_mask(refractory, one, _CMP_LT_OQ));
+		__m512d v(_mm512_add_pd(_mm512_add_pd(_mm512_mul_pd(vc1, load8(a.v + i)), _mm512_loadu_pd(a.drive + i)), load8(a.input + i)));
+		__mmask8 spike(active & _mm512_cmp_pd_mask(v, vth, _CMP_GT_OQ));
+		__mmask8 keep(active & ~spike);
+
+		store8(a.v + i, _mm512_mask_blend_pd(keep, vres, v));
+		__m512d countdown(_mm512_mask_blend_pd(active, _mm512_sub_pd(refractory, one), refractory));
+		_mm512_storeu_pd(a.refractory + i, _mm512_mask_blend_pd(spike, countdown, refr));
+		store8(a.input + i, _mm512_setzero_pd());
+
+		count = compact(a.spiking, count, i, spike, 8);
+	}
+
+	BasicIntegrationArgs<Cell> tail(a);
+	tail.spiking += count;
+	return count + integrateScalar(tail, i);
+}
+
+/** integrateAVX512
+ *
+ * @note sixteen float neurons per instruction
+ */
+__attribute__((target("avx512f")))
+static int integrateAVX512(const BasicIntegrationArgs<float>& a)
+{
+	const __m512 vc1(_mm512_set1_ps(a.model.c1));
+	const __m512 vth(_mm512_set1_ps(a.model.v_th));
+	const __m512 vres(_mm512_set1_ps(a.model.v_res));
+	const __m512 refr(_mm512_set1_ps(a.model.refractorySteps));
+	const __m512 one(_mm512_set1_ps(1));
+
+	int count(0);
+	int i(0);
+
+	for(; i + 16 <= a.n; i += 16){
+
+		__m512 refractory(_mm512_loadu_ps(a.refractory + i));
+		__mmask16 active(_mm512_cmp_ps_mask(refractory, one, _CMP_LT_OQ));
+		__m512 v(_mm512_add_ps(_mm512_add_ps(_mm512_mul_ps(vc1, _mm512_loadu_ps(a.v + i)), _mm512_loadu_ps(a.drive + i)), _mm512_loadu_ps(a.input + i)));
+		__mmask16 spike(active & _mm512_cmp_ps_mask(v, vth, _CMP_GT_OQ));
+		__mmask16 keep(active & ~spike);
+
+		_mm512_storeu_ps(a.v + i, _mm512_mask_blend_ps(keep, vres, v));
+		__m512 countdown(_mm512_mask_blend_ps(active, _mm512_sub_ps(refractory, one), refractory));
+		_mm512_storeu_ps(a.refractory + i, _mm512_mask_blend_ps(spike, countdown, refr));
+		_mm512_storeu_ps(a.input + i, _mm512_setzero_ps());
+
+		count = compact(a.spiking, count, i, spike, 16);
+	}
+
+	BasicIntegrationArgs<float> tail(a);
+	tail.spiking += count;
+	return count + integrateScalar(tail, i);
+}
+
+#endif
+
+/** integrate
+ *
+ * @param kernel 	the instruction set to use, it must be supported
+ * @param args 	the arrays of the population
+ * @return the number of ids written in args.spiking
+ */
+template<typename Cell>
+int integrate(KernelType kernel, const BasicIntegrationArgs<Cell>& args)
+{
+	switch(kernel){
+#ifdef KERNEL_X86
+		case SSE2 : return integrateSSE2(args);
+		case AVX2 : return integrateAVX2(args);
+		case AVX512 : return integrateAVX512(args);
+#endif
+		default : return integrateScalar(args, 0);
+	}
+}
+
+template int integrate(KernelType kernel, const BasicIntegrationArgs<double>& args);
+template int integrate(KernelType kernel, const BasicIntegrationArgs<float>& args);
+template int integrate(KernelType kernel, const BasicIntegrationArgs<int32_t>& args);
+
+/** isSupported
+ * @return true if the cpu can run the kernel
+ */
+bool isSupported(KernelType kernel)
+{
+#ifdef KERNEL_X86
+	__builtin_cpu_init();
+	switch(kernel){
+		case SSE2 : return __builtin_cpu_supports("sse2");
+		case AVX2 : return __builtin_cpu_supports("avx2");
+		case AVX512 : return __builtin_cpu_supports("avx512f");
+		default : break;
+	}
+#endif
+	return kernel == SCALAR;
+}
+
+/** bestKernel
+ * @return the widest kernel supported by the cpu, chosen once at startup
+ */
+KernelType bestKernel()
+{
+	static const KernelType best(isSupported(AVX512) ? AVX512
+							  : isSupported(AVX2) ? AVX2
+							  : isSupported(SSE2) ? SSE2
+							  : SCALAR);
+	return best;
+}
+
+/** kernelName
+ * @return the name of the instruction set of the kernel
+ */
+string kernelName(KernelType kernel)
+{
+	switch(kernel){
+		case SSE2 : return "SSE2";
+		case AVX2 : return "AVX2";
+		case AVX512 : return "AVX-512";
+		default : return "scalar";
+	}
+}
@@ -0,0 +1,91 @@
+/**
+ * @file   integrationKernel.hpp
+ * @author Jonathan Haab
+ * @date   Automn, 2017
+ * @brief  vectorized integration of one step of the membrane potentials
+ */
+
+#include <string>
+#include "constants.hpp"
+#include "precision.hpp"
+
+#ifndef INTEGRATIONKERNEL_H
+#define INTEGRATIONKERNEL_H
+
+/// Instruction set used by the integration kernel
+enum KernelType {SCALAR, SSE2, AVX2, AVX512, kernelTypeSize};
+
+/** MembraneConstants
+ *  parameters of the model used by the kernel, from constants.hpp by default
+ */
+struct MembraneConstants
+{
+	double c1; //!< Factor of the potential at each step
+	double v_th; //!< Threshold of the spikes
+	double v_res; //!< Potential after a spike and during the refractory time
+	double refractorySteps; //!< Refractory time in steps, given to the countdown of a neuron when it spikes
+
+	/** defaults
+	 * @return the constants of constants.hpp
+	 */
+	static MembraneConstants defaults() { return MembraneConstants{::c1, ::v_th, ::v_res, ::refractorySteps}; }
+};
+
+/** BasicIntegrationArgs
+ *  arrays of the population given to the kernel for one step. The potentials
+ *  and the inputs are cells of type Cell (double, float or int32_t in fixed
+ *  point, see precision.hpp), the kernel integrates them in
+ *  CellTraits<Cell>::Real : float for float cells, double otherwise.
+ */
+template<typename Cell>
+struct BasicIntegrationArgs
+{
+	typedef typename CellTraits<Cell>::Real Real; //!< Type of the arithmetic of the kernel
+
+	int n; //!< Number of neurons
+	Cell* v; //!< Membrane potentials
+	Real* refractory; //!< Refractory countdown of each neuron, in steps, the neuron is active below 1
+	Cell* input; //!< Row of the ringBuffer read at this step, cleared by the kernel
+	const Real* drive; //!< External input of each neuron for this step
+	int* spiking; //!< Output : ids of the neurons that spiked (n values at most)
+	MembraneConstants model; //!< Parameters of the model
+};
+
+/// Arrays of a population whose potentials and inputs are double
+typedef BasicIntegrationArgs<double> IntegrationArgs;
+
+/** integrate
+ *
+ * @param kernel 	the instruction set to use, it must be supported
+ * @param args 	the arrays of the population
+ * @return the number of ids written in args.spiking
+ *
+ * @note for every neuron : if it is active, v = c1*v + drive + input and
+ * 		 it spikes if v > v_th, otherwise v = v_res and its countdown is
+ * 		 decreased by one (constants of args.model). A spike sets the
+ * 		 countdown to refractorySteps.
+ * 		 Every kernel gives exactly the same result as the SCALAR one.
+ * @note Cell is double, float or int32_t : float cells are integrated in
+ * 		 float lanes (4, 8 or 16 per instruction), the others in double lanes
+ * 		 (2, 4 or 8), fixed point cells being converted to double and the new
+ * 		 potentials rounded to the nearest cell
+ */
+template<typename Cell>
+int integrate(KernelType kernel, const BasicIntegrationArgs<Cell>& args);
+
+/** isSupported
+ * @return true if the cpu can run the kernel
+ */
+bool isSupported(KernelType kernel);
+
+/** bestKernel
+ * @return the widest kernel supported by the cpu, chosen once at startup
+ */
+KernelType bestKernel();
+
+/** kernelName
+ * @return the name of the instruction set of the kernel
+ */
+std::string kernelName(KernelType kernel);
+
+#endif
@@ -0,0 +1,83 @@
+/**
+ * @file   mpiTransport.cpp
+ * @author Jonathan Haab
+ * @date   Automn, 2017
+ * @brief  contains all the methods of the exchange of the spikes with MPI
+ */
+
+#include "mpiTransport.hpp"
+#define OMPI_SKIP_MPICXX 1 // seule l'interface C est utilisée
+#define MPICH_SKIP_MPICXX 1
+#include <mpi.h>
+
+using namespace std;
+
+/** Constructor
+ * @note initialises MPI if it is not already done
+ */
+MpiTransport::MpiTransport()
+	: owner(false)
+{
+	int initialised;
+	MPI_Initialized(&initialised);
+
+	if(not initialised){
+		MPI_Init(nullptr, nullptr);
+		owner = true;
+	}
+	MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+	MPI_Comm_size(MPI_COMM_WORLD, &ranks);
+}
+
+/** Destructor
+ * @note finalises MPI if the constructor initialised it
+ */
+MpiTransport::~MpiTransport()
+{
+	if(owner) MPI_Finalize();
+}
+
+/** allGather
+ *
+ * @param sent 		the values of this rank
+ * @param received 	receives the values of every rank, in the order of the ranks
+ */
+void MpiTransport::allGather(const vector<int>& sent, vector<vector<int>>& received)
+{
+	// Les tailles d'abord, puis les valeurs à leur place
+	int count(sent.size());
+	counts.resize(ranks);
+	displacements.resize(ranks);
+	MPI_Allgather(&count, 1, MPI_INT, counts.data(), 1, MPI_INT, MPI_COMM_WORLD);
+
+	int total(0);
+	for(int r(0); r < ranks; ++r){
+		displacements[r] = total;
+		total += counts[r];
+	}
+	gathered.resize(total + 1);
+
+	MPI_Allgatherv(const_cast<int*>(sent.data()), count, MPI_INT,
+				   gathered.data(), counts.data(), displacements.data(), MPI_INT, MPI_COMM_WORLD);
+
+	received.resize(ranks);
+	for(int r(0); r < ranks; ++r){
+		received[r].assign(gathered.begin() + displacements[r], gathered.begin() + displacements[r] + counts[r]);
+	}
+}
+
+/** getRank
+ * @return the rank of this process, in [0, getRanks())
+ */
+int MpiTransport::getRank() const
+{
+	return rank;
+}
+
+/** getRanks
+ * @return the number of processes of the simulation
+ */
+int MpiTransport::getRanks() const
+{
+	return ranks;
+}
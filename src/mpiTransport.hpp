@@ -0,0 +1,48 @@
+/**
+ * @file   mpiTransport.hpp
+ * @author Jonathan Haab
+ * @date   Automn, 2017
+ * @brief  exchange of the spikes between the ranks with MPI, only built with -DNEURONS_MPI=ON
+ */
+
+#include <vector>
+#include "spikeTransport.hpp"
+
+#ifndef MPITRANSPORT_H
+#define MPITRANSPORT_H
+
+/** MpiTransport
+ *  the ranks are the processes of MPI_COMM_WORLD, started by mpirun
+ */
+class MpiTransport : public SpikeTransport
+{
+	public :
+
+		/** Constructor
+		 * @note initialises MPI if it is not already done
+		 */
+		MpiTransport();
+
+		/** Destructor
+		 * @note finalises MPI if the constructor initialised it
+		 */
+		~MpiTransport();
+
+		MpiTransport(const MpiTransport&) = delete;
+		MpiTransport& operator=(const MpiTransport&) = delete;
+
+		void allGather(const std::vector<int>& sent, std::vector<std::vector<int>>& received) override;
+		int getRank() const override;
+		int getRanks() const override;
+
+	private :
+
+		int rank; //!< Rank of this process in MPI_COMM_WORLD
+		int ranks; //!< Size of MPI_COMM_WORLD
+		bool owner; //!< True if MPI was initialised by the constructor
+		std::vector<int> counts; //!< Number of values of each rank
+		std::vector<int> displacements; //!< Position of the values of each rank in gathered
+		std::vector<int> gathered; //!< Values of every rank
+};
+
+#endif
@@ -6,36 +6,183 @@
  */
 
 #include "network.hpp"
-#include <random>
+#include "counterRandom.hpp"
+#include <algorithm>
+#include <sstream>
+#include <stdexcept>
+#include <cerrno>
+#include <sys/stat.h>
 
 using namespace std;
 
+static const uint64_t connectionCacheVersion(1); //!< Version of the connections drawn by createConnections, changed when they are drawn otherwise
+
+/** suffixed
+ *
+ * @param title 		the name of a file
+ * @param number 		an instance of the batch or a rank
+ * @return title with _number before its extension
+ */
+static string suffixed(const string& title, int number)
+{
+	size_t slash(title.rfind('/')), dot(title.rfind('.'));
+	if(dot == string::npos or (slash != string::npos and dot < slash)) dot = title.size();
+	
+	ostringstream name;
+	name << title.substr(0, dot) << "_" << number << title.substr(dot);
+	return name.str();
+}
+
+/** restored
+ *
+ * @param given 	the parameters of the run
+ * @param file 	the checkpoint of this rank, none if empty
+ * @return given with the network of the checkpoint : its seed, its neurons,
+ * 		   its connections, its EPSP, its delays and its batch
+ * @throw std::runtime_error if the checkpoint has no parameters or was saved with
+ * 		  another seed than the one given
+ */
+static Parameters restored(const Parameters& given, const string& file)
+{
+	if(file.empty()) return given;
+	
+	CheckpointReader checkpoint(file);
+	size_t bytes;
+	const char* text(static_cast<const char*>(checkpoint.read("parameters", bytes)));
+	istringstream lines(string(text, bytes));
+	
+	Parameters saved;
+	try {
+		saved.load(lines, file);
+	} catch(const invalid_argument& error){
+		throw runtime_error(error.what());
+	}
+	if(not given.randomSeed and given.seed != saved.seed){
+		throw runtime_error("the checkpoint '" + file + "' was saved with another seed");
+	}
+	
+	// Sans --seed, le seed tiré au démarrage donnerait un autre input externe et d'autres connexions procédurales
+	Parameters network(given);
+	network.seed = saved.seed;
+	network.randomSeed = false;
+	network.N = saved.N;
+	network.excitatoryRatio = saved.excitatoryRatio;
+	network.connectionRatio = saved.connectionRatio;
+	network.J_e = saved.J_e;
+	network.J_i = saved.J_i;
+	network.lambda = saved.lambda;
+	network.bufferDelay = saved.bufferDelay;
+	network.inhibitoryDelay = saved.inhibitoryDelay;
+	network.delaySpread = saved.delaySpread;
+	network.batch = saved.batch;
+	network.connectivity = saved.connectivity;
+	return network;
+}
+
 /** Constructor
  * 
  * @param title	the title of the file in which we want to 
  * 					print the data of the update
+ * @param given 	the parameters of the simulation : the model, the
+ * 					number of threads (each one owns a contiguous range of
+ * 					neurons), the connectivity mode and the seed (the same
+ * 					seed gives the same spikes whatever the number of threads)
  * 
- * @note opens the flow to write the data
+ * @note opens the flow to write the data, one file per instance of
+ * 		 the batch, title_k.ext for the instance k if there are several
+ * @note with several ranks, this process only simulates the neurons of
+ * 		 its rank and only stores their inputs, the rank 0 writes the
+ * 		 data of the whole network, the same as a single process
+ * @note with given.restore, the network is the one of the checkpoint
  */
  
 /** Destructor
  * 
  * @note close the flow used to write the data
  */ 
-Network::Network(std::string title)
+Network::Network(std::string title, const Parameters& given)
+	: transport(SpikeTransport::create(given)),
+	  parameters(restored(given, transport and not given.restore.empty() ? suffixed(given.restore, transport->getRank()) : given.restore)),
+	  plotStartStep(parameters.plotStartTime/parameters.h), plotStopStep(parameters.plotStopTime/parameters.h),
+	  firstNeuron(transport ? long(parameters.N)*transport->getRank()/transport->getRanks() : 0),
+	  lastNeuron(transport ? long(parameters.N)*(transport->getRank() + 1)/transport->getRanks() : parameters.N),
+	  neurons(lastNeuron - firstNeuron, max(0, min(parameters.N_e(), lastNeuron) - firstNeuron),
+			  deriveSeed(parameters.seed, EXTERNAL_INPUT), parameters, firstNeuron),
+	  procedural(deriveSeed(parameters.seed, PROCEDURAL_CONNECTIONS), parameters.N, parameters.N_e(), parameters.C_e(), parameters.C_i(), parameters.delaySpread),
+	  workers(parameters.threads), profiler(workers.size()), windowSpikes(2*workers.size()), drawnTargets(workers.size()), windowTargets(workers.size()),
+	  drawnDelays(workers.size()), windowDelays(workers.size()), deliveries(workers.size()),
+	  spikes(getRank() == 0 and parameters.format != NO_SPIKE_FILE ? neurons.getInstances() : 0),
+	  statistics(getRank() == 0 and not parameters.statistics.empty() ? neurons.getInstances() : 0),
+	  stepSpikes(neurons.getInstances()),
+	  spikeJ(workers.size())
 {
-	this->initialiseExcitatory();
-	this->initialiseInhibitory();
-	this->initialiseConnexions();
-	this->createConnections();
+	if(firstNeuron == lastNeuron) throw runtime_error("every rank must have a neuron");
+#ifndef NEURONS_PROFILE
+	if(not parameters.profile.empty() or not parameters.profileTrace.empty()){
+		throw runtime_error("this build has no profiler, configure it with -DNEURONS_PROFILE=ON");
+	}
+#endif
+	profiler.setTracing(not parameters.profileTrace.empty());
+	neurons.setPartitions(workers.size());
 	
-	// Ouverture du stream pour les Data
-	spikes.open(title);
+	vector<Instance> batch(parameters.instances());
+	// Arrondis une fois aux cellules de la précision : chaque ajout au ringBuffer est alors exact
+	for(size_t k(0); k < batch.size(); ++k) sourceJ.push_back(cellUnits(parameters.precision, batch[k].J_i));
+	for(size_t k(0); k < batch.size(); ++k) sourceJ.push_back(cellUnits(parameters.precision, parameters.J_e));
+
+	if(not parameters.restore.empty()){
+		
+		// Le réseau repart de l'état sauvé : ni échauffement ni construction des connexions, chaque rang lit le sien
+		CheckpointReader checkpoint(transport ? suffixed(parameters.restore, getRank()) : parameters.restore);
+		neurons.restore(checkpoint);
+		if(parameters.connectivity == STORED) network.restore(checkpoint, parameters.N, parameters.delaySpread > 0,
+														   parameters.compressTargets ? lastNeuron - firstNeuron : 0);
+		
+	} else if(parameters.connectivity == STORED){
+		
+		// Les connexions d'un réseau ne sont tirées qu'une fois : les runs suivants lisent le fichier en place
+		string cache(parameters.connectivityCache.empty() ? "" : connectionCacheFile());
+		if(cache.empty() or not mapConnections(cache)){
+			this->initialiseConnexions();
+			this->createConnections();
+			if(not cache.empty()) cacheConnections(cache);
+		}
+	}
+	
+	// Chaque thread reste sur un cpu de son nœud et écrit le premier les pages de sa partition
+	if(parameters.numa){
+		threadCpus = topology.threadCpus(workers.size());
+		pinned.assign(workers.size(), false);
+		workers.run([this](int t){ pinned[t] = pinThread(threadCpus[t]); });
+	}
+	if(parameters.numa or parameters.hugePages){
+		neurons.place(workers, parameters.hugePages);
+		if(parameters.connectivity == STORED) network.place(workers, parameters.hugePages);
+	}
+	
+	// Ouverture du stream pour les Data, un fichier par instance
+	for(size_t k(0); k < spikes.size(); ++k){
+		
+		spikeFiles.push_back(spikes.size() == 1 ? title : suffixed(title, k));
+		spikes[k].reset(SpikeWriter::create(parameters.format, spikeFiles[k], parameters.h, parameters.N));
+		
+		// Le disque n'arrête l'intégration que si writerMemory de spikes attendent déjà, mémoire partagée entre les instances
+		if(parameters.writerMemory > 0){
+			spikes[k].reset(new AsyncSpikeWriter(spikes[k].release(), (size_t(parameters.writerMemory) << 20)/spikes.size()));
+		}
+	}
+	
+	// Les statistiques ne gardent que des compteurs : les fichiers de spikes peuvent être supprimés avec format = none
+	long binSteps(max(1L, long(parameters.statisticsBin/parameters.h + 0.5)));
+	long fanoSteps(max(1L, long(parameters.fanoWindow/parameters.h + 0.5)));
+	for(size_t k(0); k < statistics.size(); ++k){
+		statistics[k].reset(new SpikeStatistics(parameters.N, parameters.N_e(), parameters.h, binSteps, fanoSteps));
+	}
 }
 
 Network::~Network()
 {
-	spikes.close();
+	spikes.clear();
 }
 
 
@@ -47,39 +194,557 @@ Network::~Network()
  * @note prints all the neurons id that spikes at a certain time
  * 		 like this :
  * 		 time in ms 	neuron n°1	neuron n°2	...
+ * @throw std::runtime_error if a rank is lost
  */
 void Network::update(double simStep)
 {
-	for(int i(0); i < N; ++i){
+	long from(neurons.getStep());
+	long to(simStep);
+	
+	if(to <= from) return;
+	
+	uint64_t started(PROFILE_TICKS());
+	
+	workers.run([this, from, to](int t){
+		
+		int parity(0);
 		
-		if(neurons[i].update(simStep)){ // Si update return true => neuron[i] spike
+		// Un spike au step s n'agit qu'au step s+minDelay : une fenêtre de minDelay steps s'intègre sans échange entre threads
+		for(long begin(from); begin < to; begin += getWindow()){
 			
-			if(simStep>plotStartTime/h and simStep<plotStopTime/h){
-				
-				spikes << simStep*h << "\t" << i << "\n";
+			const WindowSpikes* windows(&windowSpikes[parity*workers.size()]);
+			int count(workers.size());
+			uint64_t since(PROFILE_TICKS());
+			
+			integrateWindow(t, begin, min(begin + getWindow(), to), windowSpikes[parity*workers.size() + t]);
+			since = PROFILE_LAP(profiler, t, INTEGRATE, since);
+			
+			workers.barrier();
+			since = PROFILE_LAP(profiler, t, WAIT, since);
+			
+			// Avec plusieurs rangs, le thread 0 échange les spikes de la fenêtre : chaque thread livre ensuite ceux de tout le réseau
+			if(transport){
+				if(t == 0) exchangeWindow(windows);
+				since = PROFILE_LAP(profiler, t, EXCHANGE, since);
+				workers.barrier();
+				since = PROFILE_LAP(profiler, t, WAIT, since);
+				if(not transportError.empty()) return;
 				
-				for(size_t j(0); j < network[i].size(); ++j){ // On va donner un potentiel additionnel aux neurones auxquels neuron[i] est connecté
+				windows = &exchanged;
+				count = 1;
+			}
+			
+			if(t == 0 and (not spikes.empty() or not statistics.empty())){
+				recordWindow(begin, windows, count);
+				since = PROFILE_TICKS();
+			}
+			
+			deliverWindow(t, begin, windows, count);
+			since = PROFILE_LAP(profiler, t, DELIVER, since);
+			PROFILE_WINDOW(profiler, t, begin, min(getWindow(), to - begin), windowSpikes[parity*workers.size() + t].ids.size());
+			
+			parity = 1 - parity;
+		}
+	});
+	
+	PROFILE_UPDATE(profiler, started);
+	if(not transportError.empty()) throw runtime_error(transportError);
+	neurons.setStep(to);
+}
+
+/** deliver
+ * 
+ * @param step 	the step of the spikes, it must be recorded
+ * @param ids 	the neurons of the network that spike at step, sorted
+ * @note gives their EPSP to the neurons of the rank on every thread, the
+ * 		 delivery of update at the end of a window, without integrating
+ */
+void Network::deliver(long step, const std::vector<int>& ids)
+{
+	WindowSpikes window;
+	window.ids = ids;
+	window.stepEnds.push_back(ids.size());
+	
+	workers.run([this, step, &window](int t){ deliverWindow(t, step, &window, 1); });
+}
+
+/** getWindow
+ * 
+ * @return the number of steps that can be integrated before the
+ * 		   spikes are delivered, it is the shortest delay of the EPSP
+ */
+long Network::getWindow() const
+{
+	return parameters.minDelay();
+}
+
+/** getStep
+ * 
+ * @return the step up to which the network was updated
+ */
+long Network::getStep() const
+{
+	return neurons.getStep();
+}
+
+/** getRank
+ * 
+ * @return the rank of this process, 0 for a single process
+ */
+int Network::getRank() const
+{
+	return transport ? transport->getRank() : 0;
+}
+
+/** getParameters
+ * 
+ * @return the parameters of the simulation, with the network of the checkpoint when it is restored
+ */
+const Parameters& Network::getParameters() const
+{
+	return parameters;
+}
+
+/** isConnectionMapped
+ * 
+ * @return true if the stored connections are read in place in the connectivity cache
+ */
+bool Network::isConnectionMapped() const
+{
+	return network.isMapped();
+}
 
-					neurons[network[i][j]].receive(simStep-1, neurons[i].getJ());
+/** getConnectionBytes
+ * 
+ * @return the memory of the stored connections of the rank, 0 if they are regenerated
+ */
+size_t Network::getConnectionBytes() const
+{
+	return parameters.connectivity == STORED ? network.bytes() : 0;
+}
+
+/** save
+ * 
+ * @param file 	the name of the checkpoint, file_r.ext for the rank r if there are several
+ * @throw std::runtime_error if the file cannot be written
+ * @note saves the state of the neurons, the stored connections and
+ * 		 the parameters, restored by the constructor when the
+ * 		 parameter restore is this file
+ */
+void Network::save(const std::string& file) const
+{
+	ostringstream text;
+	parameters.write(text);
+	string written(text.str());
+	
+	CheckpointWriter checkpoint;
+	checkpoint.add("parameters", written.data(), written.size());
+	neurons.save(checkpoint);
+	if(parameters.connectivity == STORED) network.save(checkpoint);
+	
+	checkpoint.write(transport ? suffixed(file, getRank()) : file, neurons.getStep());
+}
+
+/** writePlacement
+ * 
+ * @param out 	receives a line for each thread : its cpu, its NUMA node, if it
+ * 				is pinned and its neurons, then the nodes and the huge pages
+ * @note nothing is placed without parameters.numa or parameters.hugePages
+ */
+void Network::writePlacement(std::ostream& out) const
+{
+	vector<int> nodes(topology.threadNodes(workers.size()));
+	
+	out << "NUMA nodes : " << topology.nodes() << "\n";
+	for(int t(0); t < workers.size(); ++t){
+		out << "thread " << t << " : ";
+		if(threadCpus.empty()) out << "not pinned";
+		else out << "cpu " << threadCpus[t] << ", node " << nodes[t] << (pinned[t] ? "" : " (not pinned)");
+		out << ", neurons [" << firstNeuron + neurons.partitionBegin(t) << ", " << firstNeuron + neurons.partitionEnd(t) << ")\n";
+	}
+	out << "placement : " << (parameters.numa ? "each partition on the node of its thread" : "none")
+		<< (parameters.numa and parameters.connectivity == STORED ? ", connections spread over the nodes" : "") << "\n"
+		<< "huge pages : " << (parameters.hugePages ? "advised" : "no") << "\n";
+}
+
+/** integrateWindow
+ * 
+ * @param t 		the thread, it integrates its partition of neurons
+ * @param begin 	the first step of the window
+ * @param end 		the step after the last one of the window
+ * @param out 		filled with the spikes of the window
+ */
+void Network::integrateWindow(int t, long begin, long end, WindowSpikes& out)
+{
+	out.ids.clear();
+	out.stepEnds.clear();
+	
+	if(not parameters.timeBlocked){
+		for(long step(begin); step < end; ++step){
+			neurons.integratePartition(t, step, out.ids);
+			out.stepEnds.push_back(out.ids.size());
+		}
+		return;
+	}
+	
+	// Chaque bloc de neurones avance de toute la fenêtre : ses spikes sont ensuite remis dans l'ordre des steps
+	for(size_t s(0); s < out.steps.size(); ++s) out.steps[s].clear();
+	neurons.integratePartition(t, begin, end, out.steps);
+	
+	for(long s(0); s < end - begin; ++s){
+		out.ids.insert(out.ids.end(), out.steps[s].begin(), out.steps[s].end());
+		out.stepEnds.push_back(out.ids.size());
+	}
+}
+
+/** exchangeWindow
+ * 
+ * @param local 	the windows of every thread of the rank
+ * @note fills exchanged with the spikes of every rank, sets transportError if a rank is lost
+ */
+void Network::exchangeWindow(const WindowSpikes* local)
+{
+	// Le message : la fin de chaque step, puis les ids du rang dans le réseau
+	size_t steps(local[0].stepEnds.size());
+	int offset(firstNeuron*neurons.getInstances());
+	
+	message.assign(steps, 0);
+	for(size_t s(0); s < steps; ++s){
+		for(int u(0); u < workers.size(); ++u){
+			for(size_t k(s == 0 ? 0 : local[u].stepEnds[s-1]); k < local[u].stepEnds[s]; ++k){
+				message.push_back(offset + local[u].ids[k]);
+			}
+		}
+		message[s] = message.size() - steps;
+	}
+	
+	try {
+		transport->allGather(message, gathered);
+	} catch(const runtime_error& error){
+		transportError = error.what();
+		return;
+	}
+	
+	// Les rangs sont dans l'ordre des neurones : les ids de chaque step restent croissants
+	exchanged.ids.clear();
+	exchanged.stepEnds.clear();
+	
+	for(size_t s(0); s < steps; ++s){
+		for(size_t r(0); r < gathered.size(); ++r){
+			const vector<int>& received(gathered[r]);
+			exchanged.ids.insert(exchanged.ids.end(), received.begin() + steps + (s == 0 ? 0 : received[s-1]),
+								 received.begin() + steps + received[s]);
+		}
+		exchanged.stepEnds.push_back(exchanged.ids.size());
+	}
+}
+
+/** deliverWindow
+ * 
+ * @param t 		the thread, it only delivers to its partition of neurons
+ * @param begin 	the first step of the window
+ * @param windows 	the spikes of the window, the ids are those of the network
+ * @param count 	the number of windows
+ * @note the spikes of the window are first expanded in lists of targets, then
+ * 		 given block of targets after block of targets so that the rows of
+ * 		 the ringBuffer of a block stay in the cache
+ */
+void Network::deliverWindow(int t, long begin, const WindowSpikes* windows, int count)
+{
+	int first(neurons.partitionBegin(t));
+	int last(neurons.partitionEnd(t));
+	const int instances(neurons.getInstances());
+	const int N_e(parameters.N_e());
+	vector<Delivery>& pending(deliveries[t]);
+	vector<double>& J(spikeJ[t]);
+	vector<int>& drawn(windowTargets[t]);
+	vector<uint8_t>& drawnDelay(windowDelays[t]);
+	const bool delayed(parameters.delaySpread > 0);
+	
+	pending.clear();
+	J.clear();
+	drawn.clear();
+	drawnDelay.clear();
+	
+	for(int u(0); u < count; ++u){
+		
+		const WindowSpikes& window(windows[u]);
+		size_t k(0);
+		
+		for(size_t s(0); s < window.stepEnds.size(); ++s){
+			
+			long spikeStep(begin + s);
+			
+			if(not isRecorded(spikeStep)){
+				k = window.stepEnds[s];
+				continue;
+			}
+			
+			while(k < window.stepEnds[s]){
+				
+				int i;
+				
+				// La source peut être d'un autre rang : son EPSP ne dépend que de son type
+				if(instances == 1){
+					i = window.ids[k++];
+					J.push_back(sourceJ[i < N_e]);
+				} else {
+					// Les ids sont ceux des états : les instances d'une même source se suivent, ses cibles ne sont lues qu'une fois
+					i = window.ids[k]/instances;
+					J.resize(J.size() + instances, 0.0);
+					double* sourceCell(&J[J.size() - instances]);
+					
+					for(; k < window.stepEnds[s] and window.ids[k]/instances == i; ++k){
+						sourceCell[window.ids[k] - i*instances] = sourceJ[(i < N_e)*instances + window.ids[k] - i*instances];
+					}
+				}
+				
+				// Chaque projection a son délai, auquel chaque synapse ajoute le sien s'ils diffèrent
+				long arrival(spikeStep + parameters.projectionDelay(i < N_e));
+				Delivery delivery = {nullptr, nullptr, nullptr, nullptr, 0, neurons.inputCells(arrival), nullptr, arrival, 0};
+				
+				if(parameters.connectivity == PROCEDURAL){
+					
+					// Seules les cibles de notre partition sont tirées à nouveau, dans les ids du rang, et gardées pour la fenêtre
+					procedural.targetsOf(i, firstNeuron + first, firstNeuron + last, drawnTargets[t], delayed ? &drawnDelays[t] : nullptr);
+					for(size_t d(0); d < drawnTargets[t].size(); ++d) drawn.push_back(drawnTargets[t][d] - firstNeuron);
+					drawnDelay.insert(drawnDelay.end(), drawnDelays[t].begin(), drawnDelays[t].end());
+					delivery.drawnEnd = drawn.size();
+					
+				} else if(network.segments() > 0){
+					
+					const int bits(Connectivity::segmentBits);
+					if(k < window.ids.size()){
+						__builtin_prefetch(network.shortTargetsOf(window.ids[k]/instances, first >> bits).first);
+					}
+					
+					// Cibles compressées : une livraison par segment de 65536 neurones de notre partition, chacune avec l'EPSP de la source
+					const uint16_t* row(network.shortTargetsOf(i, 0).first);
+					for(int segment(first >> bits); segment <= max(first, last - 1) >> bits; ++segment){
+						
+						if(segment > first >> bits){
+							size_t cell(J.size() - instances);
+							J.resize(J.size() + instances);
+							copy(J.begin() + cell, J.begin() + cell + instances, J.end() - instances);
+						}
+						
+						ShortSpan targets(network.shortTargetsOf(i, segment));
+						Delivery part(delivery);
+						part.shortTarget = lower_bound(targets.first, targets.last, first - targets.base);
+						part.shortEnd = lower_bound(part.shortTarget, targets.last, last - targets.base);
+						part.base = targets.base;
+						if(delayed) part.delay = network.delaysOf(i) + (part.shortTarget - row);
+						pending.push_back(part);
+					}
+					continue;
+					
+				} else {
+					
+					if(k < window.ids.size()){
+						__builtin_prefetch(network.targetsOf(window.ids[k]/instances).first);
+					}
+					
+					// Les cibles sont triées : seules celles de notre partition sont parcourues, sans verrou
+					Span targets(network.targetsOf(i));
+					delivery.target = lower_bound(targets.first, targets.last, first);
+					delivery.end = lower_bound(delivery.target, targets.last, last);
+					if(delayed) delivery.delay = network.delaysOf(i) + (delivery.target - targets.first);
+				}
+				
+				pending.push_back(delivery);
+			}
+		}
+	}
+	
+	// Les cibles tirées ne bougent plus : chaque livraison reçoit sa part
+	if(parameters.connectivity == PROCEDURAL){
+		size_t from(0);
+		for(size_t d(0); d < pending.size(); ++d){
+			pending[d].target = drawn.data() + from;
+			pending[d].end = drawn.data() + pending[d].drawnEnd;
+			if(delayed) pending[d].delay = drawnDelay.data() + from;
+			from = pending[d].drawnEnd;
+		}
+	}
+	
+	for(size_t d(0); d < pending.size(); ++d){
+		PROFILE_COUNT(profiler, t, SYNAPTIC_EVENTS, (pending[d].end - pending[d].target) + (pending[d].shortEnd - pending[d].shortTarget));
+		PROFILE_COUNT(profiler, t, RING_WRITES, ((pending[d].end - pending[d].target) + (pending[d].shortEnd - pending[d].shortTarget))*instances);
+	}
+	
+	// Les lignes du ringBuffer d'un bloc tiennent dans le cache : chaque cellule reçoit ses EPSP dans le même ordre qu'en un seul bloc
+	// Les délais des synapses étalent les lignes reçues au-delà de la fenêtre
+	size_t rows(getWindow() + parameters.maxDelay() - parameters.minDelay());
+	const size_t cellSize(cellBytes(parameters.precision));
+	int blockNeurons(max(size_t(64), deliveryCache/(cellSize*instances*rows)));
+	
+	for(int blockEnd(min(last, first + blockNeurons)); ; blockEnd = min(last, blockEnd + blockNeurons)){
+		
+		for(size_t d(0); d < pending.size(); ++d){
+			
+			Delivery& delivery(pending[d]);
+			
+			// La ligne suivante des cibles et sa première cellule arrivent pendant que celles-ci sont données
+			if(d + 1 < pending.size()){
+				const Delivery& next(pending[d+1]);
+				if(next.shortTarget != next.shortEnd){
+					__builtin_prefetch(next.shortTarget);
+					__builtin_prefetch(static_cast<char*>(next.row) + size_t(next.base + *next.shortTarget)*instances*cellSize, 1);
+				} else if(next.target != next.end){
+					__builtin_prefetch(next.target);
+					__builtin_prefetch(static_cast<char*>(next.row) + size_t(*next.target)*instances*cellSize, 1);
 				}
 			}
+			
+			const double* sourceCell(&J[d*instances]);
+			switch(parameters.precision){
+				case SINGLE_PRECISION : deliverSpike<float>(delivery, blockEnd, sourceCell, instances); break;
+				case FIXED_POINT : deliverSpike<int32_t>(delivery, blockEnd, sourceCell, instances); break;
+				default : deliverSpike<double>(delivery, blockEnd, sourceCell, instances);
+			}
 		}
+		
+		if(blockEnd >= last) break;
 	}
 }
 
+/** deliverSpike
+ * 
+ * @param delivery 	the spike, its targets of the block receive its EPSP
+ * @param blockEnd 	the neuron after the last one of the block
+ * @param sourceCell 	the EPSP of the source in each instance
+ * @param instances 	the number of instances
+ * @note Cell is the type of the inputs of the precision
+ */
+template<typename Cell>
+void Network::deliverSpike(Delivery& delivery, int blockEnd, const double* sourceCell, int instances)
+{
+	if(delivery.shortTarget){
+		delivery.shortTarget = deliverTargets<Cell>(delivery, delivery.shortTarget, delivery.shortEnd, delivery.base, blockEnd, sourceCell, instances);
+	} else {
+		delivery.target = deliverTargets<Cell>(delivery, delivery.target, delivery.end, 0, blockEnd, sourceCell, instances);
+	}
+}
+
+/** deliverTargets
+ * 
+ * @param delivery 	the spike : the row of its EPSP, or the delays of its targets
+ * @param target 	the next target of the spike
+ * @param end 		the end of its targets
+ * @param base 		the neuron of the target 0
+ * @param blockEnd 	the neuron after the last one of the block
+ * @param sourceCell 	the EPSP of the source in each instance
+ * @param instances 	the number of instances
+ * @return the first target after the block
+ * @note Index is int for the targets in 32 bits, uint16_t for the compressed ones
+ */
+template<typename Cell, typename Index>
+const Index* Network::deliverTargets(Delivery& delivery, const Index* target, const Index* end, int base, int blockEnd, const double* sourceCell, int instances)
+{
+	int limit(blockEnd - base);
+	
+	// L'EPSP est déjà une valeur de cellule : sa conversion est exacte, et les sommes en virgule fixe ne dépendent pas de l'ordre
+	if(delivery.delay){
+		// Chaque cible a sa ligne : le délai avance avec la cible
+		const uint8_t* delay(delivery.delay);
+		for(; target != end and *target < limit; ++target, ++delay){
+			Cell* cell(neurons.inputRow<Cell>(delivery.arrival + *delay) + size_t(base + *target)*instances);
+			for(int c(0); c < instances; ++c){
+				cell[c] += Cell(sourceCell[c]);
+			}
+		}
+		delivery.delay = delay;
+	} else if(instances == 1){
+		Cell* input(static_cast<Cell*>(delivery.row) + base);
+		Cell j(*sourceCell);
+		for(; target != end and *target < limit; ++target){ // On va donner un potentiel additionnel aux neurones auxquels neuron[i] est connecté
+			input[*target] += j;
+		}
+	} else {
+		// Une instance où la source n'a pas spiké ajoute 0 : l'input reste exactement celui de sa simulation seule
+		Cell* row(static_cast<Cell*>(delivery.row) + size_t(base)*instances);
+		for(; target != end and *target < limit; ++target){
+			Cell* cell(row + size_t(*target)*instances);
+			for(int c(0); c < instances; ++c){
+				cell[c] += Cell(sourceCell[c]);
+			}
+		}
+	}
+	return target;
+}
+
+/** recordWindow
+ * 
+ * @param begin 	the first step of the window
+ * @param windows 	the spikes of the window, in the order of the neurons
+ * @param count 	the number of windows
+ */
+void Network::recordWindow(long begin, const WindowSpikes* windows, int count)
+{
+	size_t steps(windows[0].stepEnds.size());
+	uint64_t since(PROFILE_TICKS());
+	
+	for(size_t s(0); s < steps; ++s){
+		
+		long spikeStep(begin + s);
+		if(not isRecorded(spikeStep)) continue;
+		
+		// Les partitions sont dans l'ordre : les ids du step restent croissants dans chaque instance
+		for(size_t c(0); c < stepSpikes.size(); ++c) stepSpikes[c].clear();
+		
+		for(int u(0); u < count; ++u){
+			
+			const WindowSpikes& window(windows[u]);
+			size_t first(s == 0 ? 0 : window.stepEnds[s-1]);
+			
+			if(stepSpikes.size() == 1){
+				stepSpikes[0].insert(stepSpikes[0].end(), window.ids.begin() + first, window.ids.begin() + window.stepEnds[s]);
+				continue;
+			}
+			
+			// L'état id*instances + k est le neurone id de l'instance k
+			for(size_t k(first); k < window.stepEnds[s]; ++k){
+				stepSpikes[window.ids[k]%stepSpikes.size()].push_back(window.ids[k]/stepSpikes.size());
+			}
+		}
+		
+		since = PROFILE_LAP(profiler, 0, RECORD, since);
+		
+		// le spike du step s est rendu par update(s+1)
+		for(size_t c(0); c < spikes.size(); ++c){
+			spikes[c]->writeStep(spikeStep+1, stepSpikes[c].data(), stepSpikes[c].size());
+		}
+		for(size_t c(0); c < statistics.size(); ++c){
+			statistics[c]->record(spikeStep+1, stepSpikes[c].data(), stepSpikes[c].size());
+		}
+		since = PROFILE_LAP(profiler, 0, WRITE, since);
+	}
+}
+
+/** isRecorded
+ * 
+ * @param spikeStep 	the step of a spike
+ * @return true if the spike is printed and delivered
+ */
+bool Network::isRecorded(long spikeStep) const
+{
+	// le spike du step s est rendu par update(s+1)
+	return spikeStep+1 > plotStartStep and spikeStep+1 < plotStopStep;
+}
+
 /** writeSpikes
  * 
  * @param out 	the file in which we want to print the spikes
  * @note gives the spike's times for each neuron like this :
  * 		neuron id 	 spike time n°1 	spike time n°2	...
- * 
+ * @note only the spikes of the first instance and of the neurons of the rank are written
  */
 void Network::writeSpikes(ofstream& out)
 {
-	for(int i(0); i < N; ++i){
+	for(int i(0); i < neurons.size(); ++i){
 		
-		out << "\t" << i << "\t";
-		vector<long> spikesTime(neurons[i].getSpikesTime());
+		out << "\t" << firstNeuron + i << "\t";
+		SpikeTimes spikesTime(neurons.getSpikesTime(i));
 		
 		for(size_t j(0); j < spikesTime.size(); ++j){
 			out << spikesTime[j] << "\t";
@@ -88,29 +753,69 @@ void Network::writeSpikes(ofstream& out)
 	}
 }
 
-/** initialiseExcitatory
+/** getStatistics
  * 
- * @note initialise the right number of excitatory neurons in
- * 		 the network according to the constants.hpp file
+ * @param instance 	an instance of the batch
+ * @return the statistics of the spikes of the instance recorded so far, nullptr
+ * 		   if parameters.statistics is empty or on the other ranks
  */
-void Network::initialiseExcitatory()
+const SpikeStatistics* Network::getStatistics(int instance) const
 {
-	for(size_t i(0); i < N_e; ++i){
-		Neuron n(EXCITATORY);
-		neurons.push_back(n); 
+	return statistics.empty() ? nullptr : statistics[instance].get();
+}
+
+/** writeStatistics
+ * 
+ * @note writes the statistics of the recorded spikes in the file
+ * 		 parameters.statistics, title_k.ext for the instance k if
+ * 		 there are several, nothing if it is empty or on the other ranks
+ * @throw std::runtime_error if a file cannot be written
+ */
+void Network::writeStatistics() const
+{
+	for(size_t k(0); k < statistics.size(); ++k){
+		
+		string file(statistics.size() == 1 ? parameters.statistics : suffixed(parameters.statistics, k));
+		ofstream out(file);
+		statistics[k]->write(out);
+		
+		if(not out) throw runtime_error("cannot write the statistics in '" + file + "'");
 	}
 }
 
-/** initialiseInhibitory
+/** writeProfile
  * 
- * @note initialise the right number of inhibitory neurons in
- * 		 the network according to the constants.hpp file
+ * @note writes the report of the timers and counters in parameters.profile
+ * 		 and the phases of every window in parameters.profileTrace,
+ * 		 file_r.ext for the rank r if there are several, nothing if both are empty
+ * @note closes the spike files first so that their whole size is
+ * 		 counted : the spikes of the next updates are not written
+ * @throw std::runtime_error if a file cannot be written
  */
-void Network::initialiseInhibitory()
+void Network::writeProfile()
 {
-	for(size_t i(N_e); i < N; ++i){
-		Neuron n(INHIBITORY);
-		neurons.push_back(n);
+	if(parameters.profile.empty() and parameters.profileTrace.empty()) return;
+	
+	// Le writer en arrière-plan n'a fini d'écrire qu'une fois détruit
+	spikes.clear();
+	uint64_t bytes(0);
+	for(size_t k(0); k < spikeFiles.size(); ++k){
+		ifstream in(spikeFiles[k], ios::binary | ios::ate);
+		if(in) bytes += in.tellg();
+	}
+	
+	if(not parameters.profile.empty()){
+		string file(transport ? suffixed(parameters.profile, getRank()) : parameters.profile);
+		ofstream out(file);
+		profiler.write(out, bytes);
+		if(not out) throw runtime_error("cannot write the profile in '" + file + "'");
+	}
+	
+	if(not parameters.profileTrace.empty()){
+		string file(transport ? suffixed(parameters.profileTrace, getRank()) : parameters.profileTrace);
+		ofstream out(file);
+		profiler.writeTrace(out);
+		if(not out) throw runtime_error("cannot write the trace of the profile in '" + file + "'");
 	}
 }
 
@@ -120,40 +825,121 @@ void Network::initialiseInhibitory()
  */
 void Network::initialiseConnexions()
 {
-	for(size_t i(0); i < N; ++i){
-		vector<int> neuronsInitialisation;
-		network.push_back(neuronsInitialisation);
-	}
+	network.reset(parameters.N);
 }
 
 /** createConnexions
  * 
  * @note create randomly according to the poisson's law the
  * 		 connections between the neurons of the network
+ * @note each target draws its sources from its own counter-based streams :
+ * 		 the threads draw their targets at once and the network does not
+ * 		 depend on the number of threads or ranks
  */
 void Network::createConnections()
 {
-	for(int i(0); i < N; ++i){
-		
-		// ... excitatory
-		for(int j(0); j < C_e; ++j){
-		
-			static std::random_device rd;
-			static std::mt19937 gen(rd());
-			static std::uniform_int_distribution<> connexion_from(0, N_e-1);
+	const int N(parameters.N), N_e(parameters.N_e()), C_e(parameters.C_e()), C_i(parameters.C_i());
+	const int n(lastNeuron - firstNeuron), inputs(C_e + C_i), spread(parameters.delaySpread);
+	const uint64_t excitatorySeed(deriveSeed(parameters.seed, EXCITATORY_CONNECTIONS));
+	const uint64_t inhibitorySeed(deriveSeed(parameters.seed, INHIBITORY_CONNECTIONS));
+	const uint64_t delaySeed(deriveSeed(parameters.seed, SYNAPTIC_DELAYS));
+	
+	// Les sources tirées sont gardées le temps de la construction, écrites la première fois par le thread qui les tire
+	PlacedVector<int> sources(size_t(n)*inputs);
+	PlacedVector<uint8_t> delays(spread > 0 ? sources.size() : 0);
+	
+	workers.run([&](int t){
+		for(int i(long(n)*t/workers.size()); i < long(n)*(t + 1)/workers.size(); ++i){
 			
-			network[connexion_from(gen)].push_back(i);
-
-		}
-			// ... inhibitory
-		for(int j(0); j < C_i; ++j){
+			// Les flux sont ceux du neurone dans le réseau entier : chaque rang ne tire que ses cibles
+			CounterStream excitatory(excitatorySeed, firstNeuron + i), inhibitory(inhibitorySeed, firstNeuron + i);
+			int* drawn(&sources[size_t(i)*inputs]);
 			
-			static std::random_device rd;
-			static std::mt19937 gen(rd());
-			static std::uniform_int_distribution<> connexion_from(N_e, N-1); // N-1 - N_e = N_i
-		
-			network[connexion_from(gen)].push_back(i);
+			// Une source uniforme par un produit au lieu d'une division
+			for(int j(0); j < C_e; ++j) drawn[j] = int((uint64_t(excitatory())*uint64_t(N_e)) >> 32);
+			for(int j(C_e); j < inputs; ++j) drawn[j] = N_e + int((uint64_t(inhibitory())*uint64_t(N - N_e)) >> 32);
+			
+			if(spread > 0){
+				CounterStream delay(delaySeed, firstNeuron + i);
+				for(int j(0); j < inputs; ++j) delays[size_t(i)*inputs + j] = spreadDelay(delay(), spread);
+			}
 		}
+	});
+	
+	// i croissant : les cibles de chaque neurone sont triées, ce que deliverWindow utilise, dans les ids du rang
+	network.build(workers, n, inputs, sources.data(), spread > 0 ? delays.data() : nullptr, parameters.compressTargets ? n : 0);
+}
+
+/** connectionCacheKey
+ * 
+ * @return every value that changes the stored connections of the rank
+ */
+vector<uint64_t> Network::connectionCacheKey() const
+{
+	return {connectionCacheVersion, uint64_t(parameters.N), uint64_t(parameters.N_e()), uint64_t(parameters.C_e()),
+			uint64_t(parameters.C_i()), parameters.seed, uint64_t(parameters.delaySpread), uint64_t(parameters.compressTargets),
+			uint64_t(firstNeuron), uint64_t(lastNeuron)};
+}
 
+/** connectionCacheFile
+ * 
+ * @return the file of the connectivity cache that keeps the connections of the rank
+ */
+string Network::connectionCacheFile() const
+{
+	vector<uint64_t> key(connectionCacheKey());
+	
+	ostringstream name;
+	name << parameters.connectivityCache << "/connections_v" << key[0] << "_N" << key[1] << "_Ne" << key[2]
+		 << "_Ce" << key[3] << "_Ci" << key[4] << "_seed" << key[5] << "_spread" << key[6]
+		 << (key[7] ? "_16bits" : "_32bits") << "_" << key[8] << "-" << key[9] << ".ckpt";
+	return name.str();
+}
+
+/** mapConnections
+ * 
+ * @param file 	the file of the connectivity cache
+ * @return true if the connections are read in place in file, false if it is
+ * 		   missing or was not written for this network
+ */
+bool Network::mapConnections(const string& file)
+{
+	shared_ptr<const CheckpointReader> cache;
+	
+	try {
+		cache = make_shared<const CheckpointReader>(file);
+		size_t bytes;
+		vector<uint64_t> key(connectionCacheKey());
+		const void* written(cache->read("cacheKey", bytes));
+		if(bytes != key.size()*sizeof(uint64_t) or not equal(key.begin(), key.end(), static_cast<const uint64_t*>(written))) return false;
+		
+		network.map(cache, parameters.N, parameters.delaySpread > 0, parameters.compressTargets ? lastNeuron - firstNeuron : 0);
+		
+	} catch(const runtime_error&){
+		// Un fichier absent ou d'une autre version est tiré à nouveau, puis remplacé
+		return false;
 	}
+	return true;
+}
+
+/** cacheConnections
+ * 
+ * @param file 	the file of the connectivity cache
+ * @throw std::runtime_error if the file cannot be written
+ * @note saves the connections just drawn, then reads them in place in the
+ * 		 file like the next runs : its pages are shared by every process
+ */
+void Network::cacheConnections(const string& file)
+{
+	if(mkdir(parameters.connectivityCache.c_str(), 0777) != 0 and errno != EEXIST){
+		throw runtime_error("cannot create the connectivity cache '" + parameters.connectivityCache + "'");
+	}
+	
+	vector<uint64_t> key(connectionCacheKey());
+	CheckpointWriter cache;
+	cache.add("cacheKey", key);
+	network.save(cache);
+	cache.write(file, 0);
+	
+	if(not mapConnections(file)) throw runtime_error("cannot read the connectivity cache '" + file + "'");
 }
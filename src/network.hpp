@@ -6,12 +6,26 @@
  */
 
 #include "neuron.hpp"
+#include "workerPool.hpp"
+#include "connectivity.hpp"
+#include "proceduralConnectivity.hpp"
+#include "parameters.hpp"
+#include "spikeFile.hpp"
+#include "asyncSpikeWriter.hpp"
+#include "spikeTransport.hpp"
+#include "spikeStatistics.hpp"
+#include "profiler.hpp"
+#include "topology.hpp"
 #include <fstream>
 #include <string>
+#include <memory>
 
 #ifndef NETWORK_H
 #define NETWORK_H
 
+/// Uses of the seed of the simulation, each one gets its own derived seed
+enum SeedUse {EXTERNAL_INPUT, EXCITATORY_CONNECTIONS, INHIBITORY_CONNECTIONS, PROCEDURAL_CONNECTIONS, SYNAPTIC_DELAYS, seedUseSize};
+
 class Network
 {
 	public :
@@ -20,14 +34,29 @@ class Network
 		 * 
 		 * @param title	the title of the file in which we want to 
 		 * 					print the data of the update
+		 * @param parameters 	the parameters of the simulation : the model, the
+		 * 					number of threads (each one owns a contiguous range of
+		 * 					neurons), the connectivity mode and the seed (the same
+		 * 					seed gives the same spikes whatever the number of threads)
 		 * 
-		 * @note opens the flow to write the data
+		 * @note opens the flow to write the data, one file per instance of
+		 * 		 the batch, title_k.ext for the instance k if there are several
+		 * @note with several ranks, this process only simulates the neurons of
+		 * 		 its rank and only stores their inputs, the rank 0 writes the
+		 * 		 data of the whole network, the same as a single process
+		 * @note with parameters.connectivityCache, the stored connections are drawn
+		 * 		 once per network and read in place in the cache by the next runs
+		 * @note with parameters.restore, the network is the one of the checkpoint : its
+		 * 		 seed, neurons, connections, EPSP, delays and batch replace those of parameters
+		 * @throw std::runtime_error if parameters.restore is not a checkpoint of this
+		 * 		  network or was saved with another given seed, the ranks cannot be
+		 * 		  connected or the cache cannot be written
 		 */
-		Network(std::string title);
+		Network(std::string title, const Parameters& parameters = Parameters());
 		
 		/** Destructor
 		 * 
-		 * @note close the flow used to write the data
+		 * @note close the flow used to write the data, once every spike is written
 		 */
 		~Network();
 		
@@ -39,38 +68,171 @@ class Network
 		 * @note prints all the neurons id that spikes at a certain time
 		 * 		 like this :
 		 * 		 time in ms 	neuron n°1	neuron n°2	...
+		 * @note the steps are integrated by windows of at most getWindow()
+		 * 		 steps, the threads and the ranks only synchronise once per window
+		 * @throw std::runtime_error if a rank is lost
 		 */
 		void update(double simStep);
 		
+		/** deliver
+		 * 
+		 * @param step 	the step of the spikes, it must be recorded
+		 * @param ids 	the neurons of the network that spike at step, sorted
+		 * @note gives their EPSP to the neurons of the rank on every thread, the
+		 * 		 delivery of update at the end of a window, without integrating
+		 */
+		void deliver(long step, const std::vector<int>& ids);
+		
+		/** getWindow
+		 * 
+		 * @return the number of steps that can be integrated before the
+		 * 		   spikes are delivered, it is the delay of the EPSP
+		 */
+		long getWindow() const;
+		
+		/** getStep
+		 * @return the step up to which the network was updated
+		 */
+		long getStep() const;
+		
+		/** getRank
+		 * @return the rank of this process, 0 for a single process
+		 */
+		int getRank() const;
+		
+		/** getParameters
+		 * @return the parameters of the simulation, with the network of the checkpoint when it is restored
+		 */
+		const Parameters& getParameters() const;
+		
+		/** isConnectionMapped
+		 * @return true if the stored connections are read in place in the connectivity cache
+		 */
+		bool isConnectionMapped() const;
+		
+		/** getConnectionBytes
+		 * @return the memory of the stored connections of the rank, 0 if they are regenerated
+		 */
+		size_t getConnectionBytes() const;
+		
+		/** save
+		 * 
+		 * @param file 	the name of the checkpoint, file_r.ext for the rank r if there are several
+		 * @throw std::runtime_error if the file cannot be written
+		 * @note saves the state of the neurons, the stored connections and
+		 * 		 the parameters, restored by the constructor when the
+		 * 		 parameter restore is this file
+		 */
+		void save(const std::string& file) const;
+		
 		/** writeSpikes
 		 * 
 		 * @param out 	the file in which we want to print the spikes
 		 * @note gives the spike's times for each neuron like this :
 		 * 		neuron id 	 spike time n°1 	spike time n°2	...
-		 * 
+		 * @note only the spikes of the first instance and of the neurons of the rank are written
 		 */
 		void writeSpikes(std::ofstream& out);
 		
-	private :
-	
-		std::vector<Neuron> neurons; //!< List of the neurons of the network
-		std::vector<std::vector<int>> network; //!< Behold the informations about the connections between the neurons of the network
+		/** getStatistics
+		 * 
+		 * @param instance 	an instance of the batch
+		 * @return the statistics of the spikes of the instance recorded so far, nullptr
+		 * 		   if parameters.statistics is empty or on the other ranks
+		 */
+		const SpikeStatistics* getStatistics(int instance = 0) const;
 		
-		std::ofstream spikes; //!< Flow that connect to the data file
+		/** writeStatistics
+		 * 
+		 * @note writes the statistics of the recorded spikes in the file
+		 * 		 parameters.statistics, title_k.ext for the instance k if
+		 * 		 there are several, nothing if it is empty or on the other ranks
+		 * @throw std::runtime_error if a file cannot be written
+		 */
+		void writeStatistics() const;
 		
-		/** initialiseExcitatory
+		/** writeProfile
 		 * 
-		 * @note initialise the right number of excitatory neurons in
-		 * 		 the network according to the constants.hpp file
+		 * @note writes the report of the timers and counters in parameters.profile
+		 * 		 and the phases of every window in parameters.profileTrace,
+		 * 		 file_r.ext for the rank r if there are several, nothing if both are empty
+		 * @note closes the spike files first so that their whole size is
+		 * 		 counted : the spikes of the next updates are not written
+		 * @throw std::runtime_error if a file cannot be written
 		 */
-		void initialiseExcitatory();
+		void writeProfile();
 		
-		/** initialiseInhibitory
+		/** writePlacement
 		 * 
-		 * @note initialise the right number of inhibitory neurons in
-		 * 		 the network according to the constants.hpp file
+		 * @param out 	receives a line for each thread : its cpu, its NUMA node, if it
+		 * 				is pinned and its neurons, then the nodes and the huge pages
+		 * @note nothing is placed without parameters.numa or parameters.hugePages
 		 */
-		void initialiseInhibitory();
+		void writePlacement(std::ostream& out) const;
+		
+	private :
+	
+		static const size_t deliveryCache = 1 << 21; //!< Bytes of the rows of the ringBuffer of a block of targets delivered at once, about a L2 cache
+		
+		/** WindowSpikes
+		 *  spikes of the neurons of one thread during one window
+		 */
+		struct WindowSpikes
+		{
+			std::vector<int> ids; //!< Ids of the neurons that spiked, step after step
+			std::vector<size_t> stepEnds; //!< For each step of the window, the end of its ids
+			std::vector<std::vector<int>> steps; //!< Ids of each step, filled when the neurons are integrated by blocks
+		};
+		
+		/** Delivery
+		 *  targets of one spike in the partition of a thread, given block after block
+		 */
+		struct Delivery
+		{
+			const int* target; //!< Next target to receive the EPSP
+			const int* end; //!< End of the targets
+			const uint16_t* shortTarget; //!< Next target if they are compressed, relative to base, nullptr otherwise
+			const uint16_t* shortEnd; //!< End of the compressed targets
+			int base; //!< Neuron of the compressed target 0
+			void* row; //!< Row of the ringBuffer that receives the EPSP, if the targets have no delays, in the cells of the precision
+			const uint8_t* delay; //!< Delay of each target after arrival, nullptr if every target of the projection has the same
+			long arrival; //!< Step at which the EPSP arrives with the delay of the projection
+			size_t drawnEnd; //!< End of the targets in the drawn targets of the window, in PROCEDURAL mode
+		};
+		
+		std::unique_ptr<SpikeTransport> transport; //!< Exchange of the spikes with the other ranks, none for a single process
+		Parameters parameters; //!< Parameters of the simulation, those of the network taken from the checkpoint when it is restored
+		double plotStartStep; //!< Steps of plotStartTime and plotStopTime
+		double plotStopStep;
+		int firstNeuron; //!< First neuron simulated by this rank
+		int lastNeuron; //!< Neuron after the last one simulated by this rank
+		NeuronPopulation neurons; //!< State of the neurons of the rank, stored as contiguous arrays, the neuron i is the neuron firstNeuron+i of the network
+		Connectivity network; //!< Behold the informations about the connections between the neurons of the network, sorted targets of the rank
+		ProceduralConnectivity procedural; //!< Generator of the connections in PROCEDURAL mode
+		
+		WorkerPool workers; //!< Threads that update the network
+		Profiler profiler; //!< Timers of the phases and counters of each thread, only used if the build defines NEURONS_PROFILE
+		std::vector<WindowSpikes> windowSpikes; //!< Two windows (the current one and the previous one) of every thread, window p of the thread t at p*threads+t
+		std::vector<int> message; //!< Spikes of the rank sent to the other ranks : the end of each step, then the ids
+		std::vector<std::vector<int>> gathered; //!< Message of every rank
+		WindowSpikes exchanged; //!< Spikes of the whole network during the window, gathered from every rank
+		std::string transportError; //!< Error of the last exchange, empty if it succeeded
+		std::vector<std::vector<int>> drawnTargets; //!< Targets drawn by each thread in PROCEDURAL mode
+		std::vector<std::vector<int>> windowTargets; //!< Targets drawn by each thread for the whole window in PROCEDURAL mode
+		std::vector<std::vector<uint8_t>> drawnDelays; //!< Delays of the targets drawn by each thread in PROCEDURAL mode, with a delay spread
+		std::vector<std::vector<uint8_t>> windowDelays; //!< Delays of the targets drawn for the whole window
+		std::vector<std::vector<Delivery>> deliveries; //!< Spikes of the window expanded in targets, for each thread
+		
+		std::vector<std::unique_ptr<SpikeWriter>> spikes; //!< Writer of the data file of each instance, in the format of the parameters, on a background thread if writerMemory > 0
+		std::vector<std::string> spikeFiles; //!< Name of the data file of each instance
+		std::vector<std::unique_ptr<SpikeStatistics>> statistics; //!< Statistics of the spikes of each instance, kept instead of or with the data files
+		std::vector<std::vector<int>> stepSpikes; //!< Ids of the spikes of one step of each instance, gathered from every thread
+		std::vector<std::vector<double>> spikeJ; //!< For each thread, the EPSP of each delivery in each instance, 0 if its source did not spike
+		std::vector<double> sourceJ; //!< EPSP of an inhibitory source in the instance k at k, of an excitatory one at instances+k, rounded to the cells of the precision
+		
+		Topology topology; //!< NUMA nodes of the machine
+		std::vector<int> threadCpus; //!< Cpu of each thread, if parameters.numa
+		std::vector<char> pinned; //!< True if the thread runs only on its cpu
 		
 		/** initialiseConnexions
 		 * 
@@ -85,6 +247,101 @@ class Network
 		 */
 		void createConnections();
 		
+		/** connectionCacheKey
+		 * 
+		 * @return every value that changes the stored connections of the rank
+		 */
+		std::vector<uint64_t> connectionCacheKey() const;
+		
+		/** connectionCacheFile
+		 * 
+		 * @return the file of the connectivity cache that keeps the connections of the rank
+		 */
+		std::string connectionCacheFile() const;
+		
+		/** mapConnections
+		 * 
+		 * @param file 	the file of the connectivity cache
+		 * @return true if the connections are read in place in file, false if it is
+		 * 		   missing or was not written for this network
+		 */
+		bool mapConnections(const std::string& file);
+		
+		/** cacheConnections
+		 * 
+		 * @param file 	the file of the connectivity cache
+		 * @throw std::runtime_error if the file cannot be written
+		 * @note saves the connections just drawn, then reads them in place in the
+		 * 		 file like the next runs : its pages are shared by every process
+		 */
+		void cacheConnections(const std::string& file);
+		
+		/** integrateWindow
+		 * 
+		 * @param t 		the thread, it integrates its partition of neurons
+		 * @param begin 	the first step of the window
+		 * @param end 		the step after the last one of the window
+		 * @param out 		filled with the spikes of the window
+		 */
+		void integrateWindow(int t, long begin, long end, WindowSpikes& out);
+		
+		/** exchangeWindow
+		 * 
+		 * @param local 	the windows of every thread of the rank
+		 * @note fills exchanged with the spikes of every rank, sets transportError if a rank is lost
+		 */
+		void exchangeWindow(const WindowSpikes* local);
+		
+		/** deliverWindow
+		 * 
+		 * @param t 		the thread, it only delivers to its partition of neurons
+		 * @param begin 	the first step of the window
+		 * @param windows 	the spikes of the window, the ids are those of the network
+		 * @param count 	the number of windows
+		 */
+		void deliverWindow(int t, long begin, const WindowSpikes* windows, int count);
+		
+		/** deliverSpike
+		 * 
+		 * @param delivery 	the spike, its targets of the block receive its EPSP
+		 * @param blockEnd 	the neuron after the last one of the block
+		 * @param sourceCell 	the EPSP of the source in each instance
+		 * @param instances 	the number of instances
+		 * @note Cell is the type of the inputs of the precision
+		 */
+		template<typename Cell>
+		void deliverSpike(Delivery& delivery, int blockEnd, const double* sourceCell, int instances);
+		
+		/** deliverTargets
+		 * 
+		 * @param delivery 	the spike : the row of its EPSP, or the delays of its targets
+		 * @param target 	the next target of the spike
+		 * @param end 		the end of its targets
+		 * @param base 		the neuron of the target 0
+		 * @param blockEnd 	the neuron after the last one of the block
+		 * @param sourceCell 	the EPSP of the source in each instance
+		 * @param instances 	the number of instances
+		 * @return the first target after the block
+		 * @note Index is int for the targets in 32 bits, uint16_t for the compressed ones
+		 */
+		template<typename Cell, typename Index>
+		const Index* deliverTargets(Delivery& delivery, const Index* target, const Index* end, int base, int blockEnd, const double* sourceCell, int instances);
+		
+		/** recordWindow
+		 * 
+		 * @param begin 	the first step of the window
+		 * @param windows 	the spikes of the window, in the order of the neurons
+		 * @param count 	the number of windows
+		 */
+		void recordWindow(long begin, const WindowSpikes* windows, int count);
+		
+		/** isRecorded
+		 * 
+		 * @param spikeStep 	the step of a spike
+		 * @return true if the spike is printed and delivered
+		 */
+		bool isRecorded(long spikeStep) const;
+		
 };
 
 
@@ -12,27 +12,73 @@
 
 using namespace std;
 
+/** sharedSeed
+ * 
+ * @return the next seed of the engine shared by the standalone neurons, seeded once
+ */
+static uint64_t sharedSeed()
+{
+	static mt19937_64 engine(random_device{}());
+	return engine();
+}
+
 /** Constructor
  *  needs a type (INHIBITORY or EXCITATORY) to set the specific J (the amplitude of the EPSP)
- *  @note the neuron is REFRACTORY by default
+ *  @note the neuron owns a population of one neuron, its external input is
+ *  	  seeded by an engine shared by the standalone neurons
  *  @param type
  */
  
 Neuron::Neuron(Type type)
-	: localStep(0), type(type)
+	: Neuron(type, sharedSeed())
+{}
+
+/** Constructor
+ *  @param type	the type of the neuron
+ *  @param seed	the seed of its external input
+ *  @note the neuron owns a population of one neuron
+ */
+
+Neuron::Neuron(Type type, uint64_t seed)
+	: owned(new NeuronPopulation(1, type == EXCITATORY ? 1 : 0, seed)), population(owned.get()), id(0)
+{}
+
+/** Copy constructor
+ *  @param other 	the neuron copied
+ *  @note a standalone neuron gets its own copy of the state, a view stays on the same population
+ */
+
+Neuron::Neuron(const Neuron& other)
+	: owned(other.owned ? new NeuronPopulation(*other.owned) : nullptr),
+	  population(other.owned ? owned.get() : other.population), id(other.id), spiking(other.spiking)
+{}
+
+/** operator=
+ *  @param other 	the neuron copied, like the copy constructor
+ *  @return this neuron
+ */
+
+Neuron& Neuron::operator=(const Neuron& other)
 {
-	state = REFRACTORY;
-	v = v_res; //mV
-	spikes.clear();
-	ringBuffer.resize(bufferDelay + 1);
-	
-	if(type == INHIBITORY){
-		J = J_i;
-	} else { // otherwise it's EXCITATORY
-		J = J_e;
+	if(this != &other){
+		owned.reset(other.owned ? new NeuronPopulation(*other.owned) : nullptr);
+		population = other.owned ? owned.get() : other.population;
+		id = other.id;
+		spiking = other.spiking;
 	}
+	return *this;
 }
 
+/** Constructor
+ *  @param population 	the population in which the neuron is stored
+ *  @param id 			the id of the neuron in the population
+ *  @note update and updateTest integrate the whole population
+ */
+
+Neuron::Neuron(NeuronPopulation& population, int id)
+	: population(&population), id(id)
+{}
+
 /** update
  * 
  *  @param simStep 	the time expressed in steps at which the neuron update
@@ -42,46 +88,10 @@ Neuron::Neuron(Type type)
 
 bool Neuron::update(double simStep)
 {
-	bool isSpiking(false);
+	spiking.clear();
+	population->update(simStep, spiking);
 	
-	while(localStep < simStep){
-		
-		updateState(localStep);
-		
-		if(state == ACTIVE) {
-
-			// Distribution de poisson
-			//static poisson_distribution<> poisson(nu_ext * h);
-			static poisson_distribution<> poisson(lambda);
-			static random_device rd;
-			static mt19937 gen(rd());
-			
-			//cout << (nu_ext * h) << endl;
-			// Potentiel de la membrane
-			double r(tau/c);
-			int x(localStep);
-			
-			v = c1*v + ringBuffer[x%(bufferDelay+1)] + J_e*poisson(gen);
-			
-			// Réinitialisation de la cellule du ringBuffer qui vient d'être utilisée
-			ringBuffer[x%(bufferDelay+1)] = 0;
-			
-			// Spike (20mV)
-			if(v > v_th) {
-				v = v_res;
-				spikes.push_back(localStep);
-				isSpiking = true;
-			}
-			
-		} else {
-			
-			v = v_res; // refractory
-			
-		}
-		
-		localStep += 1;
-	}
-	return isSpiking;
+	return hasSpiked();
 }
 
 /** updateTest
@@ -94,61 +104,23 @@ bool Neuron::update(double simStep)
  */
 bool Neuron::updateTest(double iExt, double simStep)
 {
-	bool isSpiking(false);
-	
-	while(localStep < simStep){
-		
-		updateState(localStep);
-		int x(localStep);
-		if(state == ACTIVE) {
-				
-				
-				
-				v = c1*v + c2*iExt + ringBuffer[x%(bufferDelay+1)];
-				
-				// Réinitialisation de la cellule du ringBuffer qui vient d'être utilisée
-				//ringBuffer[x%(bufferDelay+1)] = 0;
-				
-				// Spike (20mV)
-				if(v > v_th) {
-					v = v_res;
-					spikes.push_back(localStep);
-					isSpiking = true;
-				}
-				
-			} else {
-				
-				v = v_res; // refractory
-				
-				// Réinitialisation de la cellule du ringBuffer qui aurait du être utilisée si on avait pas été refractory
-				//ringBuffer[x%(bufferDelay+1)] = 0;
-			}
-			
-			// Réinitialisation de la cellule du ringBuffer correspondant à notre step
-			ringBuffer[x%(bufferDelay+1)] = 0;
-				
-		localStep += 1;
-	}
+	spiking.clear();
+	population->updateTest(iExt, simStep, spiking);
 	
-	return isSpiking;
+	return hasSpiked();
 }
 
-/** updateState
+/** hasSpiked
  * 
- * @param simStep 	the time given in steps
- * @brief manage the switch between the ACTIVE and REFRACTORY state
- *   	  if the neurons spikes, it will be REFRACTORY for a certain 
- * 		  number of steps given by refractorySteps
+ * @return true if the neuron is in the spiking list of the last update
  */
  
-void Neuron::updateState(double simStep)
+bool Neuron::hasSpiked() const
 {
-	if(spikes.empty() or abs(spikes.back() - (simStep)) > refractorySteps) {
-		state = ACTIVE;
-	} else {
-		state = REFRACTORY;
+	for(size_t i(0); i < spiking.size(); ++i){
+		if(spiking[i] == id) return true;
 	}
-	
+	return false;
 }
 
 /** getSpikesTime
@@ -156,9 +128,9 @@ void Neuron::updateState(double simStep)
  * @return spikes	the step when a spike occured
  */
  
-vector<long> Neuron::getSpikesTime()
+SpikeTimes Neuron::getSpikesTime()
 {
-	return spikes;
+	return population->getSpikesTime(id);
 }
 
 /** getV
@@ -168,7 +140,7 @@ vector<long> Neuron::getSpikesTime()
 
 double Neuron::getV()
 {
-	return v;
+	return population->getV(id);
 }
 
 /** getJ
@@ -178,8 +150,7 @@ double Neuron::getV()
 
 double Neuron::getJ()
 {
-	
-	return J;
+	return population->getJ(id);
 }
 
 
@@ -192,6 +163,5 @@ double Neuron::getJ()
  
 void Neuron::receive(long step, double J) 
 {
-	int x(step);
-	ringBuffer[(x+bufferDelay)%(bufferDelay)] += J;
+	population->receive(id, step, J);
 }
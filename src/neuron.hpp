@@ -7,17 +7,18 @@
  
 #include <iostream>
 #include <vector>
+#include <memory>
 #include <cmath>
 #include "constants.hpp"
+#include "neuronPopulation.hpp"
  
 #ifndef NEURON_H
 #define NEURON_H
 
-/// State of the neuron : Active or Refractory
-enum State {ACTIVE, REFRACTORY, stateSize};
-/// Type of the neuron : Excitatory or Inhibitory
-enum Type {INHIBITORY, EXCITATORY, typeSize};
-
+/** Neuron
+ *  thin view on one neuron of a NeuronPopulation, the state itself
+ *  is stored in the arrays of the population
+ */
 class Neuron
 {
 	
@@ -25,11 +26,38 @@ class Neuron
 
 		/** Constructor
 		 *  needs a type (INHIBITORY or EXCITATORY) to set the specific J (the amplitude of the EPSP)
-		 *  @note the neuron is REFRACTORY by default
+		 *  @note the neuron owns a population of one neuron, its external input is
+		 *  	  seeded by an engine shared by the standalone neurons
 		 *  @param type	the type of the neuron
 		 */
 		Neuron(Type type);
 		
+		/** Constructor
+		 *  @param type	the type of the neuron
+		 *  @param seed	the seed of its external input
+		 *  @note the neuron owns a population of one neuron
+		 */
+		Neuron(Type type, uint64_t seed);
+		
+		/** Copy constructor
+		 *  @param other 	the neuron copied
+		 *  @note a standalone neuron gets its own copy of the state, a view stays on the same population
+		 */
+		Neuron(const Neuron& other);
+		
+		/** operator=
+		 *  @param other 	the neuron copied, like the copy constructor
+		 *  @return this neuron
+		 */
+		Neuron& operator=(const Neuron& other);
+		
+		/** Constructor
+		 *  @param population 	the population in which the neuron is stored
+		 *  @param id 			the id of the neuron in the population
+		 *  @note update and updateTest integrate the whole population
+		 */
+		Neuron(NeuronPopulation& population, int id);
+		
 		/** update
 		 *  @param simStep 	the time expressed in steps at which the neuron update
 		 *  @retval TRUE	the neuron spikes
@@ -50,7 +78,7 @@ class Neuron
 		/** getSpikesTime
 		 * @return spikes	the step when a spike occured
 		 */
-		std::vector<long> getSpikesTime();
+		SpikeTimes getSpikesTime();
 		
 		/** getV
 		 * @return v 	the membrane potential of the neuron
@@ -71,22 +99,16 @@ class Neuron
 
 	private :
 	
-		State state; //!< State of the neuron : Active or Refractory
-		Type type; //!< Type of the neuron : Excitatory or Inhibitory
-		double v; //!< Membrane potential
-		double J; //!< Amplitude of the EPSP (excitatory post synaptic potential)
-		std::vector<long> spikes; //!< List of the steps at which the neuron spikes
-		long localStep; //!< Local clock expressed in steps
-		std::vector<double> ringBuffer; //!< Buffer in which we stock the EPSP that the neuron received for a certain delay
+		std::unique_ptr<NeuronPopulation> owned; //!< Population owned by a standalone neuron, none for a view
+		NeuronPopulation* population; //!< Population in which the state of the neuron is stored
+		int id; //!< Id of the neuron in the population
+		std::vector<int> spiking; //!< Ids of the neurons that spiked during the last update
 		
-		/** updateState
+		/** hasSpiked
 		 * 
-		 * @param simStep 	the time given in steps
-		 * @brief manage the switch between the ACTIVE and REFRACTORY state
-		 *   	  if the neurons spikes, it will be REFRACTORY for a certain time
-		 *   	  given by refractoryTime
+		 * @return true if the neuron is in the spiking list of the last update
 		 */
-		void updateState(double simStep);
+		bool hasSpiked() const;
 };
 
 
@@ -11,46 +11,110 @@
 #include <array>
 #include <vector>
 #include <random>
+#include <cstdlib>
+#include <string>
+#include <algorithm>
+#include <stdexcept>
+#include <memory>
 #include "neuron.hpp"
 #include "network.hpp"
 
 
 using namespace std;
 
+// La précision par défaut du programme peut être choisie à la compilation (cmake -DNEURONS_PRECISION=float)
+#ifndef NEURONS_DEFAULT_PRECISION
+#define NEURONS_DEFAULT_PRECISION DOUBLE_PRECISION
+#endif
+
 /** progressPrinting
  * 
  * @note print a progress indicator on the terminal
  */
 void progressPrinting(double step); 
 
-int main()
+int main(int argc, char* argv[])
 {
 /// Initialisation -----------------------------------------------------
 	
 	cout << "** INITIALIZATION **" << endl;
+	cout << "integration kernel : " << kernelName(bestKernel()) << endl;
+	
+	Parameters parameters; //!< the values of constants.hpp, changed by --key=value or --config=file
+	parameters.precision = NEURONS_DEFAULT_PRECISION; //!< only the program takes the precision of the build, the neurons alone stay in double
+	try {
+		parameters.parse(argc, argv);
+	} catch(const invalid_argument& error){
+		cerr << error.what() << endl;
+		return 1;
+	}
+	if(parameters.randomSeed and parameters.restore.empty() and (parameters.ranks > 1 or parameters.transport == MESSAGE_PASSING)){
+		cerr << "the ranks must be given the same --seed" << endl;
+		return 1;
+	}
+	if(parameters.randomSeed) parameters.seed = random_device()(); //!< the same seed gives the same spikes, a restored network keeps the seed of its checkpoint
+	
+	unique_ptr<Network> network; //!< the network, restored from a checkpoint if asked
+	try {
+		network.reset(new Network(parameters.output, parameters));
+		parameters = network->getParameters(); //!< a restored network is the one of its checkpoint
+	} catch(const runtime_error& error){
+		cerr << error.what() << endl;
+		return 1;
+	}
 	
-	double simStep(0); //!< the step at wich the simulation is
+	double simStep(network->getStep()); //!< the step at wich the simulation is
+	double totalSteps(parameters.totalSteps()); //!< the number of steps of the simulation
+	double checkpointStep(parameters.checkpoint.empty() ? -1 : long(parameters.checkpointTime/parameters.h + 0.5)); //!< the step at which the state is saved
 	int progress(0); //!< indicate the progress of the simulation
 	int percent(0); //!< the progress at every step is recalculated and save in this variable
-	Network network("Neurons_Spikes.txt");
+	bool printing(network->getRank() == 0); //!< only the rank 0 prints the progress
+	cout << "threads : " << parameters.threads << endl;
+	cout << "precision : " << precisionName(parameters.precision) << endl;
+	cout << "connectivity : " << (parameters.connectivity == PROCEDURAL ? "procedural" : "stored") << endl;
+	if(parameters.connectivity == STORED){
+		cout << "connections : " << network->getConnectionBytes()/1048576.0 << " MB" << (parameters.compressTargets ? " (16 bits targets)" : "")
+			 << (network->isConnectionMapped() ? ", mapped from " + parameters.connectivityCache : "") << endl;
+	}
+	cout << "seed : " << parameters.seed << endl;
+	if(parameters.ranks > 1 or parameters.transport == MESSAGE_PASSING) cout << "rank : " << network->getRank() << endl;
+	if(not parameters.restore.empty()) cout << "restored at : " << simStep*parameters.h << " ms" << endl;
+	if(parameters.numa or parameters.hugePages) network->writePlacement(cout);
 	
 	
 /// Lancement de la simulation -----------------------------------------
 	
-	while(simStep <= total_steps) {
+	while(simStep < totalSteps) {
+		
+		// les threads ne se synchronisent qu'une fois par fenêtre, la fenêtre s'arrête au checkpoint
+		double next(min(simStep + network->getWindow(), totalSteps));
+		if(simStep < checkpointStep and next > checkpointStep) next = checkpointStep;
+		simStep = next;
 		
-		network.update(simStep);
+		try {
+			network->update(simStep);
+			if(simStep == checkpointStep) network->save(parameters.checkpoint);
+		} catch(const runtime_error& error){
+			cerr << error.what() << endl;
+			return 1;
+		}
 		
-		percent = simStep/total_steps*100;
+		percent = simStep/totalSteps*100;
 		
-		if(percent != progress){
+		if(printing and percent != progress){
 			progressPrinting(percent);
 			
 			progress = percent;
 		}
 		
-		simStep += 1;
-		
+	}
+	
+	try {
+		network->writeStatistics();
+		network->writeProfile();
+	} catch(const runtime_error& error){
+		cerr << error.what() << endl;
+		return 1;
 	}
 	
 	cout << endl;
@@ -0,0 +1,446 @@
+/**
+ * @file   neuronPopulation.cpp
+ * @author Jonathan Haab
+ * @date   Automn, 2017
+ * @brief  contains all the methods for the population of neurons
+ */
+
+#include "neuronPopulation.hpp"
+#include <algorithm>
+
+using namespace std;
+
+/** lambdas
+ * @return the mean of the external input of each instance of parameters
+ */
+static vector<double> lambdas(const Parameters& parameters)
+{
+	vector<Instance> batch(parameters.instances());
+	vector<double> result;
+
+	for(size_t k(0); k < batch.size(); ++k){
+		result.push_back(batch[k].lambda);
+	}
+	return result;
+}
+
+/** ringRows
+ *
+ * @param maxDelay 	the longest delay of an EPSP in steps
+ * @return the number of rows of the ringBuffer : the power of two after maxDelay, so
+ * 		   that the EPSP of every delay find their row with a mask
+ */
+static long ringRows(int maxDelay)
+{
+	long rows(1);
+	while(rows < long(maxDelay) + 1) rows *= 2;
+	return rows;
+}
+
+/** Constructor
+ *
+ * @param size 			the total number of neurons of the population
+ * @param excitatorySize 	the number of excitatory neurons, they
+ * 						take the ids [0, excitatorySize), the
+ * 						others are inhibitory
+ * @param seed 			the key of the generator of the external input
+ * @param parameters 		the parameters of the model, each neuron has
+ * 						the state of every instance of parameters.instances()
+ * @param offset 			the id in the network of the first neuron, the
+ * 						neuron id gets the external input of offset+id
+ *
+ * @note every neuron starts at v_res and at step 0
+ */
+NeuronPopulation::NeuronPopulation(int size, int excitatorySize, uint64_t seed, const Parameters& parameters, int offset)
+	: n(size), instances(parameters.instances().size()), states(size*instances), offset(offset), localStep(0),
+	  v(parameters.precision, states), J(states, parameters.J_e), type(size, EXCITATORY),
+	  refractory(realPrecision(parameters.precision), states), raster(states, long(parameters.rasterRetention/parameters.h + 0.5), long(parameters.refractorySteps)),
+	  model{parameters.c1(), parameters.v_th, parameters.v_res, parameters.refractorySteps},
+	  c2(parameters.c2()), bufferDelay(parameters.bufferDelay), ringLength(ringRows(parameters.maxDelay())), ringMask(ringLength - 1),
+	  ringBuffer(parameters.precision, ringLength*states),
+	  drive(realPrecision(parameters.precision), states), spikeBuffer(states), kernel(bestKernel()),
+	  external(seed, lambdas(parameters), parameters.J_e)
+{
+	vector<Instance> batch(parameters.instances());
+
+	v.fill(parameters.v_res);
+	refractory.fill(0.0);
+	ringBuffer.fill(0.0);
+	drive.fill(0.0);
+
+	for(int i(excitatorySize); i < n; ++i){
+		type[i] = INHIBITORY;
+		for(int k(0); k < instances; ++k){
+			J[i*instances + k] = batch[k].J_i;
+		}
+	}
+	setPartitions(1);
+}
+
+/** update
+ *
+ * @param simStep 	the step up to which the population is integrated
+ * @param spiking 	filled with the ids of the neurons that spiked,
+ * 					in increasing order for each step
+ * @note draws the external input from a poisson distribution
+ * @note with several instances, the ids are those of the states,
+ * 		 id*getInstances() + instance
+ */
+void NeuronPopulation::update(long simStep, vector<int>& spiking)
+{
+	while(localStep < simStep){
+
+		for(size_t p(0); p < partitions.size(); ++p){
+			integratePartition(p, localStep, spiking);
+		}
+		localStep += 1;
+	}
+}
+
+/** updateTest
+ *
+ * @note	 only used for unittest, the external input is a constant current
+ * @param iExt 	the current given to every neuron
+ * @param simStep 	the step up to which the population is integrated
+ * @param spiking 	filled with the ids of the neurons that spiked
+ */
+void NeuronPopulation::updateTest(double iExt, long simStep, vector<int>& spiking)
+{
+	drive.fill(c2*iExt);
+
+	while(localStep < simStep){
+
+		size_t first(spiking.size());
+		integrateRange(0, n, localStep, spiking);
+
+		// Les ids sont croissants : chaque partition garde les siens dans son log
+		for(size_t p(0); p < partitions.size(); ++p){
+			size_t last(lower_bound(spiking.begin() + first, spiking.end(), partitions[p].end*instances) - spiking.begin());
+			raster.append(p, localStep, spiking.data() + first, last - first);
+			first = last;
+		}
+		localStep += 1;
+	}
+}
+
+/** receive
+ *
+ * @param id 	the neuron that receives the EPSP
+ * @param step 	the step at which the neuron receive the EPSP
+ * @param J 	the amplitude of the EPSP that is received
+ * @note used by the Neuron view, the ringBuffer cell is the one of Neuron::receive,
+ * 		 only the first instance receives it
+ */
+void NeuronPopulation::receive(int id, long step, double J)
+{
+	ringBuffer.add(((step+bufferDelay)%bufferDelay)*states + id*instances, J);
+}
+
+/** deliver
+ *
+ * @param id 			the neuron that receives the EPSP
+ * @param spikeStep 	the step at which the presynaptic neuron spiked
+ * @param J 			the amplitude of the EPSP that is received
+ * @param instance 	the instance that receives it
+ * @note the EPSP is added to the input of the step spikeStep+bufferDelay,
+ * 		 so it must be delivered before this step is integrated
+ */
+void NeuronPopulation::deliver(int id, long spikeStep, double J, int instance)
+{
+	ringBuffer.add(((spikeStep+bufferDelay) & ringMask)*states + id*instances + instance, J);
+}
+
+/** setPartitions
+ *
+ * @param count 	the number of contiguous ranges of neurons that can be
+ * 					integrated independently
+ * @note the external input does not depend on the partitions
+ */
+void NeuronPopulation::setPartitions(int count)
+{
+	partitions.clear();
+	raster.setLogs(count);
+
+	for(int p(0); p < count; ++p){
+
+		// Les bornes sont alignées sur 8 doubles (une ligne de cache) pour que deux threads n'écrivent jamais dans la même ligne
+		Partition partition = {int(long(n)*p/count) & ~7, p + 1 == count ? n : int(long(n)*(p+1)/count) & ~7};
+		partitions.push_back(partition);
+	}
+}
+
+/** integratePartition
+ *
+ * @param p 		the partition
+ * @param step 	the step that is integrated, the clock is not moved
+ * @param spiking 	filled with the ids of the neurons of p that spiked
+ * @note different partitions can be integrated at the same time
+ */
+void NeuronPopulation::integratePartition(int p, long step, vector<int>& spiking)
+{
+	const Partition& partition(partitions[p]);
+	size_t first(spiking.size());
+
+	fillDrive(partition.begin, partition.end, step);
+	integrateRange(partition.begin, partition.end, step, spiking);
+
+	raster.append(p, step, spiking.data() + first, spiking.size() - first);
+}
+
+/** integratePartition
+ *
+ * @param p 		the partition
+ * @param from 		the first step that is integrated, the clock is not moved
+ * @param to 		the step after the last one, at most from+minDelay()
+ * @param stepSpikes 	for each step, filled with the ids of the neurons of p that spiked
+ * @note integrates every step of a block of neurons before the next block,
+ * 		 the state of a block stays in cache during the window. The inputs
+ * 		 of the window must already be in the ringBuffer.
+ */
+void NeuronPopulation::integratePartition(int p, long from, long to, vector<vector<int>>& stepSpikes)
+{
+	const Partition& partition(partitions[p]);
+	stepSpikes.resize(to - from);
+
+	// Les blocs sont parcourus dans l'ordre : les ids de chaque step restent croissants
+	int block(max(blockSize/instances, 8));
+
+	for(int first(partition.begin); first < partition.end; first += block){
+
+		int last(min(first + block, partition.end));
+
+		for(long step(from); step < to; ++step){
+			fillDrive(first, last, step);
+			integrateRange(first, last, step, stepSpikes[step - from]);
+		}
+	}
+
+	for(long step(from); step < to; ++step){
+		raster.append(p, step, stepSpikes[step - from].data(), stepSpikes[step - from].size());
+	}
+}
+
+/** fillDrive
+ *
+ * @param begin 	the first neuron
+ * @param end 		the neuron after the last one
+ * @param step 	the step of the external input written in drive
+ */
+void NeuronPopulation::fillDrive(int begin, int end, long step)
+{
+	if(drive.getPrecision() == SINGLE_PRECISION){
+		external.fill(step, offset + begin, offset + end, drive.data<float>() + size_t(begin)*instances);
+	} else {
+		external.fill(step, offset + begin, offset + end, drive.data<double>() + size_t(begin)*instances);
+	}
+}
+
+/** integrateRange
+ *
+ * @param begin 	the first neuron
+ * @param end 		the neuron after the last one
+ * @param step 	the step that is integrated with the current drive
+ * @param spiking 	filled with the states of the neurons that spiked
+ */
+void NeuronPopulation::integrateRange(int begin, int end, long step, vector<int>& spiking)
+{
+	switch(v.getPrecision()){
+		case SINGLE_PRECISION : integrateCells<float>(begin, end, step, spiking); break;
+		case FIXED_POINT : integrateCells<int32_t>(begin, end, step, spiking); break;
+		default : integrateCells<double>(begin, end, step, spiking);
+	}
+}
+
+/** integrateCells
+ *
+ * @note integrateRange for the potentials and the inputs kept in Cell
+ */
+template<typename Cell>
+void NeuronPopulation::integrateCells(int begin, int end, long step, vector<int>& spiking)
+{
+	// Une ligne du ringBuffer contient l'input de tous les neurones pour ce step, les instances
+	// d'un neurone se suivent : le kernel les intègre dans les mêmes registres
+	typedef typename CellTraits<Cell>::Real Real;
+
+	int first(begin*instances);
+	BasicIntegrationArgs<Cell> args = {(end - begin)*instances, v.data<Cell>() + first, refractory.data<Real>() + first,
+									   inputRow<Cell>(step) + first, drive.data<Real>() + first, &spikeBuffer[first], model};
+
+	int count(integrate(kernel, args));
+
+	for(int k(0); k < count; ++k){
+		spiking.push_back(first + spikeBuffer[first + k]);
+	}
+}
+
+/** setStep
+ *
+ * @param step 	the new local clock, after the partitions were integrated up to it
+ */
+void NeuronPopulation::setStep(long step)
+{
+	localStep = step;
+}
+
+/** place
+ *
+ * @param workers 		the threads, the thread t integrates the partition t
+ * @param hugePages 	true to advise huge pages for the large arrays
+ * @note copies the state of each partition to new arrays from its own thread : the
+ * 		 pages of a partition are then on the NUMA node of the thread that integrates it
+ */
+void NeuronPopulation::place(WorkerPool& workers, bool hugePages)
+{
+	// Les nouveaux tableaux ne sont pas écrits : chaque page ira au nœud du premier thread qui l'écrit
+	PlacedAllocator<double> allocator(hugePages);
+	PlacedVector<double> placedJ(allocator);
+	PlacedVector<int> placedSpikes(allocator);
+	CellArray placedV(v.getPrecision(), states, hugePages), placedRing(ringBuffer.getPrecision(), ringBuffer.size(), hugePages);
+	CellArray placedRefractory(refractory.getPrecision(), states, hugePages), placedDrive(drive.getPrecision(), states, hugePages);
+
+	placedJ.resize(states);
+	placedSpikes.resize(states);
+
+	workers.run([&](int t){
+
+		for(int p(t); p < int(partitions.size()); p += workers.size()){
+
+			size_t first(size_t(partitions[p].begin)*instances), last(size_t(partitions[p].end)*instances);
+
+			placedV.copy(v, first, last);
+			copy(J.begin() + first, J.begin() + last, placedJ.begin() + first);
+			placedRefractory.copy(refractory, first, last);
+			placedDrive.copy(drive, first, last);
+			copy(spikeBuffer.begin() + first, spikeBuffer.begin() + last, placedSpikes.begin() + first);
+
+			// Chaque ligne du ringBuffer contient la partition à la même place
+			for(long r(0); r < ringLength; ++r){
+				placedRing.copy(ringBuffer, r*states + first, r*states + last);
+			}
+		}
+	});
+
+	v.swap(placedV);
+	J.swap(placedJ);
+	refractory.swap(placedRefractory);
+	ringBuffer.swap(placedRing);
+	drive.swap(placedDrive);
+	spikeBuffer.swap(placedSpikes);
+}
+
+/** partitionBegin
+ * @return the first neuron of the partition p
+ */
+int NeuronPopulation::partitionBegin(int p) const
+{
+	return partitions[p].begin;
+}
+
+/** partitionEnd
+ * @return the neuron after the last one of the partition p
+ */
+int NeuronPopulation::partitionEnd(int p) const
+{
+	return partitions[p].end;
+}
+
+/** setKernel
+ *
+ * @param kernel 	the instruction set used to integrate, the best one
+ * 					supported by the cpu is chosen by default
+ */
+void NeuronPopulation::setKernel(KernelType kernel)
+{
+	this->kernel = kernel;
+}
+
+/** size
+ * @return the number of neurons of the population
+ */
+int NeuronPopulation::size() const
+{
+	return n;
+}
+
+/** getInstances
+ * @return the number of instances of the parameters simulated at once
+ */
+int NeuronPopulation::getInstances() const
+{
+	return instances;
+}
+
+/** getStep
+ * @return the local clock of the population expressed in steps
+ */
+long NeuronPopulation::getStep() const
+{
+	return localStep;
+}
+
+/** getV
+ * @return the membrane potential of the neuron id in the instance
+ */
+double NeuronPopulation::getV(int id, int instance) const
+{
+	return v.get(id*instances + instance);
+}
+
+/** getJ
+ * @return the amplitude of the EPSP of the neuron id in the instance
+ */
+double NeuronPopulation::getJ(int id, int instance) const
+{
+	return J[id*instances + instance];
+}
+
+/** getType
+ * @return the type of the neuron id
+ */
+Type NeuronPopulation::getType(int id) const
+{
+	return type[id];
+}
+
+/** save
+ *
+ * @param out 	receives the potentials, the refractory countdowns and the ringBuffer
+ * @note the external input is a function of the seed and of the step, it has no state
+ */
+void NeuronPopulation::save(CheckpointWriter& out) const
+{
+	v.save(out, "v");
+	refractory.save(out, "refractory");
+	ringBuffer.save(out, "ringBuffer");
+}
+
+/** restore
+ *
+ * @param in 	a checkpoint written by save
+ * @throw std::runtime_error if the checkpoint is not one of a population of this size and delay
+ * @note the clock is set to the step of the checkpoint, the spikes before it are not kept
+ * @note a checkpoint of another precision is converted to the precision of the population
+ */
+void NeuronPopulation::restore(const CheckpointReader& in)
+{
+	v.restore(in, "v");
+	refractory.restore(in, "refractory");
+	ringBuffer.restore(in, "ringBuffer");
+	localStep = in.getStep();
+}
+
+/** getPrecision
+ * @return the type of the potentials and of the inputs
+ */
+Precision NeuronPopulation::getPrecision() const
+{
+	return v.getPrecision();
+}
+
+/** getSpikesTime
+ * @return the steps at which the neuron id spiked in the instance
+ */
+SpikeTimes NeuronPopulation::getSpikesTime(int id, int instance) const
+{
+	return raster.spikesOf(id*instances + instance);
+}
@@ -0,0 +1,300 @@
+/**
+ * @file   neuronPopulation.hpp
+ * @author Jonathan Haab
+ * @date   Automn, 2017
+ * @brief  structure of arrays holding the state of a whole population of neurons
+ */
+
+#include <vector>
+#include <cstdint>
+#include "constants.hpp"
+#include "parameters.hpp"
+#include "integrationKernel.hpp"
+#include "poissonDrive.hpp"
+#include "spikeRaster.hpp"
+#include "checkpoint.hpp"
+#include "topology.hpp"
+#include "workerPool.hpp"
+#include "precision.hpp"
+
+#ifndef NEURONPOPULATION_H
+#define NEURONPOPULATION_H
+
+/// State of the neuron : Active or Refractory
+enum State {ACTIVE, REFRACTORY, stateSize};
+/// Type of the neuron : Excitatory or Inhibitory
+enum Type {INHIBITORY, EXCITATORY, typeSize};
+
+class NeuronPopulation
+{
+	public :
+
+		/** Constructor
+		 *
+		 * @param size 			the total number of neurons of the population
+		 * @param excitatorySize 	the number of excitatory neurons, they
+		 * 						take the ids [0, excitatorySize), the
+		 * 						others are inhibitory
+		 * @param seed 			the key of the generator of the external input
+		 * @param parameters 		the parameters of the model, each neuron has
+		 * 						the state of every instance of parameters.instances()
+		 * @param offset 			the id in the network of the first neuron, the
+		 * 						neuron id gets the external input of offset+id
+		 *
+		 * @note every neuron starts at v_res and at step 0
+		 */
+		NeuronPopulation(int size, int excitatorySize, uint64_t seed, const Parameters& parameters = Parameters(), int offset = 0);
+
+		/** update
+		 *
+		 * @param simStep 	the step up to which the population is integrated
+		 * @param spiking 	filled with the ids of the neurons that spiked,
+		 * 					in increasing order for each step
+		 * @note draws the external input from a poisson distribution
+		 * @note with several instances, the ids are those of the states,
+		 * 		 id*getInstances() + instance
+		 */
+		void update(long simStep, std::vector<int>& spiking);
+
+		/** updateTest
+		 *
+		 * @note	 only used for unittest, the external input is a constant current
+		 * @param iExt 	the current given to every neuron
+		 * @param simStep 	the step up to which the population is integrated
+		 * @param spiking 	filled with the ids of the neurons that spiked
+		 */
+		void updateTest(double iExt, long simStep, std::vector<int>& spiking);
+
+		/** receive
+		 *
+		 * @param id 	the neuron that receives the EPSP
+		 * @param step 	the step at which the neuron receive the EPSP
+		 * @param J 	the amplitude of the EPSP that is received
+		 * @note used by the Neuron view, the ringBuffer cell is the one of Neuron::receive,
+		 * 		 only the first instance receives it
+		 */
+		void receive(int id, long step, double J);
+
+		/** deliver
+		 *
+		 * @param id 			the neuron that receives the EPSP
+		 * @param spikeStep 	the step at which the presynaptic neuron spiked
+		 * @param J 			the amplitude of the EPSP that is received
+		 * @param instance 	the instance that receives it
+		 * @note the EPSP is added to the input of the step spikeStep+bufferDelay,
+		 * 		 so it must be delivered before this step is integrated
+		 */
+		void deliver(int id, long spikeStep, double J, int instance = 0);
+
+		/** inputRow
+		 *
+		 * @param step 	a step that is not integrated yet
+		 * @return the row of the ringBuffer read at this step, the inputs of the
+		 * 		   instances of a neuron are contiguous : id*getInstances() + instance
+		 * @note the ringBuffer has a power of two length : the row is found with a mask
+		 * @note Cell must be the type of the precision of the population
+		 */
+		template<typename Cell = double>
+		Cell* inputRow(long step)
+		{
+			return ringBuffer.data<Cell>() + (step & ringMask)*states;
+		}
+
+		/** inputCells
+		 *
+		 * @param step 	a step that is not integrated yet
+		 * @return the row of inputRow, whatever the type of its cells
+		 */
+		void* inputCells(long step)
+		{
+			return ringBuffer.cell((step & ringMask)*states);
+		}
+
+		/** getPrecision
+		 * @return the type of the potentials and of the inputs
+		 */
+		Precision getPrecision() const;
+
+		/** setPartitions
+		 *
+		 * @param count 	the number of contiguous ranges of neurons that can be
+		 * 					integrated independently
+		 * @note the external input does not depend on the partitions
+		 */
+		void setPartitions(int count);
+
+		/** integratePartition
+		 *
+		 * @param p 		the partition
+		 * @param step 	the step that is integrated, the clock is not moved
+		 * @param spiking 	filled with the ids of the neurons of p that spiked
+		 * @note different partitions can be integrated at the same time
+		 */
+		void integratePartition(int p, long step, std::vector<int>& spiking);
+
+		/** integratePartition
+		 *
+		 * @param p 		the partition
+		 * @param from 		the first step that is integrated, the clock is not moved
+		 * @param to 		the step after the last one, at most from+minDelay()
+		 * @param stepSpikes 	for each step, filled with the ids of the neurons of p that spiked
+		 * @note integrates every step of a block of neurons before the next block,
+		 * 		 the state of a block stays in cache during the window. The inputs
+		 * 		 of the window must already be in the ringBuffer.
+		 */
+		void integratePartition(int p, long from, long to, std::vector<std::vector<int>>& stepSpikes);
+
+		/** setStep
+		 *
+		 * @param step 	the new local clock, after the partitions were integrated up to it
+		 */
+		void setStep(long step);
+
+		/** place
+		 *
+		 * @param workers 		the threads, the thread t integrates the partition t
+		 * @param hugePages 	true to advise huge pages for the large arrays
+		 * @note copies the state of each partition to new arrays from its own thread : the
+		 * 		 pages of a partition are then on the NUMA node of the thread that integrates it
+		 */
+		void place(WorkerPool& workers, bool hugePages);
+
+		/** partitionBegin
+		 * @return the first neuron of the partition p
+		 */
+		int partitionBegin(int p) const;
+
+		/** partitionEnd
+		 * @return the neuron after the last one of the partition p
+		 */
+		int partitionEnd(int p) const;
+
+		/** setKernel
+		 *
+		 * @param kernel 	the instruction set used to integrate, the best one
+		 * 					supported by the cpu is chosen by default
+		 */
+		void setKernel(KernelType kernel);
+
+		/** size
+		 * @return the number of neurons of the population
+		 */
+		int size() const;
+
+		/** getInstances
+		 * @return the number of instances of the parameters simulated at once
+		 */
+		int getInstances() const;
+
+		/** getStep
+		 * @return the local clock of the population expressed in steps
+		 */
+		long getStep() const;
+
+		/** getV
+		 * @return the membrane potential of the neuron id in the instance
+		 */
+		double getV(int id, int instance = 0) const;
+
+		/** getJ
+		 * @return the amplitude of the EPSP of the neuron id in the instance
+		 */
+		double getJ(int id, int instance = 0) const;
+
+		/** getType
+		 * @return the type of the neuron id
+		 */
+		Type getType(int id) const;
+
+		/** save
+		 *
+		 * @param out 	receives the potentials, the refractory countdowns and the ringBuffer
+		 * @note the external input is a function of the seed and of the step, it has no state
+		 */
+		void save(CheckpointWriter& out) const;
+
+		/** restore
+		 *
+		 * @param in 	a checkpoint written by save
+		 * @throw std::runtime_error if the checkpoint is not one of a population of this size and delay
+		 * @note the clock is set to the step of the checkpoint, the spikes before it are not kept
+		 * @note a checkpoint of another precision is converted to the precision of the population
+		 */
+		void restore(const CheckpointReader& in);
+
+		/** getSpikesTime
+		 * @return the steps at which the neuron id spiked in the instance, kept
+		 * 		   by the raster until the next step is integrated
+		 */
+		SpikeTimes getSpikesTime(int id, int instance = 0) const;
+
+	private :
+
+		int n; //!< Number of neurons
+		int instances; //!< Number of instances, the states of a neuron are contiguous so that the kernel integrates them together
+		int states; //!< Number of states, n*instances
+		int offset; //!< Id in the network of the first neuron
+		long localStep; //!< Local clock shared by every neuron, expressed in steps
+
+		CellArray v; //!< Membrane potentials, the state id*instances + k is the neuron id in the instance k
+		PlacedVector<double> J; //!< Amplitudes of the EPSP
+		std::vector<Type> type; //!< Types of the neurons
+		CellArray refractory; //!< Refractory countdown in steps, kept in the type of the kernel (CellTraits::Real) so that the refractory test is vectorized with v
+		SpikeRaster raster; //!< Steps at which the neurons spiked, one log per partition
+
+		MembraneConstants model; //!< Parameters of the membrane given to the kernel
+		double c2; //!< Factor of the current in updateTest
+		int bufferDelay; //!< Delay of the EPSP in steps
+		long ringLength; //!< Number of rows of the ringBuffer, the power of two after the longest delay
+		long ringMask; //!< ringLength-1
+
+		/// Delays the EPSP : row r (of states values) holds the input read at the steps equal to r modulo ringLength
+		CellArray ringBuffer;
+
+		CellArray drive; //!< External input of the step that is integrated, in the type of the kernel
+		PlacedVector<int> spikeBuffer; //!< Ids of the neurons that spiked, written by the kernel
+		KernelType kernel; //!< Instruction set of the integration kernel
+
+		/** Partition
+		 *  contiguous range of neurons
+		 */
+		struct Partition
+		{
+			int begin; //!< First neuron
+			int end; //!< Neuron after the last one
+		};
+
+		/// Generator of the external input, one counter-based stream per neuron shared by the instances : only lambda differs between them
+		PoissonDrive external;
+
+		std::vector<Partition> partitions; //!< Ranges of neurons integrated independently
+
+		/// Number of states integrated for a whole window before the next ones : v, refractory and drive stay in L1
+		static const int blockSize = 1024;
+
+		/** fillDrive
+		 *
+		 * @param begin 	the first neuron
+		 * @param end 		the neuron after the last one
+		 * @param step 	the step of the external input written in drive
+		 */
+		void fillDrive(int begin, int end, long step);
+
+		/** integrateRange
+		 *
+		 * @param begin 	the first neuron
+		 * @param end 		the neuron after the last one
+		 * @param step 	the step that is integrated with the current drive
+		 * @param spiking 	filled with the states of the neurons that spiked
+		 */
+		void integrateRange(int begin, int end, long step, std::vector<int>& spiking);
+
+		/** integrateCells
+		 *
+		 * @note integrateRange for the potentials and the inputs kept in Cell
+		 */
+		template<typename Cell>
+		void integrateCells(int begin, int end, long step, std::vector<int>& spiking);
+};
+
+#endif
@@ -0,0 +1,356 @@
+/**
+ * @file   parameters.cpp
+ * @author Jonathan Haab
+ * @date   Automn, 2017
+ * @brief  contains all the methods of the parameters of a simulation
+ */
+
+#include "parameters.hpp"
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <cmath>
+#include <algorithm>
+
+using namespace std;
+
+/** read
+ *
+ * @param key 		the name of the parameter, for the error message
+ * @param value 	the text to convert
+ * @param field 	receives the value
+ * @throw std::invalid_argument if value is not entirely a T
+ */
+template<typename T>
+static void read(const string& key, const string& value, T& field)
+{
+	istringstream in(value);
+	T result;
+
+	if(not (in >> result) or not (in >> ws).eof()){
+		throw invalid_argument("invalid value '" + value + "' for " + key);
+	}
+	field = result;
+}
+
+/** N_e
+ * @return the number of excitatory neurons
+ */
+int Parameters::N_e() const
+{
+	return int(excitatoryRatio*N + 0.5);
+}
+
+/** N_i
+ * @return the number of inhibitory neurons
+ */
+int Parameters::N_i() const
+{
+	return N - N_e();
+}
+
+/** C_e
+ * @return the number of connections with excitatory neurons
+ */
+int Parameters::C_e() const
+{
+	return int(connectionRatio*N_e() + 0.5);
+}
+
+/** C_i
+ * @return the number of connections with inhibitory neurons
+ */
+int Parameters::C_i() const
+{
+	return int(connectionRatio*N_i() + 0.5);
+}
+
+/** c1
+ * @return the factor of the potential in the update of the membrane
+ */
+double Parameters::c1() const
+{
+	return exp(-h/tau);
+}
+
+/** c2
+ * @return the factor of the current in the update of the membrane
+ */
+double Parameters::c2() const
+{
+	return tau/c*(1-exp(-h/tau));
+}
+
+/** projectionDelay
+ *
+ * @param excitatory 	true for the synapses of an excitatory neuron, false for an inhibitory one
+ * @return the delay in steps of the synapses of the projection, before their own spread
+ */
+int Parameters::projectionDelay(bool excitatory) const
+{
+	return excitatory or inhibitoryDelay == 0 ? bufferDelay : inhibitoryDelay;
+}
+
+/** minDelay
+ * @return the shortest delay of a synapse : the steps that can be integrated without any delivery
+ */
+int Parameters::minDelay() const
+{
+	return min(projectionDelay(true), projectionDelay(false));
+}
+
+/** maxDelay
+ * @return the longest delay of a synapse : the steps that the ring buffers must hold
+ */
+int Parameters::maxDelay() const
+{
+	return max(projectionDelay(true), projectionDelay(false)) + delaySpread;
+}
+
+/** totalSteps
+ * @return the number of steps of the simulation
+ */
+long Parameters::totalSteps() const
+{
+	return long(abs(stopTime-startTime)/h + 0.5);
+}
+
+/** instances
+ * @return the instances of the batch, a single one of J_i and lambda if batch is empty
+ * @throw std::invalid_argument if batch is not a list of g:eta
+ */
+vector<Instance> Parameters::instances() const
+{
+	if(batch.empty()){
+		Instance single = {J_i, lambda};
+		return vector<Instance>(1, single);
+	}
+
+	// eta = 1 est l'input externe qui amène seul un neurone à v_th : nu_thr*C_e*h = v_th*h/(J_e*tau) spikes par step
+	double threshold(v_th*h/(J_e*tau));
+	vector<Instance> result;
+	istringstream in(batch);
+	string pair;
+
+	while(getline(in, pair, ',')){
+
+		size_t colon(pair.find(':'));
+		double g, eta;
+
+		if(colon == string::npos) throw invalid_argument("invalid instance '" + pair + "' in batch, expected g:eta");
+		read("batch", pair.substr(0, colon), g);
+		read("batch", pair.substr(colon + 1), eta);
+		if(eta < 0) throw invalid_argument("eta must not be negative in batch");
+
+		Instance instance = {-g*J_e, eta*threshold};
+		result.push_back(instance);
+	}
+	if(result.empty()) throw invalid_argument("batch must contain at least one g:eta");
+	return result;
+}
+
+/** set
+ *
+ * @param key 		the name of a parameter, like the fields above
+ * @param value 	its new value
+ * @throw std::invalid_argument if the key is unknown or the value is not valid
+ */
+void Parameters::set(const string& key, const string& value)
+{
+	if(key == "h") read(key, value, h);
+	else if(key == "startTime") read(key, value, startTime);
+	else if(key == "stopTime") read(key, value, stopTime);
+	else if(key == "plotStartTime") read(key, value, plotStartTime);
+	else if(key == "plotStopTime") read(key, value, plotStopTime);
+	else if(key == "tau") read(key, value, tau);
+	else if(key == "refractorySteps") read(key, value, refractorySteps);
+	else if(key == "lambda") read(key, value, lambda);
+	else if(key == "v_th") read(key, value, v_th);
+	else if(key == "v_res") read(key, value, v_res);
+	else if(key == "N") read(key, value, N);
+	else if(key == "excitatoryRatio") read(key, value, excitatoryRatio);
+	else if(key == "connectionRatio") read(key, value, connectionRatio);
+	else if(key == "J_e") read(key, value, J_e);
+	else if(key == "J_i") read(key, value, J_i);
+	else if(key == "c") read(key, value, c);
+	else if(key == "bufferDelay") read(key, value, bufferDelay);
+	else if(key == "inhibitoryDelay") read(key, value, inhibitoryDelay);
+	else if(key == "delaySpread") read(key, value, delaySpread);
+	else if(key == "batch") batch = value;
+	else if(key == "rasterRetention") read(key, value, rasterRetention);
+	else if(key == "threads") read(key, value, threads);
+	else if(key == "timeBlocked") read(key, value, timeBlocked);
+	else if(key == "numa") read(key, value, numa);
+	else if(key == "hugePages") read(key, value, hugePages);
+	else if(key == "compressTargets") read(key, value, compressTargets);
+	else if(key == "connectivityCache") connectivityCache = value;
+	else if(key == "writerMemory") read(key, value, writerMemory);
+	else if(key == "output") output = value;
+	else if(key == "checkpoint") checkpoint = value;
+	else if(key == "checkpointTime") read(key, value, checkpointTime);
+	else if(key == "restore") restore = value;
+	else if(key == "profile") profile = value;
+	else if(key == "profileTrace") profileTrace = value;
+	else if(key == "statistics") statistics = value;
+	else if(key == "statisticsBin") read(key, value, statisticsBin);
+	else if(key == "fanoWindow") read(key, value, fanoWindow);
+	else if(key == "ranks") read(key, value, ranks);
+	else if(key == "rank") read(key, value, rank);
+	else if(key == "socket") socket = value;
+	else if(key == "seed"){
+		read(key, value, seed);
+		randomSeed = false;
+	} else if(key == "connectivity"){
+		if(value == "stored") connectivity = STORED;
+		else if(value == "procedural") connectivity = PROCEDURAL;
+		else throw invalid_argument("connectivity must be stored or procedural, not '" + value + "'");
+	} else if(key == "transport"){
+		if(value == "socket") transport = SOCKETS;
+		else if(value == "mpi") transport = MESSAGE_PASSING;
+		else throw invalid_argument("transport must be socket or mpi, not '" + value + "'");
+	} else if(key == "precision"){
+		if(value == "double") precision = DOUBLE_PRECISION;
+		else if(value == "float") precision = SINGLE_PRECISION;
+		else if(value == "fixed") precision = FIXED_POINT;
+		else throw invalid_argument("precision must be double, float or fixed, not '" + value + "'");
+	} else if(key == "format"){
+		if(value == "text") format = TEXT;
+		else if(value == "binary") format = BINARY;
+		else if(value == "none") format = NO_SPIKE_FILE;
+		else if(value == "indexed") format = INDEXED;
+		else throw invalid_argument("format must be text, binary, indexed or none, not '" + value + "'");
+	} else {
+		throw invalid_argument("unknown parameter '" + key + "'");
+	}
+
+	if(h <= 0 or tau <= 0 or c <= 0) throw invalid_argument("h, tau and c must be positive");
+	if(N < 1 or threads < 1 or bufferDelay < 1) throw invalid_argument("N, threads and bufferDelay must be at least 1");
+	if(inhibitoryDelay < 0 or delaySpread < 0 or delaySpread > 255) throw invalid_argument("inhibitoryDelay must not be negative and delaySpread must be in [0, 255]");
+	if(rasterRetention < 0) throw invalid_argument("rasterRetention must not be negative");
+	if(writerMemory < 0) throw invalid_argument("writerMemory must not be negative");
+	if(statisticsBin <= 0 or fanoWindow <= 0) throw invalid_argument("statisticsBin and fanoWindow must be positive");
+	if(ranks < 1 or rank < 0) throw invalid_argument("ranks must be at least 1 and rank not negative");
+	if(key == "batch") instances();
+}
+
+/** load
+ *
+ * @param file 	a file of "key = value" lines, '#' starts a comment
+ * @throw std::invalid_argument if the file cannot be read or a line is not valid
+ */
+void Parameters::load(const string& file)
+{
+	ifstream in(file);
+	if(not in) throw invalid_argument("cannot read the parameters file '" + file + "'");
+
+	load(in, file);
+}
+
+/** load
+ *
+ * @param in 		"key = value" lines, like a file given to load
+ * @param source 	where the lines come from, for the error messages
+ * @throw std::invalid_argument if a line is not valid
+ */
+void Parameters::load(istream& in, const string& source)
+{
+	string line;
+	while(getline(in, line)){
+
+		line = line.substr(0, line.find('#'));
+		size_t equal(line.find('='));
+
+		string key, value;
+		istringstream(line.substr(0, equal)) >> key;
+		if(key.empty()) continue;
+		if(equal == string::npos) throw invalid_argument("missing '=' after " + key + " in " + source);
+
+		istringstream(line.substr(equal + 1)) >> value;
+		set(key, value);
+	}
+}
+
+/** parse
+ *
+ * @param argc 	the number of arguments of main
+ * @param argv 	the arguments : --key=value, --key value or --config=file,
+ * 				read in order so that the last one wins
+ * @throw std::invalid_argument if an argument is not valid
+ */
+void Parameters::parse(int argc, char* argv[])
+{
+	for(int i(1); i < argc; ++i){
+
+		string argument(argv[i]);
+		if(argument.compare(0, 2, "--") != 0) throw invalid_argument("unexpected argument '" + argument + "'");
+
+		size_t equal(argument.find('='));
+		string key(argument.substr(2, equal == string::npos ? string::npos : equal - 2));
+		string value;
+
+		if(equal != string::npos){
+			value = argument.substr(equal + 1);
+		} else if(i + 1 < argc){
+			value = argv[++i];
+		} else {
+			throw invalid_argument("missing value for --" + key);
+		}
+
+		if(key == "config") load(value);
+		else set(key, value);
+	}
+}
+
+/** write
+ *
+ * @param out 	receives every parameter as a "key = value" line, a file that load can read
+ */
+void Parameters::write(ostream& out) const
+{
+	out.precision(17);
+	out << "h = " << h << "\n"
+		<< "startTime = " << startTime << "\n"
+		<< "stopTime = " << stopTime << "\n"
+		<< "plotStartTime = " << plotStartTime << "\n"
+		<< "plotStopTime = " << plotStopTime << "\n"
+		<< "tau = " << tau << "\n"
+		<< "refractorySteps = " << refractorySteps << "\n"
+		<< "lambda = " << lambda << "\n"
+		<< "v_th = " << v_th << "\n"
+		<< "v_res = " << v_res << "\n"
+		<< "N = " << N << "\n"
+		<< "excitatoryRatio = " << excitatoryRatio << "\n"
+		<< "connectionRatio = " << connectionRatio << "\n"
+		<< "J_e = " << J_e << "\n"
+		<< "J_i = " << J_i << "\n"
+		<< "c = " << c << "\n"
+		<< "bufferDelay = " << bufferDelay << "\n"
+		<< "inhibitoryDelay = " << inhibitoryDelay << "\n"
+		<< "delaySpread = " << delaySpread << "\n"
+		<< "batch = " << batch << "\n"
+		<< "rasterRetention = " << rasterRetention << "\n"
+		<< "threads = " << threads << "\n"
+		<< "precision = " << (precision == SINGLE_PRECISION ? "float" : precision == FIXED_POINT ? "fixed" : "double") << "\n"
+		<< "timeBlocked = " << timeBlocked << "\n"
+		<< "numa = " << numa << "\n"
+		<< "hugePages = " << hugePages << "\n"
+		<< "connectivity = " << (connectivity == PROCEDURAL ? "procedural" : "stored") << "\n"
+		<< "compressTargets = " << compressTargets << "\n"
+		<< "connectivityCache = " << connectivityCache << "\n"
+		<< "seed = " << seed << "\n"
+		<< "output = " << output << "\n"
+		<< "format = " << (format == BINARY ? "binary" : format == INDEXED ? "indexed" : format == NO_SPIKE_FILE ? "none" : "text") << "\n"
+		<< "statistics = " << statistics << "\n"
+		<< "statisticsBin = " << statisticsBin << "\n"
+		<< "fanoWindow = " << fanoWindow << "\n"
+		<< "checkpoint = " << checkpoint << "\n"
+		<< "checkpointTime = " << checkpointTime << "\n"
+		<< "restore = " << restore << "\n"
+		<< "profile = " << profile << "\n"
+		<< "profileTrace = " << profileTrace << "\n"
+		<< "writerMemory = " << writerMemory << "\n"
+		<< "ranks = " << ranks << "\n"
+		<< "rank = " << rank << "\n"
+		<< "transport = " << (transport == MESSAGE_PASSING ? "mpi" : "socket") << "\n"
+		<< "socket = " << socket << "\n";
+}
@@ -0,0 +1,195 @@
+/**
+ * @file   parameters.hpp
+ * @author Jonathan Haab
+ * @date   Automn, 2017
+ * @brief  parameters of a simulation, read at runtime from a file or from the command line
+ */
+
+#include <string>
+#include <vector>
+#include <ostream>
+#include <istream>
+#include <cstdint>
+#include "constants.hpp"
+
+#ifndef PARAMETERS_H
+#define PARAMETERS_H
+
+/// How the connections are kept : stored as compressed sparse rows or regenerated at each spike
+enum ConnectivityMode {STORED, PROCEDURAL, connectivityModeSize};
+
+/// Format of the spike file : "time \t id" lines, the binary chunked format of spikeFile.hpp, no file, or the indexed format of spikeIndex.hpp
+enum SpikeFormat {TEXT, BINARY, NO_SPIKE_FILE, INDEXED, spikeFormatSize};
+
+/// How the ranks of a distributed simulation exchange their spikes : unix sockets on one machine or MPI
+enum TransportMode {SOCKETS, MESSAGE_PASSING, transportModeSize};
+
+/// How the membrane potentials and the synaptic inputs are stored : double, float or 32 bits fixed point
+enum Precision {DOUBLE_PRECISION, SINGLE_PRECISION, FIXED_POINT, precisionSize};
+
+/** Instance
+ *  one point (g, eta) of the phase diagram of Brunel, simulated over the connections of the batch
+ */
+struct Instance
+{
+	double J_i; //!< the EPSP of an inhibitory neuron, -g*J_e
+	double lambda; //!< mean number of external spikes per step, eta times the input that brings a neuron to v_th
+};
+
+/** Parameters
+ *  every value starts at the one of constants.hpp, so that the default
+ *  simulation is the one of the constants, and can be changed by
+ *  "key = value" lines of a file or "--key=value" arguments
+ */
+struct Parameters
+{
+	// Model
+	double h = ::h; //!< time in ms of a step
+	double startTime = ::startTime; //!< time at which we begin the simulation
+	double stopTime = ::stopTime; //!< time at which we end the simulation
+	double plotStartTime = ::plotStartTime; //!< time at which we begin to catch data for the plot
+	double plotStopTime = ::plotStopTime; //!< time at which we stop to catch data for the plot
+	double tau = ::tau; //!< membrane time constant (ms)
+	double refractorySteps = ::refractorySteps; //!< refractory time given in steps of h
+	double lambda = ::lambda; //!< mean number of external spikes per step
+	double v_th = ::v_th; //!< the potential (in mV) at which the neuron spike
+	double v_res = ::v_res; //!< the potential given to the neuron after it spikes
+	int N = ::N; //!< total number of neurons
+	double excitatoryRatio = double(::N_e)/::N; //!< part of the neurons that are excitatory
+	double connectionRatio = double(::C_e)/::N_e; //!< part of the excitatory (inhibitory) neurons connected to a neuron
+	double J_e = ::J_e; //!< the EPSP of an excitatory neuron
+	double J_i = ::J_i; //!< the EPSP of an inhibitory neuron
+	double c = ::c; //!< the capacity of the neuron's membrane
+	int bufferDelay = ::bufferDelay; //!< the delay (in steps) after which a neuron receive an EPSP of an excitatory neuron
+	int inhibitoryDelay = 0; //!< the delay (in steps) of the EPSP of an inhibitory neuron, bufferDelay if 0
+	int delaySpread = 0; //!< each synapse adds to the delay of its projection a number of steps drawn uniformly in [0, delaySpread], at most 255
+	std::string batch = ""; //!< instances "g:eta,g:eta,..." simulated at once over the same connections, J_i and lambda are used if empty
+	double rasterRetention = 100; //!< time in ms during which the spikes of a neuron can be asked for, 0 keeps every spike
+
+	// Run
+	int threads = 1; //!< number of threads that update the network
+	Precision precision = DOUBLE_PRECISION; //!< type of the membrane potentials and of the synaptic inputs, float is integrated in float and fixed point in double, neuronMain starts at the one of the build
+	bool timeBlocked = true; //!< each block of neurons is integrated for a whole window at once, instead of one step of every neuron at a time
+	bool numa = false; //!< pins the threads over the NUMA nodes and moves the state of each partition to the node of its thread
+	bool hugePages = false; //!< advises transparent huge pages for the large arrays of the neurons and of the connections
+	ConnectivityMode connectivity = STORED; //!< how the connections are kept
+	bool compressTargets = false; //!< the stored targets are kept in 16 bits relative to their segment of 65536 neurons instead of 32 bits
+	std::string connectivityCache = ""; //!< folder in which the stored connections are saved once, then mapped by every run of the same network, none if empty
+	uint64_t seed = 0; //!< seed of every random draw
+	bool randomSeed = true; //!< true until a seed is given, the seed is then drawn at startup
+	std::string output = "Neurons_Spikes.txt"; //!< file in which the spikes are printed
+	SpikeFormat format = TEXT; //!< format of the spike file
+	std::string statistics = ""; //!< file in which the statistics of the spikes are written at the end, none if empty
+	double statisticsBin = 1; //!< time in ms of a bin of the population rates of the statistics
+	double fanoWindow = 100; //!< time in ms of the windows in which the spikes are counted for the Fano factors
+	std::string checkpoint = ""; //!< file in which the state is saved at checkpointTime, none if empty
+	double checkpointTime = ::plotStartTime; //!< time at which the state is saved, the end of the warm up by default
+	std::string restore = ""; //!< checkpoint from which the simulation starts, none if empty
+	std::string profile = ""; //!< file in which the JSON report of the timers and counters is written at the end, none if empty (needs -DNEURONS_PROFILE=ON)
+	std::string profileTrace = ""; //!< file in which the phases of every window are written at the end, none if empty (needs -DNEURONS_PROFILE=ON)
+	int writerMemory = 64; //!< memory in MB of the spikes waiting to be written by the background thread, 0 writes them on the simulation thread
+
+	// Distribution
+	int ranks = 1; //!< number of processes, each one simulates a contiguous range of neurons
+	int rank = 0; //!< rank of this process, the rank 0 writes the spikes
+	TransportMode transport = SOCKETS; //!< how the ranks exchange their spikes, MPI gives ranks and rank itself
+	std::string socket = "Neurons.sock"; //!< unix socket on which the rank 0 waits for the other ranks
+
+	/** N_e
+	 * @return the number of excitatory neurons
+	 */
+	int N_e() const;
+
+	/** N_i
+	 * @return the number of inhibitory neurons
+	 */
+	int N_i() const;
+
+	/** C_e
+	 * @return the number of connections with excitatory neurons
+	 */
+	int C_e() const;
+
+	/** C_i
+	 * @return the number of connections with inhibitory neurons
+	 */
+	int C_i() const;
+
+	/** c1
+	 * @return the factor of the potential in the update of the membrane
+	 */
+	double c1() const;
+
+	/** c2
+	 * @return the factor of the current in the update of the membrane
+	 */
+	double c2() const;
+
+	/** projectionDelay
+	 *
+	 * @param excitatory 	true for the synapses of an excitatory neuron, false for an inhibitory one
+	 * @return the delay in steps of the synapses of the projection, before their own spread
+	 */
+	int projectionDelay(bool excitatory) const;
+
+	/** minDelay
+	 * @return the shortest delay of a synapse : the steps that can be integrated without any delivery
+	 */
+	int minDelay() const;
+
+	/** maxDelay
+	 * @return the longest delay of a synapse : the steps that the ring buffers must hold
+	 */
+	int maxDelay() const;
+
+	/** totalSteps
+	 * @return the number of steps of the simulation
+	 */
+	long totalSteps() const;
+
+	/** instances
+	 * @return the instances of the batch, a single one of J_i and lambda if batch is empty
+	 * @throw std::invalid_argument if batch is not a list of g:eta
+	 */
+	std::vector<Instance> instances() const;
+
+	/** set
+	 *
+	 * @param key 		the name of a parameter, like the fields above
+	 * @param value 	its new value
+	 * @throw std::invalid_argument if the key is unknown or the value is not valid
+	 */
+	void set(const std::string& key, const std::string& value);
+
+	/** load
+	 *
+	 * @param file 	a file of "key = value" lines, '#' starts a comment
+	 * @throw std::invalid_argument if the file cannot be read or a line is not valid
+	 */
+	void load(const std::string& file);
+
+	/** load
+	 *
+	 * @param in 		"key = value" lines, like a file given to load
+	 * @param source 	where the lines come from, for the error messages
+	 * @throw std::invalid_argument if a line is not valid
+	 */
+	void load(std::istream& in, const std::string& source);
+
+	/** parse
+	 *
+	 * @param argc 	the number of arguments of main
+	 * @param argv 	the arguments : --key=value, --key value or --config=file,
+	 * 				read in order so that the last one wins
+	 * @throw std::invalid_argument if an argument is not valid
+	 */
+	void parse(int argc, char* argv[]);
+
+	/** write
+	 *
+	 * @param out 	receives every parameter as a "key = value" line, a file that load can read
+	 */
+	void write(std::ostream& out) const;
+};
+
+#endif
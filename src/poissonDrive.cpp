@@ -0,0 +1,169 @@
+/**
+ * @file   poissonDrive.cpp
+ * @author Jonathan Haab
+ * @date   Automn, 2017
+ * @brief  contains all the methods of the external input
+ */
+
+#include "poissonDrive.hpp"
+#include "counterRandom.hpp"
+#include <cmath>
+#include <algorithm>
+
+using namespace std;
+
+/** countAbove
+ *
+ * @param words 		the random words of the batch
+ * @param counts 		receives, for each word, the number of thresholds it reaches
+ * @param size 		the number of words
+ * @param thresholds 	the cumulative distribution
+ * @param K 			the number of thresholds, known at compile time so that
+ * 					the loop over the thresholds is unrolled
+ */
+template<int K>
+static void countAbove(const uint32_t* words, uint32_t* counts, int size, const uint32_t* thresholds)
+{
+	for(int i(0); i < size; ++i){
+		uint32_t count(0);
+		for(int k(0); k < K; ++k){
+			count += (words[i] >= thresholds[k]);
+		}
+		counts[i] = count;
+	}
+}
+
+/** countAbove
+ *
+ * @note generic version, for any number of thresholds
+ */
+static void countAbove(const uint32_t* words, uint32_t* counts, int size, const vector<uint32_t>& thresholds)
+{
+	// Pour lambda entre 0.2 et 2 environ (0.9 par défaut : 12 seuils), le nombre de seuils est connu à la compilation
+	switch(thresholds.size()){
+		case 7 : countAbove<7>(words, counts, size, thresholds.data()); return;
+		case 8 : countAbove<8>(words, counts, size, thresholds.data()); return;
+		case 9 : countAbove<9>(words, counts, size, thresholds.data()); return;
+		case 10 : countAbove<10>(words, counts, size, thresholds.data()); return;
+		case 11 : countAbove<11>(words, counts, size, thresholds.data()); return;
+		case 12 : countAbove<12>(words, counts, size, thresholds.data()); return;
+		case 13 : countAbove<13>(words, counts, size, thresholds.data()); return;
+		case 14 : countAbove<14>(words, counts, size, thresholds.data()); return;
+		case 15 : countAbove<15>(words, counts, size, thresholds.data()); return;
+		case 16 : countAbove<16>(words, counts, size, thresholds.data()); return;
+		default : break;
+	}
+
+	fill_n(counts, size, 0u);
+	for(size_t k(0); k < thresholds.size(); ++k){
+		uint32_t threshold(thresholds[k]);
+		for(int i(0); i < size; ++i){
+			counts[i] += (words[i] >= threshold);
+		}
+	}
+}
+
+/** Constructor
+ *
+ * @param seed 		the key of the generator
+ * @param lambda 		the mean of the poisson distribution
+ * @param amplitude 	the potential given by one external spike
+ */
+PoissonDrive::PoissonDrive(uint64_t seed, double lambda, double amplitude)
+	: PoissonDrive(seed, vector<double>(1, lambda), amplitude)
+{}
+
+/** Constructor
+ *
+ * @param seed 		the key of the generator
+ * @param lambdas 		the means of the poisson distributions, drawn from the same words
+ * @param amplitude 	the potential given by one external spike
+ */
+PoissonDrive::PoissonDrive(uint64_t seed, const vector<double>& lambdas, double amplitude)
+	: seed(seed), amplitude(amplitude), thresholds(lambdas.size())
+{
+	for(size_t m(0); m < lambdas.size(); ++m){
+
+		// Seuils jusqu'à ce que la queue de la distribution soit plus petite que 2^-32
+		double p(exp(-lambdas[m]));
+		double cdf(p);
+
+		for(int k(0); cdf*4294967296.0 < 4294967295.0 and k < 1000; ++k){
+			thresholds[m].push_back(uint32_t(cdf*4294967296.0));
+			p *= lambdas[m]/(k+1);
+			cdf += p;
+		}
+	}
+}
+
+/** fill
+ *
+ * @param step 	the step of the input
+ * @param begin 	the first neuron
+ * @param end 		the neuron after the last one
+ * @param drive 	filled with the inputs of the neurons [begin, end), the
+ * 				inputs of the means of a neuron are contiguous
+ * @note draws the whole batch by inversion of the cumulative
+ * 		 distribution, without any branch per neuron
+ * @note Real is double or float, the type in which the kernel integrates
+ */
+template<typename Real>
+void PoissonDrive::fill(long step, int begin, int end, Real* drive) const
+{
+	const int batch(256);
+	const int means(thresholds.size());
+	uint32_t words[batch];
+	uint32_t counts[batch];
+
+	for(int first(begin); first < end; first += batch){
+
+		int size(min(batch, end - first));
+
+		// Un appel à philox donne les mots de 4 neurones consécutifs
+		for(int i(first & ~3); i < first + size; i += 4){
+
+			uint32_t c[4] = {uint32_t(step), uint32_t(uint64_t(step) >> 32), uint32_t(i/4), 0};
+			philox(seed, c);
+
+			for(int l(0); l < 4; ++l){
+				if(i + l >= first and i + l < first + size) words[i + l - first] = c[l];
+			}
+		}
+
+		if(means == 1){
+			countAbove(words, counts, size, thresholds[0]);
+			for(int i(0); i < size; ++i){
+				drive[first - begin + i] = amplitude*counts[i];
+			}
+			continue;
+		}
+
+		// Les mots ne sont tirés qu'une fois pour toutes les moyennes
+		for(int m(0); m < means; ++m){
+
+			countAbove(words, counts, size, thresholds[m]);
+
+			for(int i(0); i < size; ++i){
+				drive[(first - begin + i)*means + m] = amplitude*counts[i];
+			}
+		}
+	}
+}
+
+template void PoissonDrive::fill(long step, int begin, int end, double* drive) const;
+template void PoissonDrive::fill(long step, int begin, int end, float* drive) const;
+
+/** sample
+ *
+ * @param word 	a random word, uniform on 32 bits
+ * @param mean 	the index of the mean
+ * @return the number of external spikes given by word
+ */
+int PoissonDrive::sample(uint32_t word, int mean) const
+{
+	int k(0);
+	for(size_t j(0); j < thresholds[mean].size(); ++j){
+		k += (word >= thresholds[mean][j]);
+	}
+	return k;
+}
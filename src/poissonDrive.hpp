@@ -0,0 +1,71 @@
+/**
+ * @file   poissonDrive.hpp
+ * @author Jonathan Haab
+ * @date   Automn, 2017
+ * @brief  external input of the neurons drawn by batches from counter-based streams
+ */
+
+#include <vector>
+#include <cstdint>
+
+#ifndef POISSONDRIVE_H
+#define POISSONDRIVE_H
+
+/** PoissonDrive
+ *  the external input of neuron i at step s is amplitude*k, k drawn from a
+ *  poisson distribution of mean lambda with the word i%4 of
+ *  philox(seed, (s, i/4)). It only depends on (seed, i, s) : the same seed
+ *  gives the same inputs whatever the number of threads or partitions.
+ *  Several means can share the words : the input of each mean is then the
+ *  one it would have alone.
+ */
+class PoissonDrive
+{
+	public :
+
+		/** Constructor
+		 *
+		 * @param seed 		the key of the generator
+		 * @param lambda 		the mean of the poisson distribution
+		 * @param amplitude 	the potential given by one external spike
+		 */
+		PoissonDrive(uint64_t seed, double lambda, double amplitude);
+
+		/** Constructor
+		 *
+		 * @param seed 		the key of the generator
+		 * @param lambdas 		the means of the poisson distributions, drawn from the same words
+		 * @param amplitude 	the potential given by one external spike
+		 */
+		PoissonDrive(uint64_t seed, const std::vector<double>& lambdas, double amplitude);
+
+		/** fill
+		 *
+		 * @param step 	the step of the input
+		 * @param begin 	the first neuron
+		 * @param end 		the neuron after the last one
+		 * @param drive 	filled with the inputs of the neurons [begin, end), the
+		 * 				inputs of the means of a neuron are contiguous
+		 * @note draws the whole batch by inversion of the cumulative
+		 * 		 distribution, without any branch per neuron
+		 * @note Real is double or float, the type in which the kernel integrates
+		 */
+		template<typename Real>
+		void fill(long step, int begin, int end, Real* drive) const;
+
+		/** sample
+		 *
+		 * @param word 	a random word, uniform on 32 bits
+		 * @param mean 	the index of the mean
+		 * @return the number of external spikes given by word
+		 */
+		int sample(uint32_t word, int mean = 0) const;
+
+	private :
+
+		uint64_t seed; //!< Key of the generator
+		double amplitude; //!< Potential given by one external spike
+		std::vector<std::vector<uint32_t>> thresholds; //!< For each mean, k external spikes if the word is above k thresholds (cumulative distribution times 2^32)
+};
+
+#endif
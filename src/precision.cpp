@@ -0,0 +1,219 @@
+/**
+ * @file   precision.cpp
+ * @author Jonathan Haab
+ * @date   Automn, 2017
+ * @brief  contains all the methods of the arrays of cells in double, float or fixed point
+ */
+
+#include "precision.hpp"
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+using namespace std;
+
+/** sectionName
+ * @return the name of the section of the cells of name in the precision
+ */
+static string sectionName(const string& name, Precision precision)
+{
+	return precision == DOUBLE_PRECISION ? name : name + "." + precisionName(precision);
+}
+
+/** cellUnits
+ *
+ * @param precision 	the precision of the cells
+ * @param value 		a value in mV
+ * @return the cell of value, as a double : adding it to a cell converts it exactly
+ */
+double cellUnits(Precision precision, double value)
+{
+	switch(precision){
+		case SINGLE_PRECISION : return CellTraits<float>::encode(value);
+		case FIXED_POINT : return CellTraits<int32_t>::encode(value);
+		default : return value;
+	}
+}
+
+/** cellBytes
+ * @return the size of a cell of the precision
+ */
+size_t cellBytes(Precision precision)
+{
+	switch(precision){
+		case SINGLE_PRECISION : return sizeof(float);
+		case FIXED_POINT : return sizeof(int32_t);
+		default : return sizeof(double);
+	}
+}
+
+/** realPrecision
+ * @return the precision of CellTraits::Real for the cells of the precision
+ */
+Precision realPrecision(Precision precision)
+{
+	return precision == SINGLE_PRECISION ? SINGLE_PRECISION : DOUBLE_PRECISION;
+}
+
+/** precisionName
+ * @return the name of the precision, as given on the command line
+ */
+string precisionName(Precision precision)
+{
+	switch(precision){
+		case SINGLE_PRECISION : return "float";
+		case FIXED_POINT : return "fixed";
+		default : return "double";
+	}
+}
+
+/** Constructor
+ *
+ * @param precision 	the type of the cells
+ * @param size 		the number of cells
+ * @param hugePages 	true to advise huge pages if the array is large
+ * @note the cells are not written : their pages are placed by the thread that first writes them
+ */
+CellArray::CellArray(Precision precision, size_t size, bool hugePages)
+	: precision(precision), width(cellBytes(precision)), count(size), bytes((PlacedAllocator<unsigned char>(hugePages)))
+{
+	bytes.resize(count*width);
+}
+
+/** fill
+ *
+ * @param value 	the new value in mV of every cell
+ */
+void CellArray::fill(double value)
+{
+	switch(precision){
+		case SINGLE_PRECISION : std::fill(data<float>(), data<float>() + count, CellTraits<float>::encode(value)); break;
+		case FIXED_POINT : std::fill(data<int32_t>(), data<int32_t>() + count, CellTraits<int32_t>::encode(value)); break;
+		default : std::fill(data<double>(), data<double>() + count, value);
+	}
+}
+
+/** get
+ * @return the value of the cell i in mV
+ */
+double CellArray::get(size_t i) const
+{
+	switch(precision){
+		case SINGLE_PRECISION : return CellTraits<float>::decode(data<float>()[i]);
+		case FIXED_POINT : return CellTraits<int32_t>::decode(data<int32_t>()[i]);
+		default : return data<double>()[i];
+	}
+}
+
+/** set
+ *
+ * @param i 		a cell
+ * @param value 	its new value in mV
+ */
+void CellArray::set(size_t i, double value)
+{
+	switch(precision){
+		case SINGLE_PRECISION : data<float>()[i] = CellTraits<float>::encode(value); break;
+		case FIXED_POINT : data<int32_t>()[i] = CellTraits<int32_t>::encode(value); break;
+		default : data<double>()[i] = value;
+	}
+}
+
+/** add
+ *
+ * @param i 		a cell
+ * @param value 	a value in mV added to the cell, rounded to the precision first
+ */
+void CellArray::add(size_t i, double value)
+{
+	switch(precision){
+		case SINGLE_PRECISION : data<float>()[i] += CellTraits<float>::encode(value); break;
+		case FIXED_POINT : data<int32_t>()[i] += CellTraits<int32_t>::encode(value); break;
+		default : data<double>()[i] += value;
+	}
+}
+
+/** copy
+ *
+ * @param from 	an array of the same precision
+ * @param first 	the first cell copied from it
+ * @param last 	the cell after the last one
+ */
+void CellArray::copy(const CellArray& from, size_t first, size_t last)
+{
+	memcpy(bytes.data() + first*width, from.bytes.data() + first*width, (last - first)*width);
+}
+
+/** swap
+ *
+ * @param other 	exchanges its cells and its precision with this array
+ */
+void CellArray::swap(CellArray& other)
+{
+	std::swap(precision, other.precision);
+	std::swap(width, other.width);
+	std::swap(count, other.count);
+	bytes.swap(other.bytes);
+}
+
+/** size
+ * @return the number of cells
+ */
+size_t CellArray::size() const
+{
+	return count;
+}
+
+/** cellSize
+ * @return the bytes of a cell
+ */
+size_t CellArray::cellSize() const
+{
+	return width;
+}
+
+/** getPrecision
+ * @return the type of the cells
+ */
+Precision CellArray::getPrecision() const
+{
+	return precision;
+}
+
+/** save
+ *
+ * @param out 	receives the cells
+ * @param name 	the name of the section, followed by the precision if it is not double
+ */
+void CellArray::save(CheckpointWriter& out, const string& name) const
+{
+	out.add(sectionName(name, precision), bytes.data(), bytes.size());
+}
+
+/** restore
+ *
+ * @param in 		a checkpoint written by save in any precision
+ * @param name 	the name given to save
+ * @throw std::runtime_error if the checkpoint has not size cells of this name
+ * @note the cells saved in another precision are converted
+ */
+void CellArray::restore(const CheckpointReader& in, const string& name)
+{
+	// Un état sauvé dans une précision peut être continué dans une autre : chaque cellule repasse par sa valeur en mV
+	for(int p(0); p < precisionSize; ++p){
+
+		Precision saved(static_cast<Precision>(p));
+		if(not in.has(sectionName(name, saved))) continue;
+
+		CellArray cells(saved);
+		in.read(sectionName(name, saved), cells.bytes, count*cells.width);
+		cells.count = count;
+
+		if(saved == precision) bytes.swap(cells.bytes);
+		else for(size_t i(0); i < count; ++i) set(i, cells.get(i));
+		return;
+	}
+	// Aucune précision ne l'a : read donne l'erreur de la section manquante
+	size_t missing;
+	in.read(name, missing);
+}
@@ -0,0 +1,191 @@
+/**
+ * @file   precision.hpp
+ * @author Jonathan Haab
+ * @date   Automn, 2017
+ * @brief  membrane potentials and synaptic inputs stored in double, float or fixed point
+ */
+
+#include <string>
+#include <cstdint>
+#include <cstddef>
+#include <cmath>
+#include "parameters.hpp"
+#include "checkpoint.hpp"
+#include "topology.hpp"
+
+#ifndef PRECISION_H
+#define PRECISION_H
+
+static const int fixedBits = 20; //!< Bits after the point of a fixed point cell : a resolution of 1e-6 mV up to ±2048 mV
+static const double fixedScale = double(1 << fixedBits); //!< Value of the fixed point cell 1
+
+/** CellTraits
+ *  how a value (in mV) is kept in a cell of type Cell : double, float or int32_t in fixed point.
+ *  encode rounds to the nearest cell, like the conversions of the vectorized kernels.
+ *  Real is the type in which the kernel integrates the cells, and of the countdowns and drives.
+ */
+template<typename Cell>
+struct CellTraits;
+
+template<>
+struct CellTraits<double>
+{
+	typedef double Real;
+	static const Precision precision = DOUBLE_PRECISION;
+	static double encode(double value) { return value; }
+	static double decode(double cell) { return cell; }
+};
+
+template<>
+struct CellTraits<float>
+{
+	typedef float Real;
+	static const Precision precision = SINGLE_PRECISION;
+	static float encode(double value) { return float(value); }
+	static double decode(float cell) { return cell; }
+};
+
+template<>
+struct CellTraits<int32_t>
+{
+	typedef double Real;
+	static const Precision precision = FIXED_POINT;
+	static int32_t encode(double value) { return int32_t(std::nearbyint(value*fixedScale)); }
+	static double decode(int32_t cell) { return cell*(1/fixedScale); }
+};
+
+/** cellUnits
+ *
+ * @param precision 	the precision of the cells
+ * @param value 		a value in mV
+ * @return the cell of value, as a double : adding it to a cell converts it exactly
+ */
+double cellUnits(Precision precision, double value);
+
+/** cellBytes
+ * @return the size of a cell of the precision
+ */
+size_t cellBytes(Precision precision);
+
+/** realPrecision
+ * @return the precision of CellTraits::Real for the cells of the precision
+ */
+Precision realPrecision(Precision precision);
+
+/** precisionName
+ * @return the name of the precision, as given on the command line
+ */
+std::string precisionName(Precision precision);
+
+/** CellArray
+ *  array of values stored in the precision chosen at run time. The kernels
+ *  and the deliveries read the cells with their type through data<Cell>(),
+ *  the other uses go through get and set, which convert the values in mV.
+ */
+class CellArray
+{
+	public :
+
+		/** Constructor
+		 *
+		 * @param precision 	the type of the cells
+		 * @param size 		the number of cells
+		 * @param hugePages 	true to advise huge pages if the array is large
+		 * @note the cells are not written : their pages are placed by the thread that first writes them
+		 */
+		CellArray(Precision precision = DOUBLE_PRECISION, size_t size = 0, bool hugePages = false);
+
+		/** fill
+		 *
+		 * @param value 	the new value in mV of every cell
+		 */
+		void fill(double value);
+
+		/** data
+		 * @return the cells, Cell must be the type of the precision
+		 */
+		template<typename Cell>
+		Cell* data() { return reinterpret_cast<Cell*>(bytes.data()); }
+
+		template<typename Cell>
+		const Cell* data() const { return reinterpret_cast<const Cell*>(bytes.data()); }
+
+		/** cell
+		 * @return the address of the cell i, for a prefetch or a row of cells whose type is chosen later
+		 */
+		void* cell(size_t i) { return bytes.data() + i*width; }
+		const void* cell(size_t i) const { return bytes.data() + i*width; }
+
+		/** get
+		 * @return the value of the cell i in mV
+		 */
+		double get(size_t i) const;
+
+		/** set
+		 *
+		 * @param i 		a cell
+		 * @param value 	its new value in mV
+		 */
+		void set(size_t i, double value);
+
+		/** add
+		 *
+		 * @param i 		a cell
+		 * @param value 	a value in mV added to the cell, rounded to the precision first
+		 */
+		void add(size_t i, double value);
+
+		/** copy
+		 *
+		 * @param from 	an array of the same precision
+		 * @param first 	the first cell copied from it
+		 * @param last 	the cell after the last one
+		 */
+		void copy(const CellArray& from, size_t first, size_t last);
+
+		/** swap
+		 *
+		 * @param other 	exchanges its cells and its precision with this array
+		 */
+		void swap(CellArray& other);
+
+		/** size
+		 * @return the number of cells
+		 */
+		size_t size() const;
+
+		/** cellSize
+		 * @return the bytes of a cell
+		 */
+		size_t cellSize() const;
+
+		/** getPrecision
+		 * @return the type of the cells
+		 */
+		Precision getPrecision() const;
+
+		/** save
+		 *
+		 * @param out 	receives the cells
+		 * @param name 	the name of the section, followed by the precision if it is not double
+		 */
+		void save(CheckpointWriter& out, const std::string& name) const;
+
+		/** restore
+		 *
+		 * @param in 		a checkpoint written by save in any precision
+		 * @param name 	the name given to save
+		 * @throw std::runtime_error if the checkpoint has not size cells of this name
+		 * @note the cells saved in another precision are converted
+		 */
+		void restore(const CheckpointReader& in, const std::string& name);
+
+	private :
+
+		Precision precision; //!< Type of the cells
+		size_t width; //!< Bytes of a cell
+		size_t count; //!< Number of cells
+		PlacedVector<unsigned char> bytes; //!< The cells, aligned on a cache line
+};
+
+#endif
@@ -0,0 +1,79 @@
+/**
+ * @file   proceduralConnectivity.cpp
+ * @author Jonathan Haab
+ * @date   Automn, 2017
+ * @brief  contains all the methods of the regenerated connections
+ */
+
+#include "proceduralConnectivity.hpp"
+#include "counterRandom.hpp"
+#include "connectivity.hpp"
+#include <cmath>
+#include <algorithm>
+
+using namespace std;
+
+/** Constructor
+ *
+ * @param seed 				the key of the generator, the same seed gives the same network
+ * @param size 				the number of neurons
+ * @param excitatorySize 	the number of excitatory neurons, ids [0, excitatorySize)
+ * @param excitatoryInputs 	the mean number of excitatory inputs of a neuron
+ * @param inhibitoryInputs 	the mean number of inhibitory inputs of a neuron
+ * @param delaySpread 		the largest delay added to a connection, 0 if they have none
+ */
+ProceduralConnectivity::ProceduralConnectivity(uint64_t seed, int size, int excitatorySize, int excitatoryInputs, int inhibitoryInputs, int delaySpread)
+	: seed(seed), n(size), excitatorySize(excitatorySize),
+	  logExcitatory(log1p(-min(1.0, double(excitatoryInputs)/max(1, excitatorySize)))),
+	  logInhibitory(log1p(-min(1.0, double(inhibitoryInputs)/max(1, size - excitatorySize)))),
+	  delaySpread(delaySpread)
+{}
+
+/** targetsOf
+ *
+ * @param source 	the presynaptic neuron
+ * @param first 	the first target that is wanted
+ * @param last 		the target after the last one that is wanted
+ * @param out 		filled with the targets of source in [first, last), in increasing order
+ * @param delays 	filled with the delay of each target if it is given and there is a delay spread
+ */
+void ProceduralConnectivity::targetsOf(int source, int first, int last, vector<int>& out, vector<uint8_t>* delays) const
+{
+	out.clear();
+	if(delays) delays->clear();
+
+	double logMiss(source < excitatorySize ? logExcitatory : logInhibitory);
+	if(logMiss == 0) return; // probabilité nulle
+
+	long blocks((n + blockSize - 1)/blockSize);
+
+	for(int b(first/blockSize); b*blockSize < last; ++b){
+
+		CounterStream rng(seed, uint64_t(source)*blocks + b);
+		long blockEnd(min(n, (b+1)*blockSize));
+		long j(long(b)*blockSize - 1);
+
+		// L'écart entre deux cibles suit une loi géométrique : on saute directement à la suivante
+		while(true){
+			double gap(floor(log(rng.uniform())/logMiss));
+			if(gap >= blockEnd - j - 1) break;
+
+			j += 1 + long(gap);
+
+			// Le délai est tiré pour chaque cible du bloc, gardée ou non : il ne dépend pas de [first, last)
+			uint8_t delay(delaySpread > 0 ? spreadDelay(rng(), delaySpread) : 0);
+			if(j >= first and j < last){
+				out.push_back(j);
+				if(delays and delaySpread > 0) delays->push_back(delay);
+			}
+		}
+	}
+}
+
+/** sources
+ * @return the number of presynaptic neurons
+ */
+int ProceduralConnectivity::sources() const
+{
+	return n;
+}
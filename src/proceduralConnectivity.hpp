@@ -0,0 +1,66 @@
+/**
+ * @file   proceduralConnectivity.hpp
+ * @author Jonathan Haab
+ * @date   Automn, 2017
+ * @brief  connections of the network regenerated on demand instead of stored
+ */
+
+#include <vector>
+#include <cstdint>
+
+#ifndef PROCEDURALCONNECTIVITY_H
+#define PROCEDURALCONNECTIVITY_H
+
+/** ProceduralConnectivity
+ *  nothing is stored : the targets of a neuron are drawn again each time
+ *  they are needed from a counter-based generator keyed by (seed, neuron).
+ *  An excitatory neuron is connected to each neuron with the probability
+ *  C_e/N_e and an inhibitory one with C_i/N_i, so that every neuron gets
+ *  on average C_e excitatory and C_i inhibitory inputs, like createConnections.
+ *  The targets are drawn by blocks of blockSize neurons, each block with its
+ *  own stream, so that a range of targets is regenerated without the others.
+ *  With a delay spread, the word after each gap draws the delay of the target.
+ */
+class ProceduralConnectivity
+{
+	public :
+
+		static constexpr int blockSize = 1024; //!< Number of targets drawn from one stream
+
+		/** Constructor
+		 *
+		 * @param seed 				the key of the generator, the same seed gives the same network
+		 * @param size 				the number of neurons
+		 * @param excitatorySize 	the number of excitatory neurons, ids [0, excitatorySize)
+		 * @param excitatoryInputs 	the mean number of excitatory inputs of a neuron
+		 * @param inhibitoryInputs 	the mean number of inhibitory inputs of a neuron
+		 * @param delaySpread 		the largest delay added to a connection, 0 if they have none
+		 */
+		ProceduralConnectivity(uint64_t seed, int size, int excitatorySize, int excitatoryInputs, int inhibitoryInputs, int delaySpread = 0);
+
+		/** targetsOf
+		 *
+		 * @param source 	the presynaptic neuron
+		 * @param first 	the first target that is wanted
+		 * @param last 		the target after the last one that is wanted
+		 * @param out 		filled with the targets of source in [first, last), in increasing order
+		 * @param delays 	filled with the delay of each target if it is given and there is a delay spread
+		 */
+		void targetsOf(int source, int first, int last, std::vector<int>& out, std::vector<uint8_t>* delays = nullptr) const;
+
+		/** sources
+		 * @return the number of presynaptic neurons
+		 */
+		int sources() const;
+
+	private :
+
+		uint64_t seed; //!< Key of the generator
+		int n; //!< Number of neurons
+		int excitatorySize; //!< Number of excitatory neurons
+		double logExcitatory; //!< log(1-p) for an excitatory source, p the probability of a connection
+		double logInhibitory; //!< log(1-p) for an inhibitory source
+		int delaySpread; //!< Largest delay added to a connection
+};
+
+#endif
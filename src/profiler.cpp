@@ -0,0 +1,190 @@
+/**
+ * @file   profiler.cpp
+ * @author Jonathan Haab
+ * @date   Automn, 2017
+ * @brief  contains all the methods of the profiler of the simulation
+ */
+
+#include "profiler.hpp"
+#include <algorithm>
+
+using namespace std;
+
+/// Names of the phases and of the counters in the reports
+static const char* phaseNames[profilePhaseSize] = {"integrate", "wait", "exchange", "record", "write", "deliver"};
+static const char* counterNames[profileCounterSize] = {"steps", "windows", "spikes", "synapticEvents", "ringWrites"};
+
+/** Constructor
+ *
+ * @param threads 	the number of threads that add to the profiler
+ * @note the frequency of the ticks is measured from this moment to the report
+ */
+Profiler::Profiler(int threads)
+	: slots(max(threads, 1)), tracing(false), updateTicks(0),
+	  startTicks(ticks()), startTime(chrono::steady_clock::now())
+{
+	for(size_t t(0); t < slots.size(); ++t){
+		fill(slots[t].ticks, slots[t].ticks + profilePhaseSize, 0);
+		fill(slots[t].counters, slots[t].counters + profileCounterSize, 0);
+		fill(slots[t].windowStart, slots[t].windowStart + profilePhaseSize, 0);
+	}
+}
+
+/** lapUpdate
+ *
+ * @param since 	the ticks at which a call of Network::update began
+ */
+void Profiler::lapUpdate(uint64_t since)
+{
+	updateTicks += ticks() - since;
+}
+
+/** setTracing
+ *
+ * @param tracing 	true to keep the phases of every window for writeTrace
+ */
+void Profiler::setTracing(bool tracing)
+{
+	this->tracing = tracing;
+}
+
+/** endWindow
+ *
+ * @param thread 	the thread that ends a window
+ * @param begin 	the first step of the window
+ * @param steps 	the number of steps of the window
+ * @param spikes 	the spikes of the neurons of the thread during the window
+ * @note keeps the ticks of each phase since the last window of the thread, if tracing
+ */
+void Profiler::endWindow(int thread, long begin, long steps, uint64_t spikes)
+{
+	Slot& slot(slots[thread]);
+
+	slot.counters[WINDOWS] += 1;
+	if(thread == 0) slot.counters[STEPS] += steps;
+	slot.counters[SPIKES] += spikes;
+	if(not tracing) return;
+
+	Window window = {begin, steps, spikes, {}};
+	for(int p(0); p < profilePhaseSize; ++p){
+		window.ticks[p] = slot.ticks[p] - slot.windowStart[p];
+		slot.windowStart[p] = slot.ticks[p];
+	}
+	slot.trace.push_back(window);
+}
+
+/** getTicks
+ *
+ * @param phase 	a phase
+ * @return the ticks of the phase, summed over the threads
+ */
+uint64_t Profiler::getTicks(ProfilePhase phase) const
+{
+	uint64_t sum(0);
+	for(size_t t(0); t < slots.size(); ++t) sum += slots[t].ticks[phase];
+	return sum;
+}
+
+/** getCount
+ *
+ * @param counter 	a kind of work
+ * @return the work, summed over the threads
+ */
+uint64_t Profiler::getCount(ProfileCounter counter) const
+{
+	// Chaque thread compte ses fenêtres : le nombre de fenêtres est celui du thread 0
+	if(counter == WINDOWS) return slots[0].counters[WINDOWS];
+
+	uint64_t sum(0);
+	for(size_t t(0); t < slots.size(); ++t) sum += slots[t].counters[counter];
+	return sum;
+}
+
+/** getTicksPerSecond
+ * @return the frequency of the ticks, measured since the constructor
+ */
+double Profiler::getTicksPerSecond() const
+{
+	double seconds(chrono::duration<double>(chrono::steady_clock::now() - startTime).count());
+	return seconds > 0 ? (ticks() - startTicks)/seconds : 1e9;
+}
+
+/** write
+ *
+ * @param out 			receives the report as a JSON object
+ * @param bytesWritten 	the size of the spike files
+ */
+void Profiler::write(ostream& out, uint64_t bytesWritten) const
+{
+	double frequency(getTicksPerSecond());
+	double seconds(updateTicks/frequency);
+	uint64_t steps(getCount(STEPS)), events(getCount(SYNAPTIC_EVENTS));
+
+	out.precision(6);
+	out << "{\n"
+		<< "\t\"threads\": " << slots.size() << ",\n"
+		<< "\t\"ticksPerSecond\": " << frequency << ",\n"
+		<< "\t\"updateSeconds\": " << seconds << ",\n";
+
+	// Chaque phase : la somme des threads, et le thread le plus lent qui fait attendre les autres
+	out << "\t\"phases\": {\n";
+	for(int p(0); p < profilePhaseSize; ++p){
+		uint64_t slowest(0);
+		for(size_t t(0); t < slots.size(); ++t) slowest = max(slowest, slots[t].ticks[p]);
+
+		out << "\t\t\"" << phaseNames[p] << "\": {\"seconds\": " << getTicks(ProfilePhase(p))/frequency
+			<< ", \"slowestThreadSeconds\": " << slowest/frequency << "}" << (p + 1 < profilePhaseSize ? ",\n" : "\n");
+	}
+	out << "\t},\n";
+
+	out << "\t\"counters\": {\n";
+	for(int c(0); c < profileCounterSize; ++c){
+		out << "\t\t\"" << counterNames[c] << "\": " << getCount(ProfileCounter(c)) << ",\n";
+	}
+	out << "\t\t\"spikesPerStep\": " << (steps > 0 ? double(getCount(SPIKES))/steps : 0) << ",\n"
+		<< "\t\t\"synapticEventsPerSecond\": " << (seconds > 0 ? events/seconds : 0) << ",\n"
+		<< "\t\t\"bytesWritten\": " << bytesWritten << "\n"
+		<< "\t},\n";
+
+	out << "\t\"perThread\": [\n";
+	for(size_t t(0); t < slots.size(); ++t){
+		out << "\t\t{";
+		for(int p(0); p < profilePhaseSize; ++p){
+			out << "\"" << phaseNames[p] << "\": " << slots[t].ticks[p]/frequency << ", ";
+		}
+		out << "\"spikes\": " << slots[t].counters[SPIKES] << "}" << (t + 1 < slots.size() ? ",\n" : "\n");
+	}
+	out << "\t]\n"
+		<< "}\n";
+}
+
+/** writeTrace
+ *
+ * @param out 	receives a "begin steps spikes phases..." line for each window, the
+ * 			spikes summed over the threads and the phases (µs) of the slowest thread
+ */
+void Profiler::writeTrace(ostream& out) const
+{
+	double microseconds(1e6/getTicksPerSecond());
+
+	out << "begin\tsteps\tspikes";
+	for(int p(0); p < profilePhaseSize; ++p) out << "\t" << phaseNames[p];
+	out << "\n";
+
+	// Tous les threads passent les mêmes fenêtres
+	for(size_t w(0); w < slots[0].trace.size(); ++w){
+
+		const Window& window(slots[0].trace[w]);
+		uint64_t spikes(0), slowest[profilePhaseSize] = {};
+
+		for(size_t t(0); t < slots.size(); ++t){
+			if(w >= slots[t].trace.size()) continue;
+			spikes += slots[t].trace[w].spikes;
+			for(int p(0); p < profilePhaseSize; ++p) slowest[p] = max(slowest[p], slots[t].trace[w].ticks[p]);
+		}
+
+		out << window.begin << "\t" << window.steps << "\t" << spikes;
+		for(int p(0); p < profilePhaseSize; ++p) out << "\t" << slowest[p]*microseconds;
+		out << "\n";
+	}
+}
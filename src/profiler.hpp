@@ -0,0 +1,183 @@
+/**
+ * @file   profiler.hpp
+ * @author Jonathan Haab
+ * @date   Automn, 2017
+ * @brief  timers of the phases of Network::update and counters of its work, read from the time stamp counter
+ */
+
+#include <vector>
+#include <ostream>
+#include <cstdint>
+#include <chrono>
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <x86intrin.h>
+#define PROFILER_TSC
+#endif
+
+#ifndef PROFILER_H
+#define PROFILER_H
+
+/// Phases of a window of Network::update, WAIT is the time spent in the barriers
+enum ProfilePhase {INTEGRATE, WAIT, EXCHANGE, RECORD, WRITE, DELIVER, profilePhaseSize};
+
+/// Work counted during the windows
+enum ProfileCounter {STEPS, WINDOWS, SPIKES, SYNAPTIC_EVENTS, RING_WRITES, profileCounterSize};
+
+/** Profiler
+ *  each thread only adds to its own slot, the slots are read once the
+ *  threads are done : no atomic and no lock in the simulation
+ *
+ *  Network only calls it through the PROFILE_ macros below, which are
+ *  empty unless the build defines NEURONS_PROFILE (cmake -DNEURONS_PROFILE=ON)
+ */
+class Profiler
+{
+	public :
+
+		/** Constructor
+		 *
+		 * @param threads 	the number of threads that add to the profiler
+		 * @note the frequency of the ticks is measured from this moment to the report
+		 */
+		Profiler(int threads);
+
+		/** ticks
+		 * @return the time stamp counter, or nanoseconds of the steady clock without it
+		 */
+		static uint64_t ticks()
+		{
+		#ifdef PROFILER_TSC
+			return __rdtsc();
+		#else
+			return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+		#endif
+		}
+
+		/** lap
+		 *
+		 * @param thread 	the thread that ran the phase
+		 * @param phase 	the phase that ends now
+		 * @param since 	the ticks at which it began
+		 * @return the ticks now, the beginning of the next phase
+		 */
+		uint64_t lap(int thread, ProfilePhase phase, uint64_t since)
+		{
+			uint64_t now(ticks());
+			slots[thread].ticks[phase] += now - since;
+			return now;
+		}
+
+		/** count
+		 *
+		 * @param thread 	the thread that did the work
+		 * @param counter 	the kind of work
+		 * @param value 	the amount of work
+		 */
+		void count(int thread, ProfileCounter counter, uint64_t value)
+		{
+			slots[thread].counters[counter] += value;
+		}
+
+		/** lapUpdate
+		 *
+		 * @param since 	the ticks at which a call of Network::update began
+		 */
+		void lapUpdate(uint64_t since);
+
+		/** setTracing
+		 *
+		 * @param tracing 	true to keep the phases of every window for writeTrace
+		 */
+		void setTracing(bool tracing);
+
+		/** endWindow
+		 *
+		 * @param thread 	the thread that ends a window
+		 * @param begin 	the first step of the window
+		 * @param steps 	the number of steps of the window
+		 * @param spikes 	the spikes of the neurons of the thread during the window
+		 * @note keeps the ticks of each phase since the last window of the thread, if tracing
+		 */
+		void endWindow(int thread, long begin, long steps, uint64_t spikes);
+
+		/** getTicks
+		 *
+		 * @param phase 	a phase
+		 * @return the ticks of the phase, summed over the threads
+		 */
+		uint64_t getTicks(ProfilePhase phase) const;
+
+		/** getCount
+		 *
+		 * @param counter 	a kind of work
+		 * @return the work, summed over the threads
+		 */
+		uint64_t getCount(ProfileCounter counter) const;
+
+		/** getTicksPerSecond
+		 * @return the frequency of the ticks, measured since the constructor
+		 */
+		double getTicksPerSecond() const;
+
+		/** write
+		 *
+		 * @param out 			receives the report as a JSON object
+		 * @param bytesWritten 	the size of the spike files
+		 */
+		void write(std::ostream& out, uint64_t bytesWritten) const;
+
+		/** writeTrace
+		 *
+		 * @param out 	receives a "begin steps spikes phases..." line for each window, the
+		 * 			spikes summed over the threads and the phases (µs) of the slowest thread
+		 */
+		void writeTrace(std::ostream& out) const;
+
+	private :
+
+		/** Window
+		 *  phases of one window of one thread
+		 */
+		struct Window
+		{
+			long begin; //!< First step
+			long steps; //!< Number of steps
+			uint64_t spikes; //!< Spikes of the neurons of the thread
+			uint64_t ticks[profilePhaseSize]; //!< Ticks of each phase
+		};
+
+		/** Slot
+		 *  what a thread adds, padded so that two threads never write the same cache line
+		 */
+		struct Slot
+		{
+			uint64_t ticks[profilePhaseSize]; //!< Ticks of each phase
+			uint64_t counters[profileCounterSize]; //!< Work of each kind
+			uint64_t windowStart[profilePhaseSize]; //!< Ticks at the end of the last window
+			std::vector<Window> trace; //!< Phases of each window, if tracing
+			char padding[64]; //!< Keeps the next slot on another cache line
+		};
+
+		std::vector<Slot> slots; //!< Slot of each thread
+		bool tracing; //!< True if the windows are kept
+		uint64_t updateTicks; //!< Ticks of the calls of Network::update
+		uint64_t startTicks; //!< Ticks at the construction
+		std::chrono::steady_clock::time_point startTime; //!< Time at the construction
+};
+
+#ifdef NEURONS_PROFILE
+#define PROFILE_TICKS() Profiler::ticks()
+#define PROFILE_LAP(profiler, thread, phase, since) (profiler).lap((thread), (phase), (since))
+#define PROFILE_COUNT(profiler, thread, counter, value) (profiler).count((thread), (counter), (value))
+#define PROFILE_UPDATE(profiler, since) (profiler).lapUpdate(since)
+#define PROFILE_WINDOW(profiler, thread, begin, steps, spikes) (profiler).endWindow((thread), (begin), (steps), (spikes))
+#else
+// Sans NEURONS_PROFILE le profiler n'est jamais appelé : la simulation ne lit pas le compteur
+#define PROFILE_TICKS() uint64_t(0)
+#define PROFILE_LAP(profiler, thread, phase, since) (since)
+#define PROFILE_COUNT(profiler, thread, counter, value) ((void)0)
+#define PROFILE_UPDATE(profiler, since) ((void)(since))
+#define PROFILE_WINDOW(profiler, thread, begin, steps, spikes) ((void)0)
+#endif
+
+#endif
@@ -0,0 +1,32 @@
+/**
+ * @file   spikeConvert.cpp
+ * @author Jonathan Haab
+ * @date   Automn, 2017
+ * @brief  Converts a binary spike file to the legacy "time \t id" text format
+ */
+
+
+#include <iostream>
+#include <string>
+#include <stdexcept>
+#include "spikeFile.hpp"
+
+
+using namespace std;
+
+int main(int argc, char* argv[])
+{
+	if(argc < 2){
+		cerr << "usage : " << argv[0] << " spikes.bin [Neurons_Spikes.txt]" << endl;
+		return 1;
+	}
+	
+	try {
+		convertToText(argv[1], argc > 2 ? argv[2] : "Neurons_Spikes.txt");
+	} catch(const runtime_error& error){
+		cerr << error.what() << endl;
+		return 1;
+	}
+	
+	return 0;
+}
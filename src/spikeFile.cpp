@@ -0,0 +1,317 @@
+/**
+ * @file   spikeFile.cpp
+ * @author Jonathan Haab
+ * @date   Automn, 2017
+ * @brief  contains all the methods of the writers and of the reader of the spike files
+ */
+
+#include "spikeFile.hpp"
+#include "spikeIndex.hpp"
+#include <algorithm>
+#include <stdexcept>
+#include <cstring>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+using namespace std;
+
+static const char spikeMagic[8] = "NSPIKES";
+static const uint32_t spikeVersion(1);
+
+/** padding
+ * @return the number of bytes to add after size bytes to reach a multiple of 8
+ */
+static size_t padding(size_t size)
+{
+	return (8 - size%8)%8;
+}
+
+/** create
+ *
+ * @param format 	the format of the file
+ * @param file 		the name of the file
+ * @param h 		the time in ms of a step
+ * @param neurons 	the number of neurons of the network
+ * @return a new writer of the file
+ * @throw std::runtime_error if the file cannot be opened
+ */
+SpikeWriter* SpikeWriter::create(SpikeFormat format, const string& file, double h, long neurons)
+{
+	if(format == BINARY) return new BinarySpikeWriter(file, h, neurons);
+	if(format == INDEXED) return new IndexedSpikeWriter(file, h, neurons);
+	return new TextSpikeWriter(file, h);
+}
+
+/** Constructor
+ *
+ * @param file 	the name of the file
+ * @param h 	the time in ms of a step
+ * @throw std::runtime_error if the file cannot be opened
+ */
+TextSpikeWriter::TextSpikeWriter(const string& file, double h)
+	: out(file), h(h)
+{
+	if(not out) throw runtime_error("cannot write the spike file '" + file + "'");
+}
+
+/** writeStep
+ *
+ * @note prints all the neurons id that spikes at a certain time
+ * 		 like this :
+ * 		 time in ms 	neuron id
+ */
+void TextSpikeWriter::writeStep(long step, const int* ids, size_t count)
+{
+	for(size_t k(0); k < count; ++k){
+		out << step*h << "\t" << ids[k] << "\n";
+	}
+}
+
+/** Constructor
+ *
+ * @param file 		the name of the file
+ * @param h 		the time in ms of a step
+ * @param neurons 	the number of neurons of the network
+ * @param chunkSteps 	the maximal number of steps of a chunk
+ * @throw std::runtime_error if the file cannot be opened
+ */
+BinarySpikeWriter::BinarySpikeWriter(const string& file, double h, long neurons, uint32_t chunkSteps)
+	: out(file, ios::binary), chunkSteps(max(chunkSteps, 1u)), position(0)
+{
+	if(not out) throw runtime_error("cannot write the spike file '" + file + "'");
+
+	SpikeFileHeader header;
+	memset(&header, 0, sizeof(header));
+	memcpy(header.magic, spikeMagic, sizeof(header.magic));
+	header.version = spikeVersion;
+	header.chunkSteps = this->chunkSteps;
+	header.h = h;
+	header.neurons = neurons;
+
+	out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+	position = sizeof(header);
+
+	chunk = SpikeChunkHeader{0, 0, 0, 0};
+	offsets.push_back(0);
+}
+
+/** Destructor
+ * @note writes the last chunk, the index and the trailer
+ */
+BinarySpikeWriter::~BinarySpikeWriter()
+{
+	flushChunk();
+
+	SpikeFileTrailer trailer;
+	memset(&trailer, 0, sizeof(trailer));
+	trailer.indexOffset = position;
+	trailer.chunkCount = chunkOffsets.size();
+	memcpy(trailer.magic, spikeMagic, sizeof(trailer.magic));
+
+	out.write(reinterpret_cast<const char*>(chunkOffsets.data()), chunkOffsets.size()*sizeof(uint64_t));
+	out.write(reinterpret_cast<const char*>(&trailer), sizeof(trailer));
+}
+
+/** writeStep
+ *
+ * @param step 	the step of the spikes, they happened at step*h,
+ * 				the steps are given in increasing order
+ * @param ids 		the neurons that spiked, in increasing order
+ * @param count 	the number of ids
+ */
+void BinarySpikeWriter::writeStep(long step, const int* ids, size_t count)
+{
+	// Les steps d'un chunk se suivent : un step qui ne suit pas le précédent commence un chunk
+	if(chunk.steps == chunkSteps or (chunk.steps > 0 and step != chunk.firstStep + chunk.steps)){
+		flushChunk();
+	}
+	if(chunk.steps == 0) chunk.firstStep = step;
+
+	// Les ids d'un step sont croissants quand les partitions sont rendues dans l'ordre
+	if(not is_sorted(ids, ids + count)){
+		sorted.assign(ids, ids + count);
+		sort(sorted.begin(), sorted.end());
+		ids = sorted.data();
+	}
+
+	int previous(-1);
+	for(size_t k(0); k < count; ++k){
+
+		// L'écart au précédent, 7 bits par octet
+		uint32_t gap(ids[k] - previous);
+		previous = ids[k];
+
+		while(gap >= 0x80){
+			payload.push_back(uint8_t(gap | 0x80));
+			gap >>= 7;
+		}
+		payload.push_back(uint8_t(gap));
+	}
+
+	counts.push_back(count);
+	offsets.push_back(payload.size());
+	chunk.steps += 1;
+	chunk.spikes += count;
+}
+
+/** flushChunk
+ * @note writes the current chunk and starts a new one
+ */
+void BinarySpikeWriter::flushChunk()
+{
+	if(chunk.steps == 0) return;
+
+	chunk.payloadBytes = payload.size();
+	payload.resize(payload.size() + padding(sizeof(chunk) + 4*counts.size() + 4*offsets.size() + payload.size()), 0);
+
+	chunkOffsets.push_back(position);
+	out.write(reinterpret_cast<const char*>(&chunk), sizeof(chunk));
+	out.write(reinterpret_cast<const char*>(counts.data()), 4*counts.size());
+	out.write(reinterpret_cast<const char*>(offsets.data()), 4*offsets.size());
+	out.write(reinterpret_cast<const char*>(payload.data()), payload.size());
+	position += sizeof(chunk) + 4*counts.size() + 4*offsets.size() + payload.size();
+
+	chunk = SpikeChunkHeader{0, 0, 0, 0};
+	counts.clear();
+	offsets.assign(1, 0);
+	payload.clear();
+}
+
+/** Constructor
+ *
+ * @param file 	the name of a binary spike file
+ * @throw std::runtime_error if the file cannot be mapped or is not a complete spike file
+ */
+SpikeReader::SpikeReader(const string& file)
+	: data(nullptr), size(0), header(nullptr), chunkOffsets(nullptr), chunks(0)
+{
+	int descriptor(open(file.c_str(), O_RDONLY));
+	if(descriptor < 0) throw runtime_error("cannot read the spike file '" + file + "'");
+
+	struct stat status;
+	if(fstat(descriptor, &status) == 0) size = status.st_size;
+
+	if(size >= sizeof(SpikeFileHeader) + sizeof(SpikeFileTrailer)){
+		void* mapped(mmap(nullptr, size, PROT_READ, MAP_SHARED, descriptor, 0));
+		if(mapped != MAP_FAILED) data = static_cast<const uint8_t*>(mapped);
+	}
+	close(descriptor);
+
+	if(data == nullptr) throw runtime_error("'" + file + "' is not a spike file");
+
+	header = reinterpret_cast<const SpikeFileHeader*>(data);
+	const SpikeFileTrailer* trailer(reinterpret_cast<const SpikeFileTrailer*>(data + size - sizeof(SpikeFileTrailer)));
+
+	if(memcmp(header->magic, spikeMagic, sizeof(spikeMagic)) != 0 or header->version != spikeVersion
+	   or memcmp(trailer->magic, spikeMagic, sizeof(spikeMagic)) != 0
+	   or trailer->indexOffset + trailer->chunkCount*sizeof(uint64_t) + sizeof(SpikeFileTrailer) != size){
+		munmap(const_cast<uint8_t*>(data), size);
+		throw runtime_error("'" + file + "' is not a complete spike file");
+	}
+
+	chunkOffsets = reinterpret_cast<const uint64_t*>(data + trailer->indexOffset);
+	chunks = trailer->chunkCount;
+}
+
+/** Destructor
+ * @note unmaps the file
+ */
+SpikeReader::~SpikeReader()
+{
+	munmap(const_cast<uint8_t*>(data), size);
+}
+
+/** getH
+ * @return the time in ms of a step
+ */
+double SpikeReader::getH() const
+{
+	return header->h;
+}
+
+/** getNeurons
+ * @return the number of neurons of the network
+ */
+long SpikeReader::getNeurons() const
+{
+	return header->neurons;
+}
+
+/** chunkCount
+ * @return the number of chunks of the file
+ */
+size_t SpikeReader::chunkCount() const
+{
+	return chunks;
+}
+
+/** chunk
+ *
+ * @param c 	the index of the chunk
+ * @return a view of the chunk
+ */
+SpikeReader::Chunk SpikeReader::chunk(size_t c) const
+{
+	const uint8_t* position(data + chunkOffsets[c]);
+	const SpikeChunkHeader* chunkHeader(reinterpret_cast<const SpikeChunkHeader*>(position));
+
+	Chunk view;
+	view.firstStep = chunkHeader->firstStep;
+	view.steps = chunkHeader->steps;
+	view.spikes = chunkHeader->spikes;
+	view.counts = reinterpret_cast<const uint32_t*>(position + sizeof(SpikeChunkHeader));
+	view.offsets = view.counts + view.steps;
+	view.payload = reinterpret_cast<const uint8_t*>(view.offsets + view.steps + 1);
+	return view;
+}
+
+/** readStep
+ *
+ * @param chunk 	a chunk of the file
+ * @param s 		a step of the chunk, from 0 to chunk.steps-1
+ * @param ids 		receives the ids of the neurons that spiked at chunk.firstStep+s
+ */
+void SpikeReader::readStep(const Chunk& chunk, uint32_t s, vector<int>& ids)
+{
+	ids.resize(chunk.counts[s]);
+
+	const uint8_t* byte(chunk.payload + chunk.offsets[s]);
+	int previous(-1);
+
+	for(size_t k(0); k < ids.size(); ++k){
+
+		uint32_t gap(0);
+		for(int shift(0); ; shift += 7){
+			gap |= uint32_t(*byte & 0x7f) << shift;
+			if(not (*byte++ & 0x80)) break;
+		}
+
+		previous += gap;
+		ids[k] = previous;
+	}
+}
+
+/** convertToText
+ *
+ * @param binary 	the name of a binary spike file
+ * @param text 	the name of the text file written, in the legacy "time \t id" format
+ * @throw std::runtime_error if one of the files cannot be opened
+ */
+void convertToText(const string& binary, const string& text)
+{
+	SpikeReader reader(binary);
+	TextSpikeWriter writer(text, reader.getH());
+	vector<int> ids;
+
+	for(size_t c(0); c < reader.chunkCount(); ++c){
+
+		SpikeReader::Chunk chunk(reader.chunk(c));
+
+		for(uint32_t s(0); s < chunk.steps; ++s){
+			SpikeReader::readStep(chunk, s, ids);
+			writer.writeStep(chunk.firstStep + s, ids.data(), ids.size());
+		}
+	}
+}
@@ -0,0 +1,235 @@
+/**
+ * @file   spikeFile.hpp
+ * @author Jonathan Haab
+ * @date   Automn, 2017
+ * @brief  writers and reader of the spike files, in the legacy text format
+ * 		   or in the binary chunked format
+ */
+
+#include <string>
+#include <vector>
+#include <fstream>
+#include <cstdint>
+#include <cstddef>
+#include "parameters.hpp"
+
+#ifndef SPIKEFILE_H
+#define SPIKEFILE_H
+
+/** Binary spike file
+ *
+ *  every integer is little-endian, every block starts at a multiple of 8 bytes
+ *
+ *  SpikeFileHeader
+ *  chunks, each of them :
+ *  	SpikeChunkHeader
+ *  	uint32_t counts[steps] 		number of spikes of each step
+ *  	uint32_t offsets[steps+1] 	start of each step in the payload, in bytes
+ *  	uint8_t payload[payloadBytes] 	ids of each step, increasing, as varints of
+ *  								the gap to the previous id (id+1 for the first one)
+ *  uint64_t chunkOffsets[chunkCount] 	position of each chunk in the file
+ *  SpikeFileTrailer
+ *
+ *  the spikes of step s happened at the time s*h
+ */
+struct SpikeFileHeader
+{
+	char magic[8]; //!< "NSPIKES" and a 0
+	uint32_t version; //!< Version of the format
+	uint32_t chunkSteps; //!< Maximal number of steps of a chunk
+	double h; //!< Time in ms of a step
+	uint64_t neurons; //!< Number of neurons of the network
+	uint64_t reserved[4];
+};
+
+struct SpikeChunkHeader
+{
+	int64_t firstStep; //!< Step of the first step of the chunk, the steps are consecutive
+	uint32_t steps; //!< Number of steps of the chunk
+	uint32_t spikes; //!< Number of spikes of the chunk
+	uint64_t payloadBytes; //!< Size of the encoded ids
+};
+
+struct SpikeFileTrailer
+{
+	uint64_t indexOffset; //!< Position of chunkOffsets in the file
+	uint64_t chunkCount; //!< Number of chunks
+	char magic[8]; //!< "NSPIKES" and a 0, the file is complete
+};
+
+/** SpikeWriter
+ *  receives the spikes of the network step after step
+ */
+class SpikeWriter
+{
+	public :
+
+		/** Destructor
+		 * @note the file is complete once the writer is destroyed
+		 */
+		virtual ~SpikeWriter() {}
+
+		/** writeStep
+		 *
+		 * @param step 	the step of the spikes, they happened at step*h,
+		 * 				the steps are given in increasing order
+		 * @param ids 		the neurons that spiked, in increasing order
+		 * @param count 	the number of ids
+		 */
+		virtual void writeStep(long step, const int* ids, size_t count) = 0;
+
+		/** create
+		 *
+		 * @param format 	the format of the file
+		 * @param file 		the name of the file
+		 * @param h 		the time in ms of a step
+		 * @param neurons 	the number of neurons of the network
+		 * @return a new writer of the file
+		 * @throw std::runtime_error if the file cannot be opened
+		 */
+		static SpikeWriter* create(SpikeFormat format, const std::string& file, double h, long neurons);
+};
+
+/** TextSpikeWriter
+ *  writes one "time \t id" line per spike
+ */
+class TextSpikeWriter : public SpikeWriter
+{
+	public :
+
+		TextSpikeWriter(const std::string& file, double h);
+
+		void writeStep(long step, const int* ids, size_t count) override;
+
+	private :
+
+		std::ofstream out; //!< Flow that connect to the data file
+		double h; //!< Time in ms of a step
+};
+
+/** BinarySpikeWriter
+ *  writes the binary chunked format, one chunk at a time
+ */
+class BinarySpikeWriter : public SpikeWriter
+{
+	public :
+
+		/** Constructor
+		 *
+		 * @param file 		the name of the file
+		 * @param h 		the time in ms of a step
+		 * @param neurons 	the number of neurons of the network
+		 * @param chunkSteps 	the maximal number of steps of a chunk
+		 * @throw std::runtime_error if the file cannot be opened
+		 */
+		BinarySpikeWriter(const std::string& file, double h, long neurons, uint32_t chunkSteps = 1024);
+
+		/** Destructor
+		 * @note writes the last chunk, the index and the trailer
+		 */
+		~BinarySpikeWriter();
+
+		void writeStep(long step, const int* ids, size_t count) override;
+
+	private :
+
+		/** flushChunk
+		 * @note writes the current chunk and starts a new one
+		 */
+		void flushChunk();
+
+		std::ofstream out; //!< Flow that connect to the data file
+		uint32_t chunkSteps; //!< Maximal number of steps of a chunk
+		uint64_t position; //!< Bytes written in the file
+		std::vector<uint64_t> chunkOffsets; //!< Position of each written chunk
+
+		SpikeChunkHeader chunk; //!< Header of the current chunk
+		std::vector<uint32_t> counts; //!< Columns of the current chunk
+		std::vector<uint32_t> offsets;
+		std::vector<uint8_t> payload;
+		std::vector<int> sorted; //!< Copy of the ids of a step given out of order
+};
+
+/** SpikeReader
+ *  maps a binary spike file in memory, nothing is copied
+ */
+class SpikeReader
+{
+	public :
+
+		/** Chunk
+		 *  view of one chunk of the mapped file
+		 */
+		struct Chunk
+		{
+			long firstStep; //!< Step of the first step of the chunk
+			uint32_t steps; //!< Number of steps
+			uint32_t spikes; //!< Number of spikes
+			const uint32_t* counts; //!< Number of spikes of each step
+			const uint32_t* offsets; //!< Start of each step in the payload
+			const uint8_t* payload; //!< Encoded ids
+		};
+
+		/** Constructor
+		 *
+		 * @param file 	the name of a binary spike file
+		 * @throw std::runtime_error if the file cannot be mapped or is not a complete spike file
+		 */
+		explicit SpikeReader(const std::string& file);
+
+		/** Destructor
+		 * @note unmaps the file
+		 */
+		~SpikeReader();
+
+		SpikeReader(const SpikeReader&) = delete;
+		SpikeReader& operator=(const SpikeReader&) = delete;
+
+		/** getH
+		 * @return the time in ms of a step
+		 */
+		double getH() const;
+
+		/** getNeurons
+		 * @return the number of neurons of the network
+		 */
+		long getNeurons() const;
+
+		/** chunkCount
+		 * @return the number of chunks of the file
+		 */
+		size_t chunkCount() const;
+
+		/** chunk
+		 *
+		 * @param c 	the index of the chunk
+		 * @return a view of the chunk
+		 */
+		Chunk chunk(size_t c) const;
+
+		/** readStep
+		 *
+		 * @param chunk 	a chunk of the file
+		 * @param s 		a step of the chunk, from 0 to chunk.steps-1
+		 * @param ids 		receives the ids of the neurons that spiked at chunk.firstStep+s
+		 */
+		static void readStep(const Chunk& chunk, uint32_t s, std::vector<int>& ids);
+
+	private :
+
+		const uint8_t* data; //!< The mapped file
+		size_t size; //!< Size of the file
+		const SpikeFileHeader* header;
+		const uint64_t* chunkOffsets; //!< Position of each chunk
+		size_t chunks; //!< Number of chunks
+};
+
+/** convertToText
+ *
+ * @param binary 	the name of a binary spike file
+ * @param text 	the name of the text file written, in the legacy "time \t id" format
+ * @throw std::runtime_error if one of the files cannot be opened
+ */
+void convertToText(const std::string& binary, const std::string& text);
+
+#endif
@@ -0,0 +1,343 @@
+/**
+ * @file   spikeIndex.cpp
+ * @author Jonathan Haab
+ * @date   Automn, 2017
+ * @brief  contains all the methods of the writer and of the queries of the indexed spike files
+ */
+
+#include "spikeIndex.hpp"
+#include <algorithm>
+#include <stdexcept>
+#include <cstring>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+using namespace std;
+
+static const char indexMagic[8] = "NSPKIDX";
+static const uint32_t indexVersion(1);
+
+/** Constructor
+ *
+ * @param file 		the name of the file
+ * @param h 		the time in ms of a step
+ * @param neurons 	the number of neurons of the network
+ * @param bucketSteps 	the number of steps of a bucket, at most 65536
+ * @throw std::runtime_error if the file cannot be opened
+ */
+IndexedSpikeWriter::IndexedSpikeWriter(const string& file, double h, long neurons, uint32_t bucketSteps)
+	: out(file, ios::binary), bucketSteps(min(max(bucketSteps, 1u), 65536u)), neurons(neurons), position(0), spikes(0), firstStep(-1)
+{
+	if(not out) throw runtime_error("cannot write the spike file '" + file + "'");
+
+	SpikeIndexHeader header;
+	memset(&header, 0, sizeof(header));
+	memcpy(header.magic, indexMagic, sizeof(header.magic));
+	header.version = indexVersion;
+	header.bucketSteps = this->bucketSteps;
+	header.h = h;
+	header.neurons = neurons;
+
+	out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+	position = sizeof(header);
+}
+
+/** Destructor
+ * @note writes the last bucket, the index and the trailer
+ */
+IndexedSpikeWriter::~IndexedSpikeWriter()
+{
+	flushBucket();
+
+	SpikeIndexTrailer trailer;
+	memset(&trailer, 0, sizeof(trailer));
+	trailer.indexOffset = position;
+	trailer.bucketCount = buckets.size();
+	trailer.spikes = spikes;
+	memcpy(trailer.magic, indexMagic, sizeof(trailer.magic));
+
+	out.write(reinterpret_cast<const char*>(buckets.data()), buckets.size()*sizeof(SpikeBucketEntry));
+	out.write(reinterpret_cast<const char*>(&trailer), sizeof(trailer));
+}
+
+/** writeStep
+ *
+ * @param step 	the step of the spikes, they happened at step*h,
+ * 				the steps are given in increasing order
+ * @param ids 		the neurons that spiked
+ * @param count 	the number of ids
+ */
+void IndexedSpikeWriter::writeStep(long step, const int* ids, size_t count)
+{
+	// Les buckets sont alignés sur les multiples de bucketSteps : un step d'un autre bucket écrit le courant
+	long bucketStart(step - step%bucketSteps);
+	if(bucketStart != firstStep){
+		flushBucket();
+		firstStep = bucketStart;
+	}
+
+	this->ids.insert(this->ids.end(), ids, ids + count);
+	steps.insert(steps.end(), count, uint16_t(step - firstStep));
+}
+
+/** flushBucket
+ * @note sorts the spikes of the current bucket by neuron and writes them
+ */
+void IndexedSpikeWriter::flushBucket()
+{
+	if(ids.empty()) return;
+
+	// Tri par dénombrement : les spikes d'un neurone restent dans l'ordre des steps
+	offsets.assign(neurons + 1, 0);
+	for(size_t k(0); k < ids.size(); ++k) offsets[ids[k] + 1] += 1;
+	for(long i(0); i < neurons; ++i) offsets[i+1] += offsets[i];
+
+	sorted.resize(ids.size());
+	for(size_t k(0); k < ids.size(); ++k) sorted[offsets[ids[k]]++] = steps[k];
+
+	// Chaque curseur est arrivé au début du neurone suivant : les débuts sont décalés d'un neurone
+	copy_backward(offsets.begin(), offsets.end() - 1, offsets.end());
+	offsets[0] = 0;
+
+	SpikeBucketHeader bucket = {firstStep, ids.size()};
+	size_t bytes(sizeof(bucket) + offsets.size()*sizeof(uint64_t) + sorted.size()*sizeof(uint16_t));
+	sorted.resize(sorted.size() + (8 - bytes%8)%8/sizeof(uint16_t), 0);
+
+	buckets.push_back(SpikeBucketEntry{firstStep, position});
+	out.write(reinterpret_cast<const char*>(&bucket), sizeof(bucket));
+	out.write(reinterpret_cast<const char*>(offsets.data()), offsets.size()*sizeof(uint64_t));
+	out.write(reinterpret_cast<const char*>(sorted.data()), sorted.size()*sizeof(uint16_t));
+	position += sizeof(bucket) + offsets.size()*sizeof(uint64_t) + sorted.size()*sizeof(uint16_t);
+	spikes += ids.size();
+
+	ids.clear();
+	steps.clear();
+}
+
+/** Constructor
+ *
+ * @param file 	the name of an indexed spike file
+ * @throw std::runtime_error if the file cannot be mapped or is not a complete indexed spike file
+ */
+SpikeIndex::SpikeIndex(const string& file)
+	: data(nullptr), size(0), header(nullptr), trailer(nullptr), entries(nullptr)
+{
+	int descriptor(open(file.c_str(), O_RDONLY));
+	if(descriptor < 0) throw runtime_error("cannot read the spike file '" + file + "'");
+
+	struct stat status;
+	if(fstat(descriptor, &status) == 0) size = status.st_size;
+
+	if(size >= sizeof(SpikeIndexHeader) + sizeof(SpikeIndexTrailer)){
+		void* mapped(mmap(nullptr, size, PROT_READ, MAP_SHARED, descriptor, 0));
+		if(mapped != MAP_FAILED) data = static_cast<const uint8_t*>(mapped);
+	}
+	close(descriptor);
+
+	if(data == nullptr) throw runtime_error("'" + file + "' is not an indexed spike file");
+
+	header = reinterpret_cast<const SpikeIndexHeader*>(data);
+	trailer = reinterpret_cast<const SpikeIndexTrailer*>(data + size - sizeof(SpikeIndexTrailer));
+
+	if(memcmp(header->magic, indexMagic, sizeof(indexMagic)) != 0 or header->version != indexVersion
+	   or memcmp(trailer->magic, indexMagic, sizeof(indexMagic)) != 0
+	   or trailer->indexOffset + trailer->bucketCount*sizeof(SpikeBucketEntry) + sizeof(SpikeIndexTrailer) != size){
+		munmap(const_cast<uint8_t*>(data), size);
+		throw runtime_error("'" + file + "' is not a complete indexed spike file");
+	}
+
+	entries = reinterpret_cast<const SpikeBucketEntry*>(data + trailer->indexOffset);
+}
+
+/** Destructor
+ * @note unmaps the file
+ */
+SpikeIndex::~SpikeIndex()
+{
+	munmap(const_cast<uint8_t*>(data), size);
+}
+
+/** getH
+ * @return the time in ms of a step
+ */
+double SpikeIndex::getH() const
+{
+	return header->h;
+}
+
+/** getNeurons
+ * @return the number of neurons of the network
+ */
+long SpikeIndex::getNeurons() const
+{
+	return header->neurons;
+}
+
+/** getBucketSteps
+ * @return the number of steps of a bucket
+ */
+long SpikeIndex::getBucketSteps() const
+{
+	return header->bucketSteps;
+}
+
+/** bucketCount
+ * @return the number of buckets of the file
+ */
+size_t SpikeIndex::bucketCount() const
+{
+	return trailer->bucketCount;
+}
+
+/** spikeCount
+ * @return the number of spikes of the file
+ */
+uint64_t SpikeIndex::spikeCount() const
+{
+	return trailer->spikes;
+}
+
+/** firstStep
+ * @return the first step of the first bucket, 0 without any spike
+ */
+long SpikeIndex::firstStep() const
+{
+	return bucketCount() > 0 ? entries[0].firstStep : 0;
+}
+
+/** endStep
+ * @return the step after the last bucket, 0 without any spike
+ */
+long SpikeIndex::endStep() const
+{
+	return bucketCount() > 0 ? entries[bucketCount() - 1].firstStep + getBucketSteps() : 0;
+}
+
+/** bucket
+ *
+ * @param b 	the index of the bucket
+ * @return a view of the bucket
+ */
+SpikeIndex::Bucket SpikeIndex::bucket(size_t b) const
+{
+	const uint8_t* position(data + entries[b].offset);
+
+	Bucket view;
+	view.firstStep = reinterpret_cast<const SpikeBucketHeader*>(position)->firstStep;
+	view.offsets = reinterpret_cast<const uint64_t*>(position + sizeof(SpikeBucketHeader));
+	view.steps = reinterpret_cast<const uint16_t*>(view.offsets + header->neurons + 1);
+	return view;
+}
+
+/** firstBucket
+ *
+ * @param step 	a step
+ * @return the first bucket that ends after step
+ */
+size_t SpikeIndex::firstBucket(long step) const
+{
+	long bucketSteps(getBucketSteps());
+	return partition_point(entries, entries + bucketCount(), [&](const SpikeBucketEntry& entry){
+		return entry.firstStep + bucketSteps <= step;
+	}) - entries;
+}
+
+/** spikes
+ *
+ * @param first 	the first neuron
+ * @param last 		the neuron after the last one
+ * @param from 		the first step
+ * @param to 		the step after the last one
+ * @param out 		receives the spikes of the neurons [first, last) in the steps
+ * 					[from, to), in increasing steps and ids like the spike files
+ * @note the neurons outside the network are ignored
+ */
+void SpikeIndex::spikes(int first, int last, long from, long to, vector<SpikeEvent>& out) const
+{
+	first = max(first, 0);
+	last = int(min(long(last), getNeurons()));
+	long bucketSteps(getBucketSteps());
+
+	for(size_t b(firstBucket(from)); first < last and b < bucketCount() and entries[b].firstStep < to; ++b){
+
+		Bucket view(bucket(b));
+		long low(max(from - view.firstStep, 0L)), high(min(to - view.firstStep, bucketSteps));
+		size_t begin(out.size());
+
+		// Seuls les offsets de nos neurones et leurs spikes, contigus, sont lus
+		for(int i(first); i < last; ++i){
+
+			const uint16_t* step(view.steps + view.offsets[i]);
+			const uint16_t* end(view.steps + view.offsets[i+1]);
+
+			if(low > 0 or high < bucketSteps){
+				step = lower_bound(step, end, low);
+				end = lower_bound(step, end, high);
+			}
+			for(; step != end; ++step) out.push_back(SpikeEvent{view.firstStep + *step, i});
+		}
+
+		// Rangés par neurone dans le bucket : le tri stable par step garde les ids croissants
+		stable_sort(out.begin() + begin, out.end(), [](const SpikeEvent& a, const SpikeEvent& b){ return a.step < b.step; });
+	}
+}
+
+/** counts
+ *
+ * @param first 	the first neuron
+ * @param last 		the neuron after the last one
+ * @param from 		the first step
+ * @param to 		the step after the last one
+ * @param out 		receives the number of spikes of each neuron of [first, last)
+ * 					in the steps [from, to), the neuron first at 0
+ * @note the buckets inside the window are counted with their offsets alone
+ */
+void SpikeIndex::counts(int first, int last, long from, long to, vector<uint64_t>& out) const
+{
+	out.assign(max(last - first, 0), 0);
+
+	int begin(max(first, 0));
+	int end(int(min(long(last), getNeurons())));
+	long bucketSteps(getBucketSteps());
+
+	for(size_t b(firstBucket(from)); begin < end and b < bucketCount() and entries[b].firstStep < to; ++b){
+
+		Bucket view(bucket(b));
+		long low(max(from - view.firstStep, 0L)), high(min(to - view.firstStep, bucketSteps));
+
+		for(int i(begin); i < end; ++i){
+			if(low > 0 or high < bucketSteps){
+				const uint16_t* step(lower_bound(view.steps + view.offsets[i], view.steps + view.offsets[i+1], low));
+				out[i - first] += lower_bound(step, view.steps + view.offsets[i+1], high) - step;
+			} else {
+				out[i - first] += view.offsets[i+1] - view.offsets[i];
+			}
+		}
+	}
+}
+
+/** indexSpikes
+ *
+ * @param binary 		the name of a binary spike file
+ * @param index 		the name of the indexed spike file written
+ * @param bucketSteps 	the number of steps of a bucket, at most 65536
+ * @throw std::runtime_error if one of the files cannot be opened
+ */
+void indexSpikes(const string& binary, const string& index, uint32_t bucketSteps)
+{
+	SpikeReader reader(binary);
+	IndexedSpikeWriter writer(index, reader.getH(), reader.getNeurons(), bucketSteps);
+	vector<int> ids;
+
+	for(size_t c(0); c < reader.chunkCount(); ++c){
+
+		SpikeReader::Chunk chunk(reader.chunk(c));
+
+		for(uint32_t s(0); s < chunk.steps; ++s){
+			SpikeReader::readStep(chunk, s, ids);
+			writer.writeStep(chunk.firstStep + s, ids.data(), ids.size());
+		}
+	}
+}
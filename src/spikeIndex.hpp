@@ -0,0 +1,243 @@
+/**
+ * @file   spikeIndex.hpp
+ * @author Jonathan Haab
+ * @date   Automn, 2017
+ * @brief  spike store indexed by time bucket and by neuron, for the queries
+ * 		   of a range of neurons in a time window
+ */
+
+#include <string>
+#include <vector>
+#include <fstream>
+#include <cstdint>
+#include <cstddef>
+#include "spikeFile.hpp"
+
+#ifndef SPIKEINDEX_H
+#define SPIKEINDEX_H
+
+/** Indexed spike file
+ *
+ *  every integer is little-endian, every block starts at a multiple of 8 bytes
+ *
+ *  SpikeIndexHeader
+ *  buckets of bucketSteps steps, only those with a spike, each of them :
+ *  	SpikeBucketHeader
+ *  	uint64_t neuronOffsets[neurons+1] 	start of the spikes of each neuron in steps
+ *  	uint16_t steps[spikes] 			steps of the spikes minus firstStep, neuron after
+ *  									neuron, increasing for each neuron
+ *  SpikeBucketEntry buckets[bucketCount] 	first step and position of each bucket
+ *  SpikeIndexTrailer
+ *
+ *  the spikes of the neurons [a, b) in a bucket follow each other : a query
+ *  only reads the offsets of a and b and these spikes in each bucket of its window
+ */
+struct SpikeIndexHeader
+{
+	char magic[8]; //!< "NSPKIDX" and a 0
+	uint32_t version; //!< Version of the format
+	uint32_t bucketSteps; //!< Number of steps of a bucket, at most 65536
+	double h; //!< Time in ms of a step
+	uint64_t neurons; //!< Number of neurons of the network
+	uint64_t reserved[4];
+};
+
+struct SpikeBucketHeader
+{
+	int64_t firstStep; //!< First step of the bucket, a multiple of bucketSteps
+	uint64_t spikes; //!< Number of spikes of the bucket
+};
+
+struct SpikeBucketEntry
+{
+	int64_t firstStep; //!< First step of the bucket
+	uint64_t offset; //!< Position of the bucket in the file
+};
+
+struct SpikeIndexTrailer
+{
+	uint64_t indexOffset; //!< Position of the bucket entries in the file
+	uint64_t bucketCount; //!< Number of buckets
+	uint64_t spikes; //!< Number of spikes of the file
+	char magic[8]; //!< "NSPKIDX" and a 0, the file is complete
+};
+
+/** IndexedSpikeWriter
+ *  keeps the spikes of one bucket, then writes them neuron after neuron
+ */
+class IndexedSpikeWriter : public SpikeWriter
+{
+	public :
+
+		/** Constructor
+		 *
+		 * @param file 		the name of the file
+		 * @param h 		the time in ms of a step
+		 * @param neurons 	the number of neurons of the network
+		 * @param bucketSteps 	the number of steps of a bucket, at most 65536
+		 * @throw std::runtime_error if the file cannot be opened
+		 */
+		IndexedSpikeWriter(const std::string& file, double h, long neurons, uint32_t bucketSteps = 4096);
+
+		/** Destructor
+		 * @note writes the last bucket, the index and the trailer
+		 */
+		~IndexedSpikeWriter();
+
+		void writeStep(long step, const int* ids, size_t count) override;
+
+	private :
+
+		/** flushBucket
+		 * @note sorts the spikes of the current bucket by neuron and writes them
+		 */
+		void flushBucket();
+
+		std::ofstream out; //!< Flow that connect to the data file
+		uint32_t bucketSteps; //!< Number of steps of a bucket
+		long neurons; //!< Number of neurons
+		uint64_t position; //!< Bytes written in the file
+		uint64_t spikes; //!< Spikes written in the file
+		std::vector<SpikeBucketEntry> buckets; //!< First step and position of each written bucket
+
+		long firstStep; //!< First step of the current bucket
+		std::vector<int> ids; //!< Neurons of the spikes of the current bucket, step after step
+		std::vector<uint16_t> steps; //!< Step of each of them, minus firstStep
+		std::vector<uint64_t> offsets; //!< Start of the spikes of each neuron, once they are sorted
+		std::vector<uint16_t> sorted; //!< Steps of the bucket, neuron after neuron
+};
+
+/** SpikeEvent
+ *  one spike given by a query
+ */
+struct SpikeEvent
+{
+	long step; //!< Step of the spike, it happened at step*h
+	int id; //!< Neuron that spiked
+};
+
+/** SpikeIndex
+ *  maps an indexed spike file in memory : a query only reads the pages of
+ *  its neurons in the buckets of its window, nothing else is copied
+ */
+class SpikeIndex
+{
+	public :
+
+		/** Constructor
+		 *
+		 * @param file 	the name of an indexed spike file
+		 * @throw std::runtime_error if the file cannot be mapped or is not a complete indexed spike file
+		 */
+		explicit SpikeIndex(const std::string& file);
+
+		/** Destructor
+		 * @note unmaps the file
+		 */
+		~SpikeIndex();
+
+		SpikeIndex(const SpikeIndex&) = delete;
+		SpikeIndex& operator=(const SpikeIndex&) = delete;
+
+		/** getH
+		 * @return the time in ms of a step
+		 */
+		double getH() const;
+
+		/** getNeurons
+		 * @return the number of neurons of the network
+		 */
+		long getNeurons() const;
+
+		/** getBucketSteps
+		 * @return the number of steps of a bucket
+		 */
+		long getBucketSteps() const;
+
+		/** bucketCount
+		 * @return the number of buckets of the file
+		 */
+		size_t bucketCount() const;
+
+		/** spikeCount
+		 * @return the number of spikes of the file
+		 */
+		uint64_t spikeCount() const;
+
+		/** firstStep
+		 * @return the first step of the first bucket, 0 without any spike
+		 */
+		long firstStep() const;
+
+		/** endStep
+		 * @return the step after the last bucket, 0 without any spike
+		 */
+		long endStep() const;
+
+		/** spikes
+		 *
+		 * @param first 	the first neuron
+		 * @param last 		the neuron after the last one
+		 * @param from 		the first step
+		 * @param to 		the step after the last one
+		 * @param out 		receives the spikes of the neurons [first, last) in the steps
+		 * 					[from, to), in increasing steps and ids like the spike files
+		 * @note the neurons outside the network are ignored
+		 */
+		void spikes(int first, int last, long from, long to, std::vector<SpikeEvent>& out) const;
+
+		/** counts
+		 *
+		 * @param first 	the first neuron
+		 * @param last 		the neuron after the last one
+		 * @param from 		the first step
+		 * @param to 		the step after the last one
+		 * @param out 		receives the number of spikes of each neuron of [first, last)
+		 * 					in the steps [from, to), the neuron first at 0
+		 * @note the buckets inside the window are counted with their offsets alone
+		 */
+		void counts(int first, int last, long from, long to, std::vector<uint64_t>& out) const;
+
+	private :
+
+		/** Bucket
+		 *  view of one bucket of the mapped file
+		 */
+		struct Bucket
+		{
+			long firstStep; //!< First step of the bucket
+			const uint64_t* offsets; //!< Start of the spikes of each neuron
+			const uint16_t* steps; //!< Steps of the spikes minus firstStep
+		};
+
+		/** bucket
+		 *
+		 * @param b 	the index of the bucket
+		 * @return a view of the bucket
+		 */
+		Bucket bucket(size_t b) const;
+
+		/** firstBucket
+		 *
+		 * @param step 	a step
+		 * @return the first bucket that ends after step
+		 */
+		size_t firstBucket(long step) const;
+
+		const uint8_t* data; //!< The mapped file
+		size_t size; //!< Size of the file
+		const SpikeIndexHeader* header;
+		const SpikeIndexTrailer* trailer;
+		const SpikeBucketEntry* entries; //!< First step and position of each bucket
+};
+
+/** indexSpikes
+ *
+ * @param binary 		the name of a binary spike file
+ * @param index 		the name of the indexed spike file written
+ * @param bucketSteps 	the number of steps of a bucket, at most 65536
+ * @throw std::runtime_error if one of the files cannot be opened
+ */
+void indexSpikes(const std::string& binary, const std::string& index, uint32_t bucketSteps = 4096);
+
+#endif
@@ -0,0 +1,76 @@
+/**
+ * @file   spikeQuery.cpp
+ * @author Jonathan Haab
+ * @date   Automn, 2017
+ * @brief  Indexes a binary spike file, then gives the spikes or the spike counts
+ * 		   of a range of neurons in a time window
+ */
+
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <cmath>
+#include <cstdlib>
+#include <stdexcept>
+#include "spikeIndex.hpp"
+
+
+using namespace std;
+
+/** stepAt
+ *
+ * @param time 	a time in ms
+ * @param h 	the time in ms of a step
+ * @return the first step at or after time
+ */
+static long stepAt(double time, double h)
+{
+	return long(ceil(time/h - 1e-6));
+}
+
+int main(int argc, char* argv[])
+{
+	string command(argc > 1 ? argv[1] : "");
+
+	if(not ((command == "index" and argc >= 4) or ((command == "spikes" or command == "counts") and argc >= 5))){
+		cerr << "usage : " << argv[0] << " index spikes.bin spikes.idx [bucketSteps]" << endl;
+		cerr << "        " << argv[0] << " spikes spikes.idx first last [from to]" << endl;
+		cerr << "        " << argv[0] << " counts spikes.idx first last [from to]" << endl;
+		cerr << "the neurons [first, last) in the times [from, to) in ms, every time by default" << endl;
+		return 1;
+	}
+
+	try {
+		if(command == "index"){
+			indexSpikes(argv[2], argv[3], argc > 4 ? atoi(argv[4]) : 4096);
+			return 0;
+		}
+
+		SpikeIndex index(argv[2]);
+		int first(atoi(argv[3]));
+		int last(atoi(argv[4]));
+		long from(argc > 5 ? stepAt(atof(argv[5]), index.getH()) : index.firstStep());
+		long to(argc > 6 ? stepAt(atof(argv[6]), index.getH()) : index.endStep());
+
+		if(command == "spikes"){
+			// Les lignes du fichier texte : « time \t id »
+			vector<SpikeEvent> spikes;
+			index.spikes(first, last, from, to, spikes);
+			for(size_t k(0); k < spikes.size(); ++k){
+				cout << spikes[k].step*index.getH() << "\t" << spikes[k].id << "\n";
+			}
+		} else {
+			vector<uint64_t> counts;
+			index.counts(first, last, from, to, counts);
+			for(size_t k(0); k < counts.size(); ++k){
+				cout << first + long(k) << "\t" << counts[k] << "\n";
+			}
+		}
+	} catch(const runtime_error& error){
+		cerr << error.what() << endl;
+		return 1;
+	}
+
+	return 0;
+}
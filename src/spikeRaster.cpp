@@ -0,0 +1,251 @@
+/**
+ * @file   spikeRaster.cpp
+ * @author Jonathan Haab
+ * @date   Automn, 2017
+ * @brief  contains all the methods of the spike raster
+ */
+
+#include "spikeRaster.hpp"
+#include <algorithm>
+
+using namespace std;
+
+/** grow
+ *
+ * @param ring 		values counted from the first one, the value k is at k%ring.size()
+ * @param first 	the first value kept
+ * @param last 		the value after the last one
+ * @param capacity 	the new size of the ring, at least last-first
+ */
+template<typename T>
+static void grow(vector<T>& ring, size_t first, size_t last, size_t capacity)
+{
+	vector<T> larger(capacity);
+	for(size_t k(first); k < last; ++k){
+		larger[k%capacity] = ring[k%ring.size()];
+	}
+	ring.swap(larger);
+}
+
+/** Constructor
+ *
+ * @param neurons 		the number of neurons
+ * @param retention 	the number of steps kept before the last appended one,
+ * 					0 keeps every spike
+ * @param refractory 	the steps after a spike during which a neuron does not
+ * 					spike again, it bounds the spikes kept in the retention
+ */
+SpikeRaster::SpikeRaster(int neurons, long retention, long refractory)
+	: neurons(neurons), retention(retention), refractory(refractory)
+{
+	setLogs(1);
+}
+
+/** setLogs
+ *
+ * @param count 	the number of logs that can be appended at the same time
+ * @note the spikes already appended are merged in the first log
+ */
+void SpikeRaster::setLogs(int count)
+{
+	// Chaque step est repris dans l'ordre : les spikes fusionnés précèdent tous ceux ajoutés ensuite
+	struct Record
+	{
+		long step;
+		const Log* log;
+		size_t r;
+	};
+	vector<Record> records;
+
+	for(size_t l(0); l < logs.size(); ++l){
+		for(size_t r(logs[l].head); r < logs[l].tail; ++r){
+			Record record = {logs[l].steps[r%logs[l].steps.size()], &logs[l], r};
+			records.push_back(record);
+		}
+	}
+	stable_sort(records.begin(), records.end(), [](const Record& a, const Record& b){ return a.step < b.step; });
+
+	// Les partitions ont le même nombre de neurones à un près
+	vector<Log> merged(max(count, 1));
+	for(size_t l(0); l < merged.size(); ++l){
+		allocate(merged[l], (neurons + merged.size() - 1)/merged.size());
+	}
+
+	vector<int> ids;
+	for(size_t k(0); k < records.size(); ++k){
+
+		const Log& log(*records[k].log);
+		size_t r(records[k].r);
+		size_t first(r == log.head ? log.idsHead : log.ends[(r-1)%log.steps.size()]);
+
+		ids.clear();
+		for(size_t i(first); i < log.ends[r%log.steps.size()]; ++i){
+			ids.push_back(log.ids[i%log.ids.size()]);
+		}
+		write(merged[0], records[k].step, ids.data(), ids.size());
+	}
+
+	logs.swap(merged);
+	logs[0].appends = 1;
+	indexedAppends.clear();
+}
+
+/** append
+ *
+ * @param log 		the log, only one thread appends to a log
+ * @param step 	the step of the spikes, at least the last step of the log
+ * @param ids 		the neurons that spiked
+ * @param count 	the number of ids
+ */
+void SpikeRaster::append(int log, long step, const int* ids, size_t count)
+{
+	Log& target(logs[log]);
+
+	if(retention > 0) forget(target, step - retention + 1);
+	target.appends += 1;
+	if(count > 0) write(target, step, ids, count);
+}
+
+/** allocate
+ *
+ * @param log 		a log without any record
+ * @param neurons 	the number of neurons that append to it
+ * @note preallocates the rings for the retention
+ */
+void SpikeRaster::allocate(Log& log, int neurons) const
+{
+	log.head = 0;
+	log.tail = 0;
+	log.idsHead = 0;
+	log.idsTail = 0;
+	log.appends = 0;
+
+	// Un neurone spike au plus une fois tous les refractory+1 steps : la rétention en garde un nombre borné
+	if(retention > 0){
+		log.steps.resize(retention);
+		log.ends.resize(retention);
+		log.ids.resize(size_t(neurons)*((retention + refractory)/(refractory + 1)));
+	}
+}
+
+/** write
+ *
+ * @param log 		the log
+ * @param step 	the step of the spikes, at least the last step of the log
+ * @param ids 		the neurons that spiked
+ * @param count 	the number of ids, at least one
+ * @note a full ring is only made larger if more spikes than the bound are kept
+ */
+void SpikeRaster::write(Log& log, long step, const int* ids, size_t count)
+{
+	bool record(log.tail == log.head or log.steps[(log.tail - 1)%log.steps.size()] != step);
+
+	if(record and log.tail - log.head == log.steps.size()){
+		size_t capacity(max(2*log.steps.size(), size_t(16)));
+		grow(log.steps, log.head, log.tail, capacity);
+		grow(log.ends, log.head, log.tail, capacity);
+	}
+	if(log.idsTail - log.idsHead + count > log.ids.size()){
+		grow(log.ids, log.idsHead, log.idsTail, max(2*log.ids.size(), log.idsTail - log.idsHead + count));
+	}
+
+	// Les ids sont copiés en deux morceaux au plus, avant et après la fin de l'anneau
+	size_t at(log.idsTail%log.ids.size()), before(min(count, log.ids.size() - at));
+	copy(ids, ids + before, log.ids.begin() + at);
+	copy(ids + before, ids + count, log.ids.begin());
+	log.idsTail += count;
+
+	if(record){
+		log.steps[log.tail%log.steps.size()] = step;
+		log.tail += 1;
+	}
+	log.ends[(log.tail - 1)%log.steps.size()] = log.idsTail;
+}
+
+/** forget
+ *
+ * @param log 		the log
+ * @param before 	the steps before it are forgotten
+ */
+void SpikeRaster::forget(Log& log, long before)
+{
+	while(log.head < log.tail and log.steps[log.head%log.steps.size()] < before){
+		log.idsHead = log.ends[log.head%log.steps.size()];
+		log.head += 1;
+	}
+}
+
+/** spikesOf
+ *
+ * @param id 	a neuron
+ * @return the steps at which id spiked, valid until the next append
+ * @note must not be called while a log is appended
+ */
+SpikeTimes SpikeRaster::spikesOf(int id) const
+{
+	// Chaque thread ne compte que les ajouts de son log : l'index est à jour si aucun compte n'a changé
+	bool indexed(indexedAppends.size() == logs.size());
+	for(size_t l(0); indexed and l < logs.size(); ++l){
+		indexed = (indexedAppends[l] == logs[l].appends);
+	}
+	if(not indexed) buildIndex();
+
+	SpikeTimes spikes = {times.data() + offsets[id], times.data() + offsets[id+1]};
+	return spikes;
+}
+
+/** bytes
+ * @return the memory used by the logs and the index
+ */
+size_t SpikeRaster::bytes() const
+{
+	size_t total(offsets.capacity()*sizeof(size_t) + times.capacity()*sizeof(long));
+
+	for(size_t l(0); l < logs.size(); ++l){
+		total += logs[l].steps.capacity()*sizeof(long) + logs[l].ends.capacity()*sizeof(size_t)
+			   + logs[l].ids.capacity()*sizeof(int);
+	}
+	return total;
+}
+
+/** buildIndex
+ * @note gathers the steps of every neuron from the logs
+ */
+void SpikeRaster::buildIndex() const
+{
+	// Deux passes : compter les spikes de chaque neurone, puis les placer
+	offsets.assign(neurons + 1, 0);
+
+	for(size_t l(0); l < logs.size(); ++l){
+		for(size_t k(logs[l].idsHead); k < logs[l].idsTail; ++k){
+			offsets[logs[l].ids[k%logs[l].ids.size()] + 1] += 1;
+		}
+	}
+	for(int i(0); i < neurons; ++i){
+		offsets[i+1] += offsets[i];
+	}
+
+	times.resize(offsets[neurons]);
+	vector<size_t> next(offsets.begin(), offsets.end() - 1);
+
+	// Les spikes fusionnés par setLogs sont dans le premier log, ensuite un neurone n'est écrit
+	// que dans le log de sa partition : ses steps restent croissants
+	for(size_t l(0); l < logs.size(); ++l){
+
+		const Log& log(logs[l]);
+		size_t k(log.idsHead);
+
+		for(size_t r(log.head); r < log.tail; ++r){
+
+			long step(log.steps[r%log.steps.size()]);
+			for(size_t end(log.ends[r%log.steps.size()]); k < end; ++k){
+				times[next[log.ids[k%log.ids.size()]]++] = step;
+			}
+		}
+	}
+
+	indexedAppends.resize(logs.size());
+	for(size_t l(0); l < logs.size(); ++l){
+		indexedAppends[l] = logs[l].appends;
+	}
+}
@@ -0,0 +1,145 @@
+/**
+ * @file   spikeRaster.hpp
+ * @author Jonathan Haab
+ * @date   Automn, 2017
+ * @brief  spikes of a population, kept in time-ordered logs with a per-neuron index
+ */
+
+#include <vector>
+#include <cstddef>
+
+#ifndef SPIKERASTER_H
+#define SPIKERASTER_H
+
+/** SpikeTimes
+ *  steps at which one neuron spiked, in increasing order, owned by the raster
+ */
+struct SpikeTimes
+{
+	const long* first; //!< First step
+	const long* last; //!< After the last step
+
+	/** size
+	 * @return the number of spikes
+	 */
+	size_t size() const { return last - first; }
+
+	bool empty() const { return first == last; }
+	const long& operator[](size_t k) const { return first[k]; }
+	const long& back() const { return last[-1]; }
+	const long* begin() const { return first; }
+	const long* end() const { return last; }
+};
+
+/** SpikeRaster
+ *  every spike is appended to one of several logs, so that each thread writes
+ *  its own log without any lock. The steps of a log are increasing. The steps
+ *  of each neuron are gathered by an index built when they are asked for.
+ *  Only the spikes of the last retention steps are kept : each log is then a
+ *  ring allocated once for the most spikes that its neurons can give in the
+ *  retention.
+ */
+class SpikeRaster
+{
+	public :
+
+		/** Constructor
+		 *
+		 * @param neurons 		the number of neurons
+		 * @param retention 	the number of steps kept before the last appended one,
+		 * 					0 keeps every spike
+		 * @param refractory 	the steps after a spike during which a neuron does not
+		 * 					spike again, it bounds the spikes kept in the retention
+		 */
+		SpikeRaster(int neurons, long retention = 0, long refractory = 0);
+
+		/** setLogs
+		 *
+		 * @param count 	the number of logs that can be appended at the same time
+		 * @note the spikes already appended are merged in the first log
+		 */
+		void setLogs(int count);
+
+		/** append
+		 *
+		 * @param log 		the log, only one thread appends to a log
+		 * @param step 	the step of the spikes, at least the last step of the log
+		 * @param ids 		the neurons that spiked
+		 * @param count 	the number of ids
+		 */
+		void append(int log, long step, const int* ids, size_t count);
+
+		/** spikesOf
+		 *
+		 * @param id 	a neuron
+		 * @return the steps at which id spiked, valid until the next append
+		 * @note must not be called while a log is appended
+		 */
+		SpikeTimes spikesOf(int id) const;
+
+		/** bytes
+		 * @return the memory used by the logs and the index
+		 */
+		size_t bytes() const;
+
+	private :
+
+		/** Log
+		 *  spikes appended by one thread, step after step. The records and the
+		 *  ids are counted from the first append : the record r is at
+		 *  r%steps.size() and the id k at k%ids.size(), the records before
+		 *  head and the ids before idsHead are forgotten.
+		 */
+		struct Log
+		{
+			std::vector<long> steps; //!< Ring of the steps with at least one spike
+			std::vector<size_t> ends; //!< For each step, the count of the ids appended up to its last one
+			std::vector<int> ids; //!< Ring of the ids of the spikes, step after step
+			size_t head; //!< First record kept
+			size_t tail; //!< Record after the last one
+			size_t idsHead; //!< First id kept
+			size_t idsTail; //!< Id after the last one
+			long appends; //!< Number of appends, the index is built again when it changes
+		};
+
+		/** allocate
+		 *
+		 * @param log 		a log without any record
+		 * @param neurons 	the number of neurons that append to it
+		 * @note preallocates the rings for the retention
+		 */
+		void allocate(Log& log, int neurons) const;
+
+		/** write
+		 *
+		 * @param log 		the log
+		 * @param step 	the step of the spikes, at least the last step of the log
+		 * @param ids 		the neurons that spiked
+		 * @param count 	the number of ids, at least one
+		 * @note a full ring is only made larger if more spikes than the bound are kept
+		 */
+		static void write(Log& log, long step, const int* ids, size_t count);
+
+		/** forget
+		 *
+		 * @param log 		the log
+		 * @param before 	the steps before it are forgotten
+		 */
+		static void forget(Log& log, long before);
+
+		/** buildIndex
+		 * @note gathers the steps of every neuron from the logs
+		 */
+		void buildIndex() const;
+
+		int neurons; //!< Number of neurons
+		long retention; //!< Number of steps kept, 0 keeps everything
+		long refractory; //!< Steps without any spike after a spike of a neuron
+		std::vector<Log> logs; //!< One log per thread
+
+		mutable std::vector<long> indexedAppends; //!< Appends of each log when the index was built
+		mutable std::vector<size_t> offsets; //!< Where the steps of each neuron begin in times
+		mutable std::vector<long> times; //!< Steps of the spikes, neuron after neuron
+};
+
+#endif
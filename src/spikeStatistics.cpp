@@ -0,0 +1,233 @@
+/**
+ * @file   spikeStatistics.cpp
+ * @author Jonathan Haab
+ * @date   Automn, 2017
+ * @brief  contains all the methods of the statistics of the spikes
+ */
+
+#include "spikeStatistics.hpp"
+#include <algorithm>
+#include <cmath>
+#include <string>
+
+using namespace std;
+
+/** Constructor
+ *
+ * @param neurons 		the number of neurons
+ * @param excitatory 	the number of excitatory neurons, ids [0, excitatory)
+ * @param h 			the time in ms of a step
+ * @param binSteps 	the number of steps of a bin of the population rates
+ * @param fanoSteps 	the number of steps of a window of the Fano factors
+ */
+SpikeStatistics::SpikeStatistics(int neurons, int excitatory, double h, long binSteps, long fanoSteps)
+	: excitatory(excitatory), h(h), binSteps(binSteps), fanoSteps(fanoSteps),
+	  first(-1), steps(0), windows(0)
+{
+	Counters zero = {0, -1, 0, 0, 0, 0, 0};
+	counters.assign(neurons, zero);
+}
+
+/** record
+ *
+ * @param step 	the step of the spikes, every recorded step is given once, in increasing order
+ * @param ids 		the neurons that spiked
+ * @param count 	the number of ids
+ */
+void SpikeStatistics::record(long step, const int* ids, size_t count)
+{
+	if(first < 0) first = step;
+
+	// Les fenêtres de Fano sautées sont closes avant de compter les spikes, la fenêtre pleine après
+	while(step - first >= (windows + 1)*fanoSteps) closeWindow();
+	steps = step - first + 1;
+
+	size_t bin((step - first)/binSteps);
+	if(bins[0].size() <= bin){
+		bins[0].resize(bin + 1, 0);
+		bins[1].resize(bin + 1, 0);
+	}
+
+	for(size_t k(0); k < count; ++k){
+
+		Counters& neuron(counters[ids[k]]);
+
+		if(neuron.last >= 0){
+			double interval(step - neuron.last);
+			neuron.isiSum += interval;
+			neuron.isiSquares += interval*interval;
+		}
+		neuron.spikes += 1;
+		neuron.last = step;
+		neuron.windowSpikes += 1;
+		bins[ids[k] < excitatory][bin] += 1;
+	}
+
+	if(steps == (windows + 1)*fanoSteps) closeWindow();
+}
+
+/** closeWindow
+ * @note adds the spikes of the current Fano window to the sums of every neuron
+ */
+void SpikeStatistics::closeWindow()
+{
+	for(size_t i(0); i < counters.size(); ++i){
+		double spikes(counters[i].windowSpikes);
+		counters[i].windowSum += spikes;
+		counters[i].windowSquares += spikes*spikes;
+		counters[i].windowSpikes = 0;
+	}
+	windows += 1;
+}
+
+/** summary
+ *
+ * @param excitatory 	true for the excitatory population, false for the inhibitory one
+ * @return the statistics of the population over the steps recorded so far
+ * @note a window is closed as soon as it is full, the last one is counted if it has
+ * 		 at least 90 % of its steps, its spikes scaled to a whole window
+ */
+PopulationSummary SpikeStatistics::summary(bool excitatory) const
+{
+	int begin(excitatory ? 0 : this->excitatory);
+	int end(excitatory ? this->excitatory : counters.size());
+	double seconds(steps*h/1000);
+
+	PopulationSummary result = {end - begin, 0, 0, 0, 0, 0, 0, 0};
+	double rateSquares(0);
+
+	// L'enregistrement par défaut perd son dernier step : une dernière fenêtre presque pleine compte, ramenée à fanoSteps
+	long lastSteps(steps - windows*fanoSteps);
+	bool lastWindow(lastSteps > 0 and 10*lastSteps >= 9*fanoSteps);
+	double lastScale(lastWindow ? double(fanoSteps)/lastSteps : 0);
+	long fanoWindows(windows + lastWindow);
+
+	for(int i(begin); i < end; ++i){
+
+		const Counters& neuron(counters[i]);
+		double rate(seconds > 0 ? neuron.spikes/seconds : 0);
+
+		result.spikes += neuron.spikes;
+		result.rate += rate;
+		rateSquares += rate*rate;
+
+		// Deux intervalles au moins pour que leur variance ait un sens
+		if(neuron.spikes >= 3){
+			double intervals(neuron.spikes - 1);
+			double mean(neuron.isiSum/intervals);
+			result.cv += sqrt(max(0.0, neuron.isiSquares/intervals - mean*mean))/mean;
+			result.cvNeurons += 1;
+		}
+
+		// Une seule fenêtre n'a pas de variance
+		double last(neuron.windowSpikes*lastScale);
+		double windowSum(neuron.windowSum + last);
+		if(fanoWindows > 1 and windowSum > 0){
+			double mean(windowSum/fanoWindows);
+			result.fano += max(0.0, (neuron.windowSquares + last*last)/fanoWindows - mean*mean)/mean;
+			result.fanoNeurons += 1;
+		}
+	}
+
+	if(result.neurons > 0){
+		result.rate /= result.neurons;
+		result.rateStd = sqrt(max(0.0, rateSquares/result.neurons - result.rate*result.rate));
+	}
+	if(result.cvNeurons > 0) result.cv /= result.cvNeurons;
+	if(result.fanoNeurons > 0) result.fano /= result.fanoNeurons;
+	return result;
+}
+
+/** populationRate
+ *
+ * @param excitatory 	true for the excitatory population, false for the inhibitory one
+ * @return the mean rate of a neuron (Hz) in each bin
+ */
+vector<double> SpikeStatistics::populationRate(bool excitatory) const
+{
+	int neurons(excitatory ? this->excitatory : counters.size() - this->excitatory);
+	vector<double> rates(bins[excitatory].size(), 0.0);
+
+	for(size_t b(0); b < rates.size(); ++b){
+
+		// Le dernier bin n'est peut-être pas complet
+		long binLength(min(binSteps, steps - long(b)*binSteps));
+		if(neurons > 0) rates[b] = bins[excitatory][b]/(neurons*binLength*h/1000);
+	}
+	return rates;
+}
+
+/** histogram
+ *
+ * @param out 		receives "key = minimum maximum count..."
+ * @param key 		the name of the histogram
+ * @param values 	the values
+ */
+void SpikeStatistics::histogram(ostream& out, const char* key, const vector<double>& values)
+{
+	double minimum(values.empty() ? 0 : *min_element(values.begin(), values.end()));
+	double maximum(values.empty() ? 0 : *max_element(values.begin(), values.end()));
+	vector<long> counts(histogramBins, 0);
+
+	for(size_t k(0); k < values.size(); ++k){
+		int bin(maximum > minimum ? int((values[k] - minimum)/(maximum - minimum)*histogramBins) : 0);
+		counts[min(bin, histogramBins - 1)] += 1;
+	}
+
+	out << key << " = " << minimum << " " << maximum;
+	for(int b(0); b < histogramBins; ++b) out << " " << counts[b];
+	out << "\n";
+}
+
+/** write
+ *
+ * @param out 	receives the summary, the population rates and the histograms
+ * 				of both populations as "key = values" lines
+ */
+void SpikeStatistics::write(ostream& out) const
+{
+	out.precision(6);
+	out << "duration = " << steps*h << "\n"
+		<< "bin = " << binSteps*h << "\n"
+		<< "fanoWindow = " << fanoSteps*h << "\n";
+
+	for(int population(1); population >= 0; --population){
+
+		bool isExcitatory(population == 1);
+		string name(isExcitatory ? "excitatory." : "inhibitory.");
+		PopulationSummary result(summary(isExcitatory));
+
+		out << name << "neurons = " << result.neurons << "\n"
+			<< name << "spikes = " << result.spikes << "\n"
+			<< name << "rate = " << result.rate << "\n"
+			<< name << "rateStd = " << result.rateStd << "\n"
+			<< name << "cv = " << result.cv << "\n"
+			<< name << "cvNeurons = " << result.cvNeurons << "\n"
+			<< name << "fano = " << result.fano << "\n"
+			<< name << "fanoNeurons = " << result.fanoNeurons << "\n";
+
+		// Les histogrammes sur les neurones : taux, et CV de ceux qui ont au moins deux intervalles
+		int begin(isExcitatory ? 0 : excitatory);
+		int end(isExcitatory ? excitatory : counters.size());
+		double seconds(steps*h/1000);
+		vector<double> rates, cvs;
+
+		for(int i(begin); i < end; ++i){
+			const Counters& neuron(counters[i]);
+			rates.push_back(seconds > 0 ? neuron.spikes/seconds : 0);
+
+			if(neuron.spikes >= 3){
+				double intervals(neuron.spikes - 1);
+				double mean(neuron.isiSum/intervals);
+				cvs.push_back(sqrt(max(0.0, neuron.isiSquares/intervals - mean*mean))/mean);
+			}
+		}
+		histogram(out, (name + "rateHistogram").c_str(), rates);
+		histogram(out, (name + "cvHistogram").c_str(), cvs);
+
+		vector<double> series(populationRate(isExcitatory));
+		out << name << "populationRate =";
+		for(size_t b(0); b < series.size(); ++b) out << " " << series[b];
+		out << "\n";
+	}
+}
@@ -0,0 +1,121 @@
+/**
+ * @file   spikeStatistics.hpp
+ * @author Jonathan Haab
+ * @date   Automn, 2017
+ * @brief  statistics of the spikes of the excitatory and inhibitory populations, kept during the simulation
+ */
+
+#include <vector>
+#include <ostream>
+
+#ifndef SPIKESTATISTICS_H
+#define SPIKESTATISTICS_H
+
+/** PopulationSummary
+ *  statistics of one population over the recorded steps
+ */
+struct PopulationSummary
+{
+	int neurons; //!< Number of neurons
+	long spikes; //!< Number of spikes
+	double rate; //!< Mean rate of a neuron (Hz)
+	double rateStd; //!< Standard deviation of the rates of the neurons (Hz)
+	double cv; //!< Mean coefficient of variation of the interspike intervals, over the neurons with at least two intervals
+	int cvNeurons; //!< Number of neurons in the mean of cv
+	double fano; //!< Mean Fano factor of the spike counts in windows, over the neurons that spiked, 0 before two windows (the last one counts if it has 90 % of its steps)
+	int fanoNeurons; //!< Number of neurons in the mean of fano
+};
+
+/** SpikeStatistics
+ *  the spikes are given step after step, like to a SpikeWriter, and only
+ *  counters are kept : O(1) for each spike, O(neurons) for each Fano window
+ */
+class SpikeStatistics
+{
+	public :
+
+		static const int histogramBins = 20; //!< Number of bins of the histograms of the rates and of the CV
+
+		/** Constructor
+		 *
+		 * @param neurons 		the number of neurons
+		 * @param excitatory 	the number of excitatory neurons, ids [0, excitatory)
+		 * @param h 			the time in ms of a step
+		 * @param binSteps 	the number of steps of a bin of the population rates
+		 * @param fanoSteps 	the number of steps of a window of the Fano factors
+		 */
+		SpikeStatistics(int neurons, int excitatory, double h, long binSteps, long fanoSteps);
+
+		/** record
+		 *
+		 * @param step 	the step of the spikes, every recorded step is given once, in increasing order
+		 * @param ids 		the neurons that spiked
+		 * @param count 	the number of ids
+		 */
+		void record(long step, const int* ids, size_t count);
+
+		/** summary
+		 *
+		 * @param excitatory 	true for the excitatory population, false for the inhibitory one
+		 * @return the statistics of the population over the steps recorded so far
+		 * @note a window is closed as soon as it is full, the last one is counted if it has
+		 * 		 at least 90 % of its steps, its spikes scaled to a whole window
+		 */
+		PopulationSummary summary(bool excitatory) const;
+
+		/** populationRate
+		 *
+		 * @param excitatory 	true for the excitatory population, false for the inhibitory one
+		 * @return the mean rate of a neuron (Hz) in each bin
+		 */
+		std::vector<double> populationRate(bool excitatory) const;
+
+		/** write
+		 *
+		 * @param out 	receives the summary, the population rates and the histograms
+		 * 				of both populations as "key = values" lines
+		 */
+		void write(std::ostream& out) const;
+
+	private :
+
+		/** Counters
+		 *  statistics of one neuron
+		 */
+		struct Counters
+		{
+			long spikes; //!< Number of spikes
+			long last; //!< Step of the last spike, -1 before the first one
+			double isiSum; //!< Sum of the interspike intervals (steps)
+			double isiSquares; //!< Sum of their squares
+			int windowSpikes; //!< Spikes in the current Fano window
+			double windowSum; //!< Sum of the spikes of the complete windows
+			double windowSquares; //!< Sum of their squares
+		};
+
+		/** closeWindow
+		 * @note adds the spikes of the current Fano window to the sums of every neuron
+		 */
+		void closeWindow();
+
+		/** histogram
+		 *
+		 * @param out 		receives "key = minimum maximum count..."
+		 * @param key 		the name of the histogram
+		 * @param values 	the values
+		 */
+		static void histogram(std::ostream& out, const char* key, const std::vector<double>& values);
+
+		int excitatory; //!< Number of excitatory neurons
+		double h; //!< Time in ms of a step
+		long binSteps; //!< Steps of a bin of the population rates
+		long fanoSteps; //!< Steps of a Fano window
+
+		long first; //!< First recorded step, -1 before it
+		long steps; //!< Number of recorded steps
+		long windows; //!< Number of complete Fano windows
+		std::vector<Counters> counters; //!< Counters of each neuron
+		std::vector<long> bins[2]; //!< Spikes of the inhibitory (0) and excitatory (1) neurons in each bin
+};
+
+#endif
@@ -0,0 +1,247 @@
+/**
+ * @file   spikeTransport.cpp
+ * @author Jonathan Haab
+ * @date   Automn, 2017
+ * @brief  contains all the methods of the exchange of the spikes between the ranks
+ */
+
+#include "spikeTransport.hpp"
+#ifdef NEURONS_MPI
+#include "mpiTransport.hpp"
+#endif
+#include <stdexcept>
+#include <cstring>
+#include <cstdint>
+#include <cerrno>
+#include <chrono>
+#include <thread>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <poll.h>
+#include <unistd.h>
+
+using namespace std;
+
+/** writeAll
+ *
+ * @param socket 	a connection
+ * @param data 	the bytes to send
+ * @param bytes 	the number of bytes
+ * @throw std::runtime_error if the connection is lost
+ */
+static void writeAll(int socket, const void* data, size_t bytes)
+{
+	const char* position(static_cast<const char*>(data));
+
+	while(bytes > 0){
+		ssize_t written(send(socket, position, bytes, MSG_NOSIGNAL));
+		if(written < 0 and errno == EINTR) continue;
+		if(written <= 0) throw runtime_error("a rank of the simulation is lost");
+		position += written;
+		bytes -= written;
+	}
+}
+
+/** readAll
+ *
+ * @param socket 	a connection
+ * @param data 	receives the bytes
+ * @param bytes 	the number of bytes
+ * @throw std::runtime_error if the connection is lost
+ */
+static void readAll(int socket, void* data, size_t bytes)
+{
+	char* position(static_cast<char*>(data));
+
+	while(bytes > 0){
+		ssize_t read(recv(socket, position, bytes, 0));
+		if(read < 0 and errno == EINTR) continue;
+		if(read <= 0) throw runtime_error("a rank of the simulation is lost");
+		position += read;
+		bytes -= read;
+	}
+}
+
+/** sendValues
+ * @note sends the number of values, then the values
+ */
+static void sendValues(int socket, const vector<int>& values)
+{
+	uint64_t count(values.size());
+	writeAll(socket, &count, sizeof(count));
+	writeAll(socket, values.data(), count*sizeof(int));
+}
+
+/** receiveValues
+ * @note receives values sent by sendValues
+ */
+static void receiveValues(int socket, vector<int>& values)
+{
+	uint64_t count;
+	readAll(socket, &count, sizeof(count));
+	values.resize(count);
+	readAll(socket, values.data(), count*sizeof(int));
+}
+
+/** create
+ *
+ * @param parameters 	the transport, the rank and the number of ranks
+ * @return the transport of parameters, nullptr for a single process
+ * @throw std::runtime_error if the ranks cannot be connected
+ */
+SpikeTransport* SpikeTransport::create(const Parameters& parameters)
+{
+	if(parameters.transport == MESSAGE_PASSING){
+#ifdef NEURONS_MPI
+		return new MpiTransport();
+#else
+		throw runtime_error("this build has no MPI, configure it with -DNEURONS_MPI=ON");
+#endif
+	}
+
+	if(parameters.ranks == 1) return nullptr;
+	if(parameters.rank >= parameters.ranks or parameters.N < parameters.ranks){
+		throw runtime_error("the rank must be in [0, ranks) and every rank must have a neuron");
+	}
+	return new SocketTransport(parameters.socket, parameters.rank, parameters.ranks);
+}
+
+/** Constructor
+ *
+ * @param path 	the name of the socket, rank 0 listens on it
+ * @param rank 	the rank of this process
+ * @param ranks 	the number of processes
+ * @throw std::runtime_error if the ranks are not connected within a minute
+ */
+SocketTransport::SocketTransport(const string& path, int rank, int ranks)
+	: rank(rank), ranks(ranks)
+{
+	sockaddr_un address;
+	memset(&address, 0, sizeof(address));
+	address.sun_family = AF_UNIX;
+	if(path.size() >= sizeof(address.sun_path)) throw runtime_error("the name of the socket '" + path + "' is too long");
+	strcpy(address.sun_path, path.c_str());
+
+	const int timeout(60000); // ms
+	int32_t header[2] = {rank, ranks};
+
+	if(rank > 0){
+
+		// Le rang 0 n'écoute peut-être pas encore : on réessaie jusqu'à la fin du délai
+		auto deadline(chrono::steady_clock::now() + chrono::milliseconds(timeout));
+		int connection(-1);
+
+		while(connection < 0){
+			connection = socket(AF_UNIX, SOCK_STREAM, 0);
+			if(connect(connection, reinterpret_cast<sockaddr*>(&address), sizeof(address)) == 0) break;
+
+			close(connection);
+			connection = -1;
+			if(chrono::steady_clock::now() > deadline) throw runtime_error("cannot connect to the rank 0 on the socket '" + path + "'");
+			this_thread::sleep_for(chrono::milliseconds(10));
+		}
+		sockets.assign(1, connection);
+
+		try {
+			writeAll(connection, header, sizeof(header));
+		} catch(...){
+			close(connection);
+			throw;
+		}
+		return;
+	}
+
+	int listener(socket(AF_UNIX, SOCK_STREAM, 0));
+	unlink(path.c_str());
+
+	if(listener < 0 or bind(listener, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 or listen(listener, ranks) != 0){
+		if(listener >= 0) close(listener);
+		throw runtime_error("cannot listen on the socket '" + path + "'");
+	}
+
+	sockets.assign(ranks, -1);
+
+	try {
+		for(int connected(1); connected < ranks; ++connected){
+
+			pollfd waiting = {listener, POLLIN, 0};
+			if(poll(&waiting, 1, timeout) <= 0) throw runtime_error("the ranks did not connect to the socket '" + path + "'");
+
+			int connection(accept(listener, nullptr, nullptr));
+			if(connection < 0) throw runtime_error("cannot accept a rank on the socket '" + path + "'");
+
+			readAll(connection, header, sizeof(header));
+			if(header[1] != ranks or header[0] < 1 or header[0] >= ranks or sockets[header[0]] != -1){
+				close(connection);
+				throw runtime_error("the ranks connected to the socket '" + path + "' do not match");
+			}
+			sockets[header[0]] = connection;
+		}
+	} catch(...){
+		for(int r(1); r < ranks; ++r){
+			if(sockets[r] >= 0) close(sockets[r]);
+		}
+		close(listener);
+		unlink(path.c_str());
+		throw;
+	}
+
+	close(listener);
+	unlink(path.c_str());
+}
+
+/** Destructor
+ * @note closes the connections
+ */
+SocketTransport::~SocketTransport()
+{
+	for(size_t s(0); s < sockets.size(); ++s){
+		if(sockets[s] >= 0) close(sockets[s]);
+	}
+}
+
+/** allGather
+ *
+ * @param sent 		the values of this rank
+ * @param received 	receives the values of every rank, in the order of the ranks
+ * @throw std::runtime_error if a rank is lost
+ */
+void SocketTransport::allGather(const vector<int>& sent, vector<vector<int>>& received)
+{
+	received.resize(ranks);
+
+	if(rank > 0){
+		sendValues(sockets[0], sent);
+		for(int r(0); r < ranks; ++r){
+			receiveValues(sockets[0], received[r]);
+		}
+		return;
+	}
+
+	// Le rang 0 reçoit les valeurs de chaque rang, puis les renvoie toutes à chacun
+	received[0] = sent;
+	for(int r(1); r < ranks; ++r){
+		receiveValues(sockets[r], received[r]);
+	}
+	for(int r(1); r < ranks; ++r){
+		for(int q(0); q < ranks; ++q){
+			sendValues(sockets[r], received[q]);
+		}
+	}
+}
+
+/** getRank
+ * @return the rank of this process, in [0, getRanks())
+ */
+int SocketTransport::getRank() const
+{
+	return rank;
+}
+
+/** getRanks
+ * @return the number of processes of the simulation
+ */
+int SocketTransport::getRanks() const
+{
+	return ranks;
+}
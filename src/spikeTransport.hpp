@@ -0,0 +1,88 @@
+/**
+ * @file   spikeTransport.hpp
+ * @author Jonathan Haab
+ * @date   Automn, 2017
+ * @brief  exchange of the spikes between the processes (ranks) of a distributed simulation
+ */
+
+#include <vector>
+#include <string>
+#include "parameters.hpp"
+
+#ifndef SPIKETRANSPORT_H
+#define SPIKETRANSPORT_H
+
+/** SpikeTransport
+ *  the ranks of a simulation call allGather together, once per window,
+ *  each one with the spikes of its neurons
+ */
+class SpikeTransport
+{
+	public :
+
+		virtual ~SpikeTransport() {}
+
+		/** allGather
+		 *
+		 * @param sent 		the values of this rank
+		 * @param received 	receives the values of every rank, in the order of the ranks
+		 * @throw std::runtime_error if a rank is lost
+		 */
+		virtual void allGather(const std::vector<int>& sent, std::vector<std::vector<int>>& received) = 0;
+
+		/** getRank
+		 * @return the rank of this process, in [0, getRanks())
+		 */
+		virtual int getRank() const = 0;
+
+		/** getRanks
+		 * @return the number of processes of the simulation
+		 */
+		virtual int getRanks() const = 0;
+
+		/** create
+		 *
+		 * @param parameters 	the transport, the rank and the number of ranks
+		 * @return the transport of parameters, nullptr for a single process
+		 * @throw std::runtime_error if the ranks cannot be connected
+		 */
+		static SpikeTransport* create(const Parameters& parameters);
+};
+
+/** SocketTransport
+ *  the ranks run on the same machine : every rank is connected to rank 0
+ *  by a unix socket, rank 0 gathers the values and sends all of them back
+ */
+class SocketTransport : public SpikeTransport
+{
+	public :
+
+		/** Constructor
+		 *
+		 * @param path 	the name of the socket, rank 0 listens on it
+		 * @param rank 	the rank of this process
+		 * @param ranks 	the number of processes
+		 * @throw std::runtime_error if the ranks are not connected within a minute
+		 */
+		SocketTransport(const std::string& path, int rank, int ranks);
+
+		/** Destructor
+		 * @note closes the connections
+		 */
+		~SocketTransport();
+
+		SocketTransport(const SocketTransport&) = delete;
+		SocketTransport& operator=(const SocketTransport&) = delete;
+
+		void allGather(const std::vector<int>& sent, std::vector<std::vector<int>>& received) override;
+		int getRank() const override;
+		int getRanks() const override;
+
+	private :
+
+		int rank; //!< Rank of this process
+		int ranks; //!< Number of processes
+		std::vector<int> sockets; //!< On rank 0, the connection of each rank (-1 for itself), else the connection to rank 0
+};
+
+#endif
@@ -0,0 +1,82 @@
+/**
+ * @file   spscQueue.hpp
+ * @author Jonathan Haab
+ * @date   Automn, 2017
+ * @brief  lock-free queue between one producer thread and one consumer thread
+ */
+
+#include <vector>
+#include <atomic>
+#include <cstddef>
+
+#ifndef SPSCQUEUE_H
+#define SPSCQUEUE_H
+
+template<typename T>
+class SpscQueue
+{
+	public :
+
+		/** Constructor
+		 *
+		 * @param capacity 	the number of values the queue can hold at least,
+		 * 					rounded up to a power of two
+		 */
+		explicit SpscQueue(size_t capacity)
+			: head(0), tail(0)
+		{
+			size_t size(1);
+			while(size < capacity) size *= 2;
+			values.resize(size);
+			mask = size - 1;
+		}
+
+		/** push
+		 *
+		 * @param value 	the value added at the end of the queue
+		 * @return false if the queue is full
+		 * @note only called by the producer
+		 */
+		bool push(const T& value)
+		{
+			size_t t(tail.load(std::memory_order_relaxed));
+			if(t - head.load(std::memory_order_acquire) > mask) return false;
+
+			values[t & mask] = value;
+			tail.store(t + 1, std::memory_order_release);
+			return true;
+		}
+
+		/** pop
+		 *
+		 * @param value 	receives the first value of the queue
+		 * @return false if the queue is empty
+		 * @note only called by the consumer
+		 */
+		bool pop(T& value)
+		{
+			size_t h(head.load(std::memory_order_relaxed));
+			if(h == tail.load(std::memory_order_acquire)) return false;
+
+			value = values[h & mask];
+			head.store(h + 1, std::memory_order_release);
+			return true;
+		}
+
+	private :
+
+		static const size_t cacheLine = 64; //!< Bytes of a cache line
+
+		std::vector<T> values; //!< Ring of the values
+		size_t mask; //!< Size of the ring minus one
+
+		// Chaque index n'est écrit que par un thread : à une ligne de cache de tout le reste, sans alignas
+		// qu'un new de C++11 ne respecterait pas pour la classe qui contient la queue
+		char beforeHead[cacheLine];
+		std::atomic<size_t> head; //!< Number of values popped
+		char beforeTail[cacheLine - sizeof(std::atomic<size_t>)];
+		std::atomic<size_t> tail; //!< Number of values pushed
+		char afterTail[cacheLine - sizeof(std::atomic<size_t>)];
+};
+
+#endif
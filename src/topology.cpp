@@ -0,0 +1,186 @@
+/**
+ * @file   topology.cpp
+ * @author Jonathan Haab
+ * @date   Automn, 2017
+ * @brief  contains all the methods of the topology of the machine
+ */
+
+#include "topology.hpp"
+#include <fstream>
+#include <sstream>
+#include <algorithm>
+#include <stdexcept>
+#include <thread>
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#include <sys/mman.h>
+#endif
+
+using namespace std;
+
+/** Constructor
+ *
+ * @note reads the nodes of this machine
+ */
+Topology::Topology()
+{
+	// Les nœuds sont numérotés à la suite : le premier qui manque termine la liste
+	for(int node(0); ; ++node){
+
+		ifstream in("/sys/devices/system/node/node" + to_string(node) + "/cpulist");
+		string list;
+		if(not getline(in, list)) break;
+
+		try {
+			vector<int> cpus(parseCpuList(list));
+			if(not cpus.empty()) nodeCpus.push_back(cpus);
+		} catch(const invalid_argument&){
+			break;
+		}
+	}
+
+	if(nodeCpus.empty()){
+		vector<int> cpus(max(1u, thread::hardware_concurrency()));
+		for(size_t c(0); c < cpus.size(); ++c) cpus[c] = c;
+		nodeCpus.push_back(cpus);
+	}
+}
+
+/** Constructor
+ *
+ * @param nodes 	the cpus of each node
+ */
+Topology::Topology(const vector<vector<int>>& nodes)
+{
+	for(size_t n(0); n < nodes.size(); ++n){
+		if(not nodes[n].empty()) nodeCpus.push_back(nodes[n]);
+	}
+	if(nodeCpus.empty()) nodeCpus.push_back(vector<int>(1, 0));
+}
+
+/** parseCpuList
+ *
+ * @param list 	a list of cpus as written by linux, like "0-3,8,10-11"
+ * @return the cpus of the list, in increasing order
+ * @throw std::invalid_argument if the list cannot be read
+ */
+vector<int> Topology::parseCpuList(const string& list)
+{
+	vector<int> cpus;
+	istringstream in(list);
+	string range;
+
+	while(getline(in, range, ',')){
+
+		if(range.empty() or range.find_first_not_of(" \n") == string::npos) continue;
+
+		istringstream bounds(range);
+		int first, last;
+		char dash;
+		if(not (bounds >> first) or first < 0) throw invalid_argument("cannot read the cpus " + list);
+
+		last = first;
+		if(bounds >> dash and (dash != '-' or not (bounds >> last) or last < first)){
+			throw invalid_argument("cannot read the cpus " + list);
+		}
+		for(int c(first); c <= last; ++c) cpus.push_back(c);
+	}
+
+	sort(cpus.begin(), cpus.end());
+	cpus.erase(unique(cpus.begin(), cpus.end()), cpus.end());
+	return cpus;
+}
+
+/** nodes
+ * @return the number of nodes
+ */
+int Topology::nodes() const
+{
+	return nodeCpus.size();
+}
+
+/** cpusOf
+ * @return the cpus of the node
+ */
+const vector<int>& Topology::cpusOf(int node) const
+{
+	return nodeCpus[node];
+}
+
+/** threadNodes
+ *
+ * @param threads 	the number of threads
+ * @return the node of each thread : contiguous groups of threads, as many as the cpus of their node allow
+ */
+vector<int> Topology::threadNodes(int threads) const
+{
+	size_t total(0);
+	for(size_t n(0); n < nodeCpus.size(); ++n) total += nodeCpus[n].size();
+
+	// Le thread t prend la place t*total/threads parmi les cpus de tous les nœuds, à la suite
+	vector<int> result(max(threads, 0));
+	for(int t(0); t < threads; ++t){
+
+		size_t place(size_t(t)*total/threads), node(0);
+		while(place >= nodeCpus[node].size()){
+			place -= nodeCpus[node].size();
+			++node;
+		}
+		result[t] = node;
+	}
+	return result;
+}
+
+/** threadCpus
+ *
+ * @param threads 	the number of threads
+ * @return the cpu of each thread, in its node of threadNodes, shared only if the node has fewer cpus than threads
+ */
+vector<int> Topology::threadCpus(int threads) const
+{
+	vector<int> nodes(threadNodes(threads)), result(nodes.size());
+	vector<size_t> used(nodeCpus.size(), 0);
+
+	for(size_t t(0); t < nodes.size(); ++t){
+		const vector<int>& cpus(nodeCpus[nodes[t]]);
+		result[t] = cpus[used[nodes[t]]++ % cpus.size()];
+	}
+	return result;
+}
+
+/** pinThread
+ *
+ * @param cpu 	a cpu of the machine
+ * @return true if the calling thread now only runs on cpu, false if the system refused
+ */
+bool pinThread(int cpu)
+{
+#ifdef __linux__
+	if(cpu < 0 or cpu >= CPU_SETSIZE) return false;
+
+	cpu_set_t set;
+	CPU_ZERO(&set);
+	CPU_SET(cpu, &set);
+	return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+#else
+	(void)cpu;
+	return false;
+#endif
+}
+
+/** adviseHugePages
+ *
+ * @param data 	memory aligned on hugePageBytes
+ * @param bytes 	its size
+ * @note asks the system for transparent huge pages, ignored if it cannot
+ */
+void adviseHugePages(void* data, size_t bytes)
+{
+#if defined(__linux__) && defined(MADV_HUGEPAGE)
+	madvise(data, bytes, MADV_HUGEPAGE);
+#else
+	(void)data;
+	(void)bytes;
+#endif
+}
@@ -0,0 +1,164 @@
+/**
+ * @file   topology.hpp
+ * @author Jonathan Haab
+ * @date   Automn, 2017
+ * @brief  NUMA nodes of the machine, placement of the threads on their cpus and
+ * 		   arrays whose pages are placed by the thread that first writes them
+ */
+
+#include <vector>
+#include <string>
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+#include <utility>
+#include <type_traits>
+
+#ifndef TOPOLOGY_H
+#define TOPOLOGY_H
+
+/** Topology
+ *  the cpus of each NUMA node, read from /sys/devices/system/node. Without
+ *  it (or outside of linux) the machine is a single node of every cpu.
+ *  The threads are spread over the nodes in contiguous groups, so that the
+ *  contiguous partitions of neurons of a group stay on the same node.
+ */
+class Topology
+{
+	public :
+
+		/** Constructor
+		 *
+		 * @note reads the nodes of this machine
+		 */
+		Topology();
+
+		/** Constructor
+		 *
+		 * @param nodes 	the cpus of each node
+		 */
+		Topology(const std::vector<std::vector<int>>& nodes);
+
+		/** parseCpuList
+		 *
+		 * @param list 	a list of cpus as written by linux, like "0-3,8,10-11"
+		 * @return the cpus of the list, in increasing order
+		 * @throw std::invalid_argument if the list cannot be read
+		 */
+		static std::vector<int> parseCpuList(const std::string& list);
+
+		/** nodes
+		 * @return the number of nodes
+		 */
+		int nodes() const;
+
+		/** cpusOf
+		 * @return the cpus of the node
+		 */
+		const std::vector<int>& cpusOf(int node) const;
+
+		/** threadNodes
+		 *
+		 * @param threads 	the number of threads
+		 * @return the node of each thread : contiguous groups of threads, as many as the cpus of their node allow
+		 */
+		std::vector<int> threadNodes(int threads) const;
+
+		/** threadCpus
+		 *
+		 * @param threads 	the number of threads
+		 * @return the cpu of each thread, in its node of threadNodes, shared only if the node has fewer cpus than threads
+		 */
+		std::vector<int> threadCpus(int threads) const;
+
+	private :
+
+		std::vector<std::vector<int>> nodeCpus; //!< Cpus of each node, never empty
+};
+
+/** pinThread
+ *
+ * @param cpu 	a cpu of the machine
+ * @return true if the calling thread now only runs on cpu, false if the system refused
+ */
+bool pinThread(int cpu);
+
+/** adviseHugePages
+ *
+ * @param data 	memory aligned on hugePageBytes
+ * @param bytes 	its size
+ * @note asks the system for transparent huge pages, ignored if it cannot
+ */
+void adviseHugePages(void* data, size_t bytes);
+
+static const size_t hugePageBytes = size_t(1) << 21; //!< Size of a huge page
+
+/** PlacedAllocator
+ *  allocator of arrays that are not written when they are resized : a page
+ *  is then placed on the node of the thread that first writes it. With huge
+ *  pages, the arrays of at least one huge page are aligned on it and advised.
+ *  Every PlacedAllocator frees the memory of the others.
+ */
+template<typename T>
+class PlacedAllocator
+{
+	public :
+
+		typedef T value_type;
+		typedef std::true_type propagate_on_container_swap;
+		typedef std::true_type propagate_on_container_move_assignment;
+		typedef std::true_type propagate_on_container_copy_assignment;
+
+		/** Constructor
+		 *
+		 * @param hugePages 	true to advise huge pages for the large arrays
+		 */
+		PlacedAllocator(bool hugePages = false) : hugePages(hugePages) {}
+
+		template<typename U>
+		PlacedAllocator(const PlacedAllocator<U>& other) : hugePages(other.hugePages) {}
+
+		T* allocate(size_t count)
+		{
+			size_t bytes(count*sizeof(T));
+			bool huge(hugePages and bytes >= hugePageBytes);
+			void* data(nullptr);
+
+			// Les grands blocs viennent de pages neuves du système : elles n'ont pas encore de nœud
+			if(posix_memalign(&data, huge ? hugePageBytes : 64, bytes > 0 ? bytes : 1) != 0) throw std::bad_alloc();
+			if(huge) adviseHugePages(data, bytes);
+			return static_cast<T*>(data);
+		}
+
+		void deallocate(T* data, size_t)
+		{
+			free(data);
+		}
+
+		/// Sans valeur, un élément n'est pas écrit : sa page attend le thread qui la remplira
+		template<typename U>
+		void construct(U* p)
+		{
+			::new(static_cast<void*>(p)) U;
+		}
+
+		template<typename U, typename... Args>
+		void construct(U* p, Args&&... args)
+		{
+			::new(static_cast<void*>(p)) U(std::forward<Args>(args)...);
+		}
+
+		bool hugePages; //!< True if the large arrays are advised huge pages
+};
+
+template<typename T, typename U>
+bool operator==(const PlacedAllocator<T>&, const PlacedAllocator<U>&) { return true; }
+
+template<typename T, typename U>
+bool operator!=(const PlacedAllocator<T>&, const PlacedAllocator<U>&) { return false; }
+
+/// Array whose pages are placed by the thread that first writes them
+template<typename T>
+using PlacedVector = std::vector<T, PlacedAllocator<T>>;
+
+#endif
@@ -0,0 +1,126 @@
+/**
+ * @file   workerPool.cpp
+ * @author Jonathan Haab
+ * @date   Automn, 2017
+ * @brief  contains all the methods of the pool of threads
+ */
+
+#include "workerPool.hpp"
+
+using namespace std;
+
+/** Constructor
+ *
+ * @param threads 	the number of threads that run a task, the
+ * 					calling thread is one of them
+ */
+WorkerPool::WorkerPool(int threads)
+	: threads(threads < 1 ? 1 : threads), task(nullptr), generation(0),
+	  running(0), stopping(false), waiting(0), barrierGeneration(0)
+{
+	for(int i(1); i < this->threads; ++i){
+		workers.push_back(thread(&WorkerPool::work, this, i));
+	}
+}
+
+/** Destructor
+ *
+ * @note stops and joins the threads
+ */
+WorkerPool::~WorkerPool()
+{
+	{
+		lock_guard<std::mutex> lock(mutex);
+		stopping = true;
+	}
+	wake.notify_all();
+
+	for(size_t i(0); i < workers.size(); ++i){
+		workers[i].join();
+	}
+}
+
+/** run
+ *
+ * @param task 	called once by every thread with its id in [0, size())
+ * @note returns when every thread is done, task(0) runs on the calling thread
+ */
+void WorkerPool::run(const function<void(int)>& task)
+{
+	if(threads == 1){
+		task(0);
+		return;
+	}
+
+	{
+		lock_guard<std::mutex> lock(mutex);
+		this->task = &task;
+		running = threads - 1;
+		generation += 1;
+	}
+	wake.notify_all();
+
+	task(0);
+
+	unique_lock<std::mutex> lock(mutex);
+	done.wait(lock, [this]{ return running == 0; });
+	this->task = nullptr;
+}
+
+/** barrier
+ *
+ * @note only called from a task, waits until every thread reached it
+ */
+void WorkerPool::barrier()
+{
+	if(threads == 1) return;
+
+	unique_lock<std::mutex> lock(mutex);
+	long crossing(barrierGeneration);
+
+	if(++waiting == threads){
+		waiting = 0;
+		barrierGeneration += 1;
+		barrierCrossed.notify_all();
+	} else {
+		barrierCrossed.wait(lock, [this, crossing]{ return barrierGeneration != crossing; });
+	}
+}
+
+/** size
+ * @return the number of threads
+ */
+int WorkerPool::size() const
+{
+	return threads;
+}
+
+/** work
+ *
+ * @param id 	the id of the thread
+ * @note loop of the threads 1 to threads-1
+ */
+void WorkerPool::work(int id)
+{
+	long seen(0);
+
+	while(true){
+
+		const function<void(int)>* current;
+		{
+			unique_lock<std::mutex> lock(mutex);
+			wake.wait(lock, [this, seen]{ return stopping or generation != seen; });
+			if(stopping) return;
+			seen = generation;
+			current = task;
+		}
+
+		(*current)(id);
+
+		{
+			lock_guard<std::mutex> lock(mutex);
+			running -= 1;
+		}
+		done.notify_one();
+	}
+}
@@ -0,0 +1,77 @@
+/**
+ * @file   workerPool.hpp
+ * @author Jonathan Haab
+ * @date   Automn, 2017
+ * @brief  persistent threads running the same task on every partition of the network
+ */
+
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+
+#ifndef WORKERPOOL_H
+#define WORKERPOOL_H
+
+class WorkerPool
+{
+	public :
+
+		/** Constructor
+		 *
+		 * @param threads 	the number of threads that run a task, the
+		 * 					calling thread is one of them
+		 */
+		WorkerPool(int threads);
+
+		/** Destructor
+		 *
+		 * @note stops and joins the threads
+		 */
+		~WorkerPool();
+
+		/** run
+		 *
+		 * @param task 	called once by every thread with its id in [0, size())
+		 * @note returns when every thread is done, task(0) runs on the calling thread
+		 */
+		void run(const std::function<void(int)>& task);
+
+		/** barrier
+		 *
+		 * @note only called from a task, waits until every thread reached it
+		 */
+		void barrier();
+
+		/** size
+		 * @return the number of threads
+		 */
+		int size() const;
+
+	private :
+
+		int threads; //!< Number of threads, the calling thread included
+		std::vector<std::thread> workers; //!< Threads 1 to threads-1
+
+		std::mutex mutex; //!< Protects the fields below
+		std::condition_variable wake; //!< Signals a new task or the end
+		std::condition_variable done; //!< Signals that a thread finished the task
+		const std::function<void(int)>* task; //!< Task being run
+		long generation; //!< Number of tasks given to the threads
+		int running; //!< Number of threads still running the task
+		bool stopping; //!< True when the pool is destroyed
+
+		int waiting; //!< Number of threads waiting at the barrier
+		long barrierGeneration; //!< Number of times the barrier was crossed
+		std::condition_variable barrierCrossed; //!< Signals that the barrier was crossed
+
+		/** work
+		 *
+		 * @param id 	the id of the thread
+		 * @note loop of the threads 1 to threads-1
+		 */
+		void work(int id);
+};
+
+#endif
@@ -0,0 +1,93 @@
+/**
+ * @file   batch_unittest.cpp
+ * @author Jonathan Haab
+ * @date   Automn, 2017
+ * @brief  Contains the googletests of the instances simulated at once
+ */
+
+
+#include "neuronPopulation.hpp"
+#include "parameters.hpp"
+#include "gtest/gtest.h"
+#include <vector>
+#include <stdexcept>
+
+/** BatchInstances
+ *  @test BatchInstances
+ *  @note reads a batch of two points (g, eta) of the phase diagram
+ *  @brief J_i should be -g*J_e and lambda eta times the threshold input, bad batches throw
+ *  @throw error if an instance is wrong or an invalid batch is accepted
+ */
+TEST (Batch, BatchInstances) {
+
+	Parameters parameters;
+	EXPECT_EQ(1u, parameters.instances().size());
+	EXPECT_EQ(parameters.J_i, parameters.instances()[0].J_i);
+
+	parameters.set("batch", "3:2,6:4");
+	std::vector<Instance> instances(parameters.instances());
+
+	ASSERT_EQ(2u, instances.size());
+	EXPECT_DOUBLE_EQ(-3*J_e, instances[0].J_i);
+	EXPECT_DOUBLE_EQ(2*v_th*h/(J_e*tau), instances[0].lambda);
+	EXPECT_DOUBLE_EQ(-6*J_e, instances[1].J_i);
+	EXPECT_DOUBLE_EQ(4*v_th*h/(J_e*tau), instances[1].lambda);
+
+	EXPECT_THROW(parameters.set("batch", "3"), std::invalid_argument);
+	EXPECT_THROW(parameters.set("batch", "3:x"), std::invalid_argument);
+	EXPECT_THROW(parameters.set("batch", "3:-1"), std::invalid_argument);
+}
+
+/** SameSpikesAsAlone
+ *  @test SameSpikesAsAlone
+ *  @note integrates a batch of two instances and each instance alone during
+ *  	  2000 steps, every spike is given to 10 other neurons
+ *  @brief each instance should have exactly the potentials and the spikes of its simulation alone
+ *  @throw error if one potential or one spike differs
+ */
+TEST (Batch, SameSpikesAsAlone) {
+
+	const char* points[2] = {"3:2", "5:2"};
+	Parameters both, alone[2];
+	both.set("batch", std::string(points[0]) + "," + points[1]);
+	alone[0].set("batch", points[0]);
+	alone[1].set("batch", points[1]);
+
+	NeuronPopulation batch(500, 400, 5, both);
+	NeuronPopulation single[2] = {NeuronPopulation(500, 400, 5, alone[0]), NeuronPopulation(500, 400, 5, alone[1])};
+	ASSERT_EQ(2, batch.getInstances());
+
+	for(long step(0); step < 2000; ++step){
+
+		std::vector<int> spiking;
+		batch.update(step + 1, spiking);
+
+		for(size_t s(0); s < spiking.size(); ++s){
+			int i(spiking[s]/2), k(spiking[s]%2);
+			for(int c(1); c <= 10; ++c){
+				batch.deliver((i + 37*c)%500, step, batch.getJ(i, k), k);
+			}
+		}
+
+		for(int k(0); k < 2; ++k){
+
+			spiking.clear();
+			single[k].update(step + 1, spiking);
+
+			for(size_t s(0); s < spiking.size(); ++s){
+				for(int c(1); c <= 10; ++c){
+					single[k].deliver((spiking[s] + 37*c)%500, step, single[k].getJ(spiking[s]));
+				}
+			}
+		}
+	}
+
+	for(int k(0); k < 2; ++k){
+		EXPECT_FALSE(single[k].getSpikesTime(0).empty() and single[k].getSpikesTime(450).empty());
+		for(int i(0); i < 500; ++i){
+			EXPECT_EQ(single[k].getV(i), batch.getV(i, k));
+			SpikeTimes aloneTimes(single[k].getSpikesTime(i)), batchTimes(batch.getSpikesTime(i, k));
+			EXPECT_EQ(std::vector<long>(aloneTimes.begin(), aloneTimes.end()), std::vector<long>(batchTimes.begin(), batchTimes.end()));
+		}
+	}
+}
@@ -0,0 +1,150 @@
+/**
+ * @file   checkpoint_unittest.cpp
+ * @author Jonathan Haab
+ * @date   Automn, 2017
+ * @brief  Contains the googletests of the checkpoints
+ */
+
+
+#include "neuronPopulation.hpp"
+#include "connectivity.hpp"
+#include "checkpoint.hpp"
+#include "network.hpp"
+#include "gtest/gtest.h"
+#include <vector>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+
+/** ResumesBitExactly
+ *  @test ResumesBitExactly
+ *  @note integrates a population of 500 neurons receiving EPSP during 2000 steps, saves it with
+ *  	  a few connections after 1000 steps and restores it in a new population
+ *  @brief both populations should then give exactly the same potentials and spikes
+ *  @throw error if one potential or one spike differs, or if a wrong checkpoint is accepted
+ */
+TEST (Checkpoint, ResumesBitExactly) {
+
+	NeuronPopulation original(500, 400, 11);
+	std::vector<int> spiking;
+
+	Connectivity connections;
+	connections.reset(3);
+	connections.count(1);
+	connections.count(1);
+	connections.allocate();
+	connections.add(1, 7);
+	connections.add(1, 42);
+
+	for(long step(0); step < 1000; ++step){
+		original.update(step + 1, spiking);
+		for(size_t k(0); k < spiking.size(); ++k){
+			original.deliver((spiking[k]*7)%500, step, original.getJ(spiking[k]));
+		}
+		spiking.clear();
+	}
+
+	CheckpointWriter out;
+	original.save(out);
+	connections.save(out);
+	out.write("checkpoint_unittest.bin", original.getStep());
+
+	NeuronPopulation restored(500, 400, 11);
+	Connectivity restoredConnections;
+	{
+		CheckpointReader in("checkpoint_unittest.bin");
+		restored.restore(in);
+		restoredConnections.restore(in, 3);
+
+		NeuronPopulation smaller(400, 300, 11);
+		EXPECT_THROW(smaller.restore(in), std::runtime_error);
+	}
+	std::remove("checkpoint_unittest.bin");
+
+	EXPECT_EQ(1000, restored.getStep());
+	ASSERT_EQ(2u, restoredConnections.targetsOf(1).size());
+	EXPECT_EQ(42, restoredConnections.targetsOf(1).first[1]);
+
+	std::vector<int> restoredSpiking;
+	for(long step(1000); step < 2000; ++step){
+
+		original.update(step + 1, spiking);
+		restored.update(step + 1, restoredSpiking);
+		ASSERT_EQ(spiking, restoredSpiking) << "step " << step;
+
+		for(size_t k(0); k < spiking.size(); ++k){
+			original.deliver((spiking[k]*7)%500, step, original.getJ(spiking[k]));
+			restored.deliver((spiking[k]*7)%500, step, restored.getJ(spiking[k]));
+		}
+		spiking.clear();
+		restoredSpiking.clear();
+	}
+
+	for(int i(0); i < 500; ++i){
+		EXPECT_EQ(original.getV(i), restored.getV(i));
+	}
+}
+
+/** RestoresItsNetwork
+ *  @test RestoresItsNetwork
+ *  @note simulates 60 ms of a network of 5000 neurons, saved after 30 ms, then restores
+ *  	  it with another drawn seed, without its batch and with the other connectivity,
+ *  	  for both connectivities
+ *  @brief the restored network should be the one of the checkpoint : its spikes should be
+ *  	   exactly the end of the others, and another given seed should be refused
+ *  @throw error if a spike differs or if the other seed is accepted
+ */
+TEST (Checkpoint, RestoresItsNetwork) {
+
+	for(int mode(STORED); mode < connectivityModeSize; ++mode){
+
+		Parameters parameters;
+		parameters.N = 5000;
+		parameters.connectionRatio = 0.01;
+		parameters.connectivity = ConnectivityMode(mode);
+		parameters.set("seed", "7");
+		parameters.set("batch", "5:2");
+		parameters.plotStartTime = 0;
+		parameters.plotStopTime = 1e9;
+		{
+			Network network("checkpoint_unittest_alone.txt", parameters);
+			network.update(300);
+			network.save("checkpoint_unittest.chk");
+			network.update(600);
+		}
+
+		// Comme neuronMain sans --seed : un autre seed tiré, les autres valeurs par défaut
+		Parameters drawn;
+		drawn.seed = 8;
+		drawn.connectivity = ConnectivityMode(1 - mode);
+		drawn.plotStartTime = 0;
+		drawn.plotStopTime = 1e9;
+		drawn.restore = "checkpoint_unittest.chk";
+		{
+			Network network("checkpoint_unittest_restored.txt", drawn);
+			EXPECT_EQ(7u, network.getParameters().seed);
+			EXPECT_EQ(5000, network.getParameters().N);
+			EXPECT_EQ(mode, network.getParameters().connectivity);
+			EXPECT_EQ(300, network.getStep());
+			network.update(600);
+		}
+
+		Parameters given(drawn);
+		given.set("seed", "8");
+		EXPECT_THROW(Network("checkpoint_unittest_given.txt", given), std::runtime_error);
+
+		std::ostringstream alone, restored;
+		alone << std::ifstream("checkpoint_unittest_alone.txt").rdbuf();
+		restored << std::ifstream("checkpoint_unittest_restored.txt").rdbuf();
+
+		EXPECT_GT(restored.str().size(), 1000u);
+		ASSERT_GT(alone.str().size(), restored.str().size());
+		EXPECT_EQ(0, alone.str().compare(alone.str().size() - restored.str().size(), std::string::npos, restored.str()));
+
+		std::remove("checkpoint_unittest_alone.txt");
+		std::remove("checkpoint_unittest_restored.txt");
+		std::remove("checkpoint_unittest_given.txt");
+		std::remove("checkpoint_unittest.chk");
+	}
+}
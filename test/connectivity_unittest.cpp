@@ -0,0 +1,466 @@
+/**
+ * @file   connectivity_unittest.cpp
+ * @author Jonathan Haab
+ * @date   Automn, 2017
+ * @brief  Contains the googletests of the stored and regenerated connections
+ */
+
+
+#include "connectivity.hpp"
+#include "proceduralConnectivity.hpp"
+#include "network.hpp"
+#include "gtest/gtest.h"
+#include <vector>
+#include <string>
+#include <fstream>
+#include <sstream>
+#include <cstdio>
+#include <random>
+#include <algorithm>
+
+/** CompressedRows
+ *  @test CompressedRows
+ *  @note counts then adds 5 connections between 4 neurons
+ *  @brief the targets of each neuron should be contiguous and in the order they were added
+ *  @throw error if a target is missing or misplaced
+ */
+TEST (Connectivity, CompressedRows) {
+
+	Connectivity connections;
+	int sources[5] = {2, 0, 2, 3, 2};
+	int targets[5] = {0, 1, 1, 2, 3};
+
+	connections.reset(4);
+	for(int k(0); k < 5; ++k) connections.count(sources[k]);
+	connections.allocate();
+	for(int k(0); k < 5; ++k) connections.add(sources[k], targets[k]);
+
+	EXPECT_EQ(5u, connections.size());
+	EXPECT_EQ(1u, connections.targetsOf(0).size());
+	EXPECT_EQ(0u, connections.targetsOf(1).size());
+	ASSERT_EQ(3u, connections.targetsOf(2).size());
+	EXPECT_EQ(0, connections.targetsOf(2).first[0]);
+	EXPECT_EQ(1, connections.targetsOf(2).first[1]);
+	EXPECT_EQ(3, connections.targetsOf(2).first[2]);
+	EXPECT_EQ(2, *connections.targetsOf(3).first);
+}
+
+/** ParallelBuild
+ *  @test ParallelBuild
+ *  @note builds the connections of 1000 targets with 50 random sources each, in the
+ *  	  order of the targets with count and add, then with build by 1 and 3 threads
+ *  @brief every build should give the same rows, with the same delays
+ *  @throw error if a target or a delay differs
+ */
+TEST (Connectivity, ParallelBuild) {
+
+	const int neurons(1000), inputs(50);
+	std::mt19937 generator(5);
+	std::uniform_int_distribution<> source(0, neurons - 1);
+	std::vector<int> sources(neurons*inputs);
+	std::vector<uint8_t> delays(sources.size());
+	for(size_t k(0); k < sources.size(); ++k){
+		sources[k] = source(generator);
+		delays[k] = uint8_t(k%7);
+	}
+
+	Connectivity added;
+	added.reset(neurons);
+	for(size_t k(0); k < sources.size(); ++k) added.count(sources[k]);
+	added.allocate(true);
+	for(size_t k(0); k < sources.size(); ++k) added.add(sources[k], k/inputs, delays[k]);
+
+	for(int threads(1); threads <= 3; threads += 2){
+
+		WorkerPool workers(threads);
+		Connectivity built;
+		built.reset(neurons);
+		built.build(workers, neurons, inputs, sources.data(), delays.data());
+
+		ASSERT_EQ(added.size(), built.size());
+		for(int i(0); i < neurons; ++i){
+			Span row(added.targetsOf(i));
+			ASSERT_EQ(std::vector<int>(row.first, row.last), std::vector<int>(built.targetsOf(i).first, built.targetsOf(i).last));
+			EXPECT_TRUE(std::equal(added.delaysOf(i), added.delaysOf(i) + row.size(), built.delaysOf(i)));
+		}
+	}
+}
+
+/** CompressedTargets
+ *  @test CompressedTargets
+ *  @note adds the same connections of 3 sources to 200000 targets in 32 bits and in 16 bits,
+ *  	  then saves each one and restores it the other way
+ *  @brief the 4 segments of 65536 targets should give back every target in the same order,
+ *  	   with its delay
+ *  @throw error if a target or a delay differs
+ */
+TEST (Connectivity, CompressedTargets) {
+
+	const int targets(200000);
+	int sources[6] = {0, 2, 0, 2, 2, 0};
+	int ids[6] = {5, 70000, 65536, 131071, 199999, 199998};
+	uint8_t delays[6] = {1, 2, 3, 4, 5, 6};
+
+	Connectivity plain, compressed;
+	plain.reset(3);
+	compressed.reset(3);
+	for(int k(0); k < 6; ++k){
+		plain.count(sources[k]);
+		compressed.count(sources[k]);
+	}
+	plain.allocate(true);
+	compressed.allocate(true, targets);
+	for(int k(0); k < 6; ++k){
+		plain.add(sources[k], ids[k], delays[k]);
+		compressed.add(sources[k], ids[k], delays[k]);
+	}
+
+	EXPECT_EQ(0, plain.segments());
+	ASSERT_EQ(4, compressed.segments());
+
+	// Chaque forme est relue dans l'autre : les cibles sont converties
+	Connectivity fromPlain, fromCompressed;
+	CheckpointWriter plainOut, compressedOut;
+	plain.save(plainOut);
+	compressed.save(compressedOut);
+	plainOut.write("connectivity_unittest_plain.chk", 0);
+	compressedOut.write("connectivity_unittest_compressed.chk", 0);
+	{
+		CheckpointReader in("connectivity_unittest_plain.chk");
+		fromPlain.restore(in, 3, true, targets);
+	}
+	{
+		CheckpointReader in("connectivity_unittest_compressed.chk");
+		fromCompressed.restore(in, 3, true, 0);
+	}
+	std::remove("connectivity_unittest_plain.chk");
+	std::remove("connectivity_unittest_compressed.chk");
+	ASSERT_EQ(4, fromPlain.segments());
+	EXPECT_EQ(0, fromCompressed.segments());
+
+	for(int source(0); source < 3; ++source){
+
+		Span row(plain.targetsOf(source));
+		std::vector<int> decoded, restored;
+		for(int segment(0); segment < fromPlain.segments(); ++segment){
+			ShortSpan part(fromPlain.shortTargetsOf(source, segment));
+			for(const uint16_t* target(part.first); target != part.last; ++target) decoded.push_back(part.base + *target);
+			EXPECT_TRUE(compressed.shortTargetsOf(source, segment).size() == part.size());
+		}
+
+		EXPECT_EQ(std::vector<int>(row.first, row.last), decoded);
+		EXPECT_EQ(std::vector<int>(row.first, row.last), std::vector<int>(fromCompressed.targetsOf(source).first, fromCompressed.targetsOf(source).last));
+		for(size_t k(0); k < row.size(); ++k){
+			EXPECT_EQ(plain.delaysOf(source)[k], compressed.delaysOf(source)[k]);
+			EXPECT_EQ(plain.delaysOf(source)[k], fromCompressed.delaysOf(source)[k]);
+		}
+	}
+	EXPECT_EQ(2u, compressed.shortTargetsOf(2, 1).size());
+	EXPECT_EQ(0u, compressed.shortTargetsOf(1, 0).size());
+}
+
+/** ProceduralIsReproducible
+ *  @test ProceduralIsReproducible
+ *  @note draws the targets of the same neuron twice, as a whole and by ranges
+ *  @brief the targets should be the same every time, sorted, and a range should be a slice of the whole
+ *  @throw error if two draws differ
+ */
+TEST (Connectivity, ProceduralIsReproducible) {
+
+	ProceduralConnectivity connections(42, 5000, 4000, 400, 100);
+	std::vector<int> all, again, range, slice;
+
+	for(int source(0); source < 5000; source += 499){
+
+		connections.targetsOf(source, 0, 5000, all);
+		connections.targetsOf(source, 0, 5000, again);
+		EXPECT_EQ(all, again);
+
+		for(size_t k(1); k < all.size(); ++k){
+			EXPECT_LT(all[k-1], all[k]);
+		}
+
+		connections.targetsOf(source, 1500, 3100, range);
+		slice.clear();
+		for(size_t k(0); k < all.size(); ++k){
+			if(all[k] >= 1500 and all[k] < 3100) slice.push_back(all[k]);
+		}
+		EXPECT_EQ(slice, range);
+	}
+}
+
+/** ProceduralDelays
+ *  @test ProceduralDelays
+ *  @note draws the targets of the same neurons with a delay spread of 9 steps, as a whole and by ranges
+ *  @brief each target should have a delay in [0, 9], the same in a range, and every delay should be drawn
+ *  @throw error if a delay is missing, out of the spread or differs in a range
+ */
+TEST (Connectivity, ProceduralDelays) {
+
+	ProceduralConnectivity connections(42, 5000, 4000, 400, 100, 9);
+	std::vector<int> all, range;
+	std::vector<uint8_t> allDelays, rangeDelays;
+	std::vector<int> histogram(10, 0);
+
+	for(int source(0); source < 5000; source += 499){
+
+		connections.targetsOf(source, 0, 5000, all, &allDelays);
+		ASSERT_EQ(all.size(), allDelays.size());
+		for(size_t k(0); k < allDelays.size(); ++k){
+			ASSERT_LE(allDelays[k], 9);
+			++histogram[allDelays[k]];
+		}
+
+		connections.targetsOf(source, 1500, 3100, range, &rangeDelays);
+		ASSERT_EQ(range.size(), rangeDelays.size());
+		for(size_t k(0), r(0); k < all.size(); ++k){
+			if(all[k] >= 1500 and all[k] < 3100){
+				EXPECT_EQ(allDelays[k], rangeDelays[r++]);
+			}
+		}
+	}
+
+	for(int delay(0); delay <= 9; ++delay) EXPECT_GT(histogram[delay], 0);
+
+	// Sans étalement, aucun délai n'est tiré
+	ProceduralConnectivity homogeneous(42, 5000, 4000, 400, 100);
+	homogeneous.targetsOf(0, 0, 5000, all, &allDelays);
+	EXPECT_TRUE(allDelays.empty());
+}
+
+/** ProceduralInputs
+ *  @test ProceduralInputs
+ *  @note regenerates a whole network of 2000 neurons (1600 excitatory)
+ *  @brief every neuron should get on average C_e = 160 excitatory and C_i = 40 inhibitory inputs
+ *  @throw error if the mean numbers of inputs are more than 1% away
+ */
+TEST (Connectivity, ProceduralInputs) {
+
+	const int n(2000), nE(1600);
+	ProceduralConnectivity connections(7, n, nE, 160, 40);
+	std::vector<int> targets;
+	double excitatory(0), inhibitory(0);
+
+	for(int source(0); source < n; ++source){
+		connections.targetsOf(source, 0, n, targets);
+		(source < nE ? excitatory : inhibitory) += targets.size();
+	}
+
+	EXPECT_NEAR(160, excitatory/n, 1.6);
+	EXPECT_NEAR(40, inhibitory/n, 0.4);
+}
+
+/** BlockedDelivery
+ *  @test BlockedDelivery
+ *  @note simulates 30 ms of a network of 20000 neurons, whose partitions are
+ *  	  delivered in several blocks of targets, with 1 and 3 threads, alone and
+ *  	  in a batch of two instances, for both connectivities
+ *  @brief the blocks change with the threads and the instances but every
+ *  	   spike file should be exactly the same
+ *  @throw error if a spike differs
+ */
+TEST (Connectivity, BlockedDelivery) {
+
+	for(int mode(STORED); mode < connectivityModeSize; ++mode){
+
+		Parameters parameters;
+		parameters.N = 20000;
+		parameters.connectionRatio = 0.005;
+		parameters.connectivity = ConnectivityMode(mode);
+		parameters.seed = 11;
+		parameters.plotStartTime = 0;
+		parameters.plotStopTime = 1e9;
+		parameters.format = BINARY;
+
+		const char* files[3] = {"connectivity_unittest_alone.bin", "connectivity_unittest_threads.bin", "connectivity_unittest_batch.bin"};
+		for(int run(0); run < 3; ++run){
+
+			Parameters variant(parameters);
+			if(run == 1) variant.threads = 3;
+			if(run == 2) variant.set("batch", "5:2,4:1");
+			if(run != 2) variant.set("batch", "5:2");
+
+			Network network(files[run], variant);
+			network.update(300);
+		}
+
+		std::ostringstream alone, threads, batch;
+		alone << std::ifstream(files[0]).rdbuf();
+		threads << std::ifstream(files[1]).rdbuf();
+		batch << std::ifstream("connectivity_unittest_batch_0.bin").rdbuf();
+
+		EXPECT_GT(alone.str().size(), 1000u);
+		EXPECT_TRUE(alone.str() == threads.str());
+		EXPECT_TRUE(alone.str() == batch.str());
+
+		std::remove(files[0]);
+		std::remove(files[1]);
+		std::remove("connectivity_unittest_batch_0.bin");
+		std::remove("connectivity_unittest_batch_1.bin");
+	}
+}
+
+/** DelayedDelivery
+ *  @test DelayedDelivery
+ *  @note simulates 30 ms of a network of 10000 neurons whose inhibitory projection is
+ *  	  faster (4 steps) and whose synapses add up to 6 steps, with 1 and 3 threads,
+ *  	  in a batch, step by step, and restored from a checkpoint, for both connectivities
+ *  @brief the window should be the inhibitory delay, every spike file should be exactly
+ *  	   the same and the restored one should be the end of the others
+ *  @throw error if a spike differs
+ */
+TEST (Connectivity, DelayedDelivery) {
+
+	for(int mode(STORED); mode < connectivityModeSize; ++mode){
+
+		Parameters parameters;
+		parameters.N = 10000;
+		parameters.connectionRatio = 0.005;
+		parameters.connectivity = ConnectivityMode(mode);
+		parameters.seed = 11;
+		parameters.plotStartTime = 0;
+		parameters.plotStopTime = 1e9;
+		parameters.inhibitoryDelay = 4;
+		parameters.delaySpread = 6;
+
+		const char* files[5] = {"connectivity_unittest_alone.txt", "connectivity_unittest_threads.txt", "connectivity_unittest_batch.txt",
+								"connectivity_unittest_steps.txt", "connectivity_unittest_restored.txt"};
+		for(int run(0); run < 5; ++run){
+
+			Parameters variant(parameters);
+			if(run == 1) variant.threads = 3;
+			if(run == 2) variant.set("batch", "5:2,4:1");
+			if(run != 2) variant.set("batch", "5:2");
+			if(run == 3) variant.timeBlocked = false;
+			if(run == 4) variant.restore = "connectivity_unittest.chk";
+
+			// Le checkpoint garde le délai de chaque synapse et les EPSP en route au-delà de la fenêtre
+			Network network(files[run], variant);
+			EXPECT_EQ(4, network.getWindow());
+			if(run == 0){
+				network.update(150);
+				network.save("connectivity_unittest.chk");
+			}
+			network.update(300);
+		}
+
+		std::ostringstream alone, threads, batch, steps, restored;
+		alone << std::ifstream(files[0]).rdbuf();
+		threads << std::ifstream(files[1]).rdbuf();
+		batch << std::ifstream("connectivity_unittest_batch_0.txt").rdbuf();
+		steps << std::ifstream(files[3]).rdbuf();
+		restored << std::ifstream(files[4]).rdbuf();
+
+		EXPECT_GT(restored.str().size(), 1000u);
+		ASSERT_GT(alone.str().size(), restored.str().size());
+		EXPECT_TRUE(alone.str() == threads.str());
+		EXPECT_TRUE(alone.str() == batch.str());
+		EXPECT_TRUE(alone.str() == steps.str());
+		EXPECT_EQ(0, alone.str().compare(alone.str().size() - restored.str().size(), std::string::npos, restored.str()));
+
+		for(int run(0); run < 5; ++run) std::remove(files[run]);
+		std::remove("connectivity_unittest_batch_0.txt");
+		std::remove("connectivity_unittest_batch_1.txt");
+		std::remove("connectivity_unittest.chk");
+	}
+}
+
+/** CompressedDelivery
+ *  @test CompressedDelivery
+ *  @note simulates 10 ms of a network of 140000 neurons (3 segments of targets) with delays,
+ *  	  whose targets are kept in 32 bits, then in 16 bits with 1 and 3 threads
+ *  @brief the targets are only encoded differently : every spike file should be exactly the same
+ *  @throw error if a spike differs
+ */
+TEST (Connectivity, CompressedDelivery) {
+
+	Parameters parameters;
+	parameters.N = 140000;
+	parameters.connectionRatio = 0.0005;
+	parameters.seed = 11;
+	parameters.plotStartTime = 0;
+	parameters.plotStopTime = 1e9;
+	parameters.format = BINARY;
+	parameters.delaySpread = 3;
+	parameters.set("batch", "5:2");
+
+	const char* files[3] = {"connectivity_unittest_plain.bin", "connectivity_unittest_short.bin", "connectivity_unittest_threads.bin"};
+	size_t bytes[2] = {0, 0};
+	for(int run(0); run < 3; ++run){
+
+		Parameters variant(parameters);
+		variant.compressTargets = run > 0;
+		if(run == 2) variant.threads = 3;
+
+		Network network(files[run], variant);
+		network.update(100);
+		if(run < 2) bytes[run] = network.getConnectionBytes();
+	}
+	EXPECT_LT(bytes[1], 0.8*bytes[0]);
+
+	std::ostringstream plain, compressed, threads;
+	plain << std::ifstream(files[0]).rdbuf();
+	compressed << std::ifstream(files[1]).rdbuf();
+	threads << std::ifstream(files[2]).rdbuf();
+
+	EXPECT_GT(plain.str().size(), 100u);
+	EXPECT_TRUE(plain.str() == compressed.str());
+	EXPECT_TRUE(plain.str() == threads.str());
+
+	for(int run(0); run < 3; ++run) std::remove(files[run]);
+}
+
+/** ConnectivityCache
+ *  @test ConnectivityCache
+ *  @note simulates 30 ms of a network of 2000 neurons without cache, then twice with
+ *  	  a connectivity cache : the first run draws and saves the connections, the second
+ *  	  one maps them. A cache of 32 bits targets cannot be mapped with 16 bits targets
+ *  @brief the three spike files should be exactly the same
+ *  @throw error if a spike differs or the connections are not mapped
+ */
+TEST (Connectivity, ConnectivityCache) {
+
+	Parameters parameters;
+	parameters.N = 2000;
+	parameters.seed = 13;
+	parameters.plotStartTime = 0;
+	parameters.plotStopTime = 1e9;
+	parameters.format = BINARY;
+	parameters.delaySpread = 2;
+	parameters.set("batch", "5:2");
+
+	const char* files[3] = {"connectivity_unittest_drawn.bin", "connectivity_unittest_saved.bin", "connectivity_unittest_mapped.bin"};
+	std::string cache("connectivity_unittest_cache");
+	std::string cached;
+	for(int run(0); run < 3; ++run){
+
+		Parameters variant(parameters);
+		if(run > 0) variant.connectivityCache = cache;
+
+		Network network(files[run], variant);
+		EXPECT_EQ(run > 0, network.isConnectionMapped());
+		network.update(300);
+	}
+
+	std::ostringstream drawn, saved, mapped;
+	drawn << std::ifstream(files[0]).rdbuf();
+	saved << std::ifstream(files[1]).rdbuf();
+	mapped << std::ifstream(files[2]).rdbuf();
+
+	EXPECT_GT(drawn.str().size(), 100u);
+	EXPECT_TRUE(drawn.str() == saved.str());
+	EXPECT_TRUE(drawn.str() == mapped.str());
+
+	// Le fichier est lu tel quel : des cibles de 32 bits ne sont pas lues en 16 bits
+	std::string file(cache + "/connections_v1_N2000_Ne1600_Ce160_Ci40_seed13_spread2_32bits_0-2000.ckpt");
+	std::shared_ptr<const CheckpointReader> in(std::make_shared<const CheckpointReader>(file));
+	Connectivity connections;
+	EXPECT_THROW(connections.map(in, parameters.N, true, parameters.N), std::runtime_error);
+	connections.map(in, parameters.N, true);
+	EXPECT_TRUE(connections.isMapped());
+	EXPECT_EQ(size_t(parameters.N)*(parameters.C_e() + parameters.C_i()), connections.size());
+
+	for(int run(0); run < 3; ++run) std::remove(files[run]);
+	std::remove(file.c_str());
+	std::remove(cache.c_str());
+}
@@ -0,0 +1,80 @@
+/**
+ * @file   integrationKernel_unittest.cpp
+ * @author Jonathan Haab
+ * @date   Automn, 2017
+ * @brief  Contains the googletests of the vectorized integration kernels
+ */
+
+
+#include "integrationKernel.hpp"
+#include "gtest/gtest.h"
+#include <vector>
+
+/** MatchesScalarUpdateTest
+ *  @test MatchesScalarUpdateTest
+ *  @note integrates 37 neurons (not a multiple of any vector width) getting
+ *  	  currents around 1.0 and EPSP, with every kernel supported by the cpu
+ *  @brief the potentials and the spikes should be exactly the ones given by
+ *  	   the scalar algorithm of Neuron::updateTest
+ *  @throw error if one potential differs by a single bit or if the spikes differ
+ */
+TEST (IntegrationKernel, MatchesScalarUpdateTest) {
+
+	const int n(37);
+	const int steps(3000);
+
+	for(int k(SCALAR); k < kernelTypeSize; ++k){
+
+		KernelType kernel(static_cast<KernelType>(k));
+		if(not isSupported(kernel)) continue;
+
+		std::vector<double> v(n, v_res), refractory(n, 0), input(n, 0), drive(n);
+		std::vector<int> spiking(n);
+
+		// reference : the algorithm of Neuron::updateTest, one neuron at a time
+		std::vector<double> vRef(n, v_res), inputRef(n, 0);
+		std::vector<long> lastRef(n, -1);
+
+		for(int i(0); i < n; ++i){
+			drive[i] = c2*(0.99 + 0.001*i);
+		}
+
+		for(int step(0); step < steps; ++step){
+
+			if(step%7 == 0){
+				for(int i(0); i < n; i += 3){
+					input[i] += (i%2 ? J_i : J_e);
+					inputRef[i] += (i%2 ? J_i : J_e);
+				}
+			}
+
+			std::vector<int> spikingRef;
+			for(int i(0); i < n; ++i){
+				if(lastRef[i] < 0 or std::abs(lastRef[i] - step) > refractorySteps){
+					vRef[i] = c1*vRef[i] + drive[i] + inputRef[i];
+					if(vRef[i] > v_th){
+						vRef[i] = v_res;
+						lastRef[i] = step;
+						spikingRef.push_back(i);
+					}
+				} else {
+					vRef[i] = v_res;
+				}
+				inputRef[i] = 0;
+			}
+
+			IntegrationArgs args = {n, v.data(), refractory.data(), input.data(), drive.data(), spiking.data(),
+									MembraneConstants::defaults()};
+			int count(integrate(kernel, args));
+
+			ASSERT_EQ(spikingRef.size(), size_t(count)) << kernelName(kernel) << " at step " << step;
+			for(int s(0); s < count; ++s){
+				EXPECT_EQ(spikingRef[s], spiking[s]) << kernelName(kernel);
+			}
+			for(int i(0); i < n; ++i){
+				ASSERT_EQ(vRef[i], v[i]) << kernelName(kernel) << " neuron " << i << " at step " << step;
+				EXPECT_EQ(0, input[i]);
+			}
+		}
+	}
+}
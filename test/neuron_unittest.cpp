@@ -427,3 +427,29 @@ TEST (Neurontest, InhibitoryInhibitoryInducedSpike) {
 		EXPECT_FALSE(neuron2.updateTest(imputCurrent2, i));
 	}
 }
+
+/** CopyIsIndependent
+ *  @test CopyIsIndependent
+ *  @note copies a neuron driven by a current of 1.01 for 500 steps, then updates the copy
+ *  	  alone, then both of them with their external input
+ *  @brief the original should not move while the copy is updated, then both should stay equal
+ *  @throw error if the copy changes the original or if they differ
+ */
+TEST (Neurontest, CopyIsIndependent) {
+	
+	Neuron original(EXCITATORY, 7);
+	for(int i(0); i < 500; ++i) original.updateTest(1.01, i);
+	double v(original.getV());
+	
+	Neuron copy(original);
+	for(int i(500); i < 1000; ++i) copy.updateTest(1.01, i);
+	EXPECT_EQ(v, original.getV());
+	EXPECT_NE(v, copy.getV());
+	
+	copy = original;
+	for(int i(500); i < 1500; ++i){
+		original.update(i);
+		copy.update(i);
+	}
+	EXPECT_EQ(original.getV(), copy.getV());
+}
@@ -0,0 +1,95 @@
+/**
+ * @file   parameters_unittest.cpp
+ * @author Jonathan Haab
+ * @date   Automn, 2017
+ * @brief  Contains the googletests of the runtime parameters
+ */
+
+
+#include "parameters.hpp"
+#include "gtest/gtest.h"
+#include <sstream>
+#include <stdexcept>
+#include <cstdio>
+#include <fstream>
+
+/** DefaultsAreConstants
+ *  @test DefaultsAreConstants
+ *  @note builds the parameters without any argument
+ *  @brief the derived values should be the ones of constants.hpp
+ *  @throw error if one of them differs
+ */
+TEST (Parameters, DefaultsAreConstants) {
+
+	Parameters parameters;
+
+	EXPECT_EQ(N_e, parameters.N_e());
+	EXPECT_EQ(N_i, parameters.N_i());
+	EXPECT_EQ(C_e, parameters.C_e());
+	EXPECT_EQ(C_i, parameters.C_i());
+	EXPECT_DOUBLE_EQ(c1, parameters.c1());
+	EXPECT_DOUBLE_EQ(c2, parameters.c2());
+	EXPECT_EQ(long(total_steps), parameters.totalSteps());
+}
+
+/** ParseAndLoad
+ *  @test ParseAndLoad
+ *  @note writes parameters in a file, reads it back with --config and changes one value after it
+ *  @brief every value should be read back, the last argument wins, and bad arguments throw
+ *  @throw error if a value is lost or an invalid argument is accepted
+ */
+TEST (Parameters, ParseAndLoad) {
+
+	Parameters written;
+	written.N = 500;
+	written.lambda = 1.5;
+	written.connectivity = PROCEDURAL;
+
+	const char* file("parameters_unittest.cfg");
+	{
+		std::ofstream out(file);
+		out << "# written by the test\n";
+		written.write(out);
+	}
+
+	char program[] = "Neurons", config[] = "--config=parameters_unittest.cfg", threads[] = "--threads", four[] = "4";
+	char* argv[] = {program, config, threads, four};
+
+	Parameters parameters;
+	parameters.parse(4, argv);
+	std::remove(file);
+
+	EXPECT_EQ(500, parameters.N);
+	EXPECT_DOUBLE_EQ(1.5, parameters.lambda);
+	EXPECT_EQ(PROCEDURAL, parameters.connectivity);
+	EXPECT_EQ(4, parameters.threads);
+	EXPECT_FALSE(parameters.randomSeed);
+
+	EXPECT_THROW(parameters.set("unknown", "1"), std::invalid_argument);
+	EXPECT_THROW(parameters.set("N", "12abc"), std::invalid_argument);
+	EXPECT_THROW(parameters.set("h", "-0.1"), std::invalid_argument);
+}
+
+/** SynapticDelays
+ *  @test SynapticDelays
+ *  @note an inhibitory projection faster than the excitatory one, and a spread of 6 steps
+ *  @brief the window should be the shortest delay and the ring hold the longest, a spread above 255 throws
+ *  @throw error if a delay is wrong or an invalid spread is accepted
+ */
+TEST (Parameters, SynapticDelays) {
+
+	Parameters parameters;
+	EXPECT_EQ(parameters.bufferDelay, parameters.projectionDelay(false));
+	EXPECT_EQ(parameters.bufferDelay, parameters.minDelay());
+	EXPECT_EQ(parameters.bufferDelay, parameters.maxDelay());
+
+	parameters.set("inhibitoryDelay", "4");
+	parameters.set("delaySpread", "6");
+	EXPECT_EQ(parameters.bufferDelay, parameters.projectionDelay(true));
+	EXPECT_EQ(4, parameters.projectionDelay(false));
+	EXPECT_EQ(4, parameters.minDelay());
+	EXPECT_EQ(parameters.bufferDelay + 6, parameters.maxDelay());
+
+	EXPECT_THROW(parameters.set("delaySpread", "256"), std::invalid_argument);
+	EXPECT_THROW(parameters.set("inhibitoryDelay", "-1"), std::invalid_argument);
+}
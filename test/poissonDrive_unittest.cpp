@@ -0,0 +1,90 @@
+/**
+ * @file   poissonDrive_unittest.cpp
+ * @author Jonathan Haab
+ * @date   Automn, 2017
+ * @brief  Contains the googletests of the counter-based external input
+ */
+
+
+#include "poissonDrive.hpp"
+#include "neuronPopulation.hpp"
+#include "gtest/gtest.h"
+#include <vector>
+#include <cmath>
+
+/** PoissonStatistics
+ *  @test PoissonStatistics
+ *  @note draws the external spikes of 1000 neurons during 200 steps
+ *  @brief the mean and the variance should be lambda and no spike should happen with probability exp(-lambda)
+ *  @throw error if one of them is more than 1% away
+ */
+TEST (PoissonDrive, PoissonStatistics) {
+
+	PoissonDrive external(2017, lambda, 1.0);
+	std::vector<double> drive(1000);
+	double sum(0), squares(0), zeros(0), count(0);
+
+	for(long step(0); step < 200; ++step){
+		external.fill(step, 0, 1000, drive.data());
+		for(size_t i(0); i < drive.size(); ++i){
+			sum += drive[i];
+			squares += drive[i]*drive[i];
+			zeros += (drive[i] == 0);
+			count += 1;
+		}
+	}
+
+	double mean(sum/count);
+	EXPECT_NEAR(lambda, mean, 0.01*lambda);
+	EXPECT_NEAR(lambda, squares/count - mean*mean, 0.01*lambda);
+	EXPECT_NEAR(exp(-lambda), zeros/count, 0.01*exp(-lambda));
+}
+
+/** SameInputForAnyRange
+ *  @test SameInputForAnyRange
+ *  @note draws the inputs of the same neurons as a whole and by unaligned ranges
+ *  @brief the input of a neuron should only depend on the seed, the neuron and the step
+ *  @throw error if one input differs
+ */
+TEST (PoissonDrive, SameInputForAnyRange) {
+
+	PoissonDrive external(99, lambda, J_e);
+	std::vector<double> whole(1000), parts(1000);
+
+	external.fill(12, 0, 1000, whole.data());
+	external.fill(12, 0, 3, parts.data());
+	external.fill(12, 3, 517, parts.data() + 3);
+	external.fill(12, 517, 1000, parts.data() + 517);
+
+	EXPECT_EQ(whole, parts);
+}
+
+/** SameSpikesForAnyPartition
+ *  @test SameSpikesForAnyPartition
+ *  @note integrates two populations of 500 neurons with the same seed, one as a single partition and one as 3
+ *  @brief the potentials and the spikes should be exactly the same
+ *  @throw error if one potential or one spike differs
+ */
+TEST (PoissonDrive, SameSpikesForAnyPartition) {
+
+	NeuronPopulation whole(500, 400, 5), split(500, 400, 5);
+	split.setPartitions(3);
+	std::vector<int> wholeSpikes, splitSpikes;
+
+	for(long step(0); step < 3000; ++step){
+
+		whole.update(step + 1, wholeSpikes);
+		for(int p(0); p < 3; ++p){
+			split.integratePartition(p, step, splitSpikes);
+		}
+		split.setStep(step + 1);
+	}
+
+	EXPECT_FALSE(wholeSpikes.empty());
+	EXPECT_EQ(wholeSpikes.size(), splitSpikes.size());
+	for(int i(0); i < 500; ++i){
+		EXPECT_EQ(whole.getV(i), split.getV(i));
+		SpikeTimes wholeTimes(whole.getSpikesTime(i)), splitTimes(split.getSpikesTime(i));
+		EXPECT_EQ(std::vector<long>(wholeTimes.begin(), wholeTimes.end()), std::vector<long>(splitTimes.begin(), splitTimes.end()));
+	}
+}
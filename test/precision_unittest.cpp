@@ -0,0 +1,217 @@
+/**
+ * @file   precision_unittest.cpp
+ * @author Jonathan Haab
+ * @date   Automn, 2017
+ * @brief  Contains the googletests of the float and fixed point precisions
+ */
+
+
+#include "precision.hpp"
+#include "integrationKernel.hpp"
+#include "accuracy.hpp"
+#include "gtest/gtest.h"
+#include <vector>
+#include <cstdio>
+#include <cmath>
+#include <stdexcept>
+
+/** CellConversions
+ *  @test CellConversions
+ *  @note sets, adds and reads cells in every precision, then saves them in
+ *  	  float and restores them in double and in fixed point
+ *  @brief the cells should keep the values within the resolution of their
+ *  	   precision, exactly in fixed point for a sum of cell values, and a
+ *  	   checkpoint should be converted to the precision that restores it
+ *  @throw error if a value is further than the resolution or the conversion fails
+ */
+TEST (Precision, CellConversions) {
+
+	const double resolution[] = {0, 1e-6*20, 1/fixedScale};
+
+	for(int p(0); p < precisionSize; ++p){
+
+		Precision precision(static_cast<Precision>(p));
+		CellArray cells(precision, 100);
+		cells.fill(10);
+
+		for(size_t i(0); i < cells.size(); ++i){
+			cells.add(i, 0.1*i);
+			EXPECT_NEAR(10 + 0.1*i, cells.get(i), resolution[p]*(1 + i)) << precisionName(precision);
+		}
+		EXPECT_EQ(cellBytes(precision), cells.cellSize());
+	}
+
+	// Chaque EPSP est arrondi une fois : en virgule fixe leur somme est exacte, dans n'importe quel ordre
+	CellArray fixed(FIXED_POINT, 2);
+	fixed.fill(0);
+	for(int k(0); k < 1000; ++k) fixed.add(0, k%5 ? 0.1 : -0.5);
+	for(int k(999); k >= 0; --k) fixed.add(1, k%5 ? 0.1 : -0.5);
+	EXPECT_EQ(fixed.get(0), fixed.get(1));
+	EXPECT_EQ((800*cellUnits(FIXED_POINT, 0.1) + 200*cellUnits(FIXED_POINT, -0.5))/fixedScale, fixed.get(0));
+
+	CellArray saved(SINGLE_PRECISION, 3);
+	saved.set(0, -70.25);
+	saved.set(1, 0.1);
+	saved.set(2, 19.999);
+
+	const std::string file("precision_unittest.ckpt");
+	CheckpointWriter out;
+	saved.save(out, "v");
+	out.write(file, 42);
+
+	{
+		CheckpointReader in(file);
+		EXPECT_TRUE(in.has("v.float"));
+
+		CellArray exact(DOUBLE_PRECISION, 3), fixedV(FIXED_POINT, 3), tooLong(DOUBLE_PRECISION, 4);
+		exact.restore(in, "v");
+		fixedV.restore(in, "v");
+
+		for(size_t i(0); i < 3; ++i){
+			EXPECT_EQ(saved.get(i), exact.get(i));
+			EXPECT_NEAR(saved.get(i), fixedV.get(i), 1/fixedScale);
+		}
+		EXPECT_THROW(tooLong.restore(in, "v"), std::runtime_error);
+		EXPECT_THROW(exact.restore(in, "ringBuffer"), std::runtime_error);
+	}
+	std::remove(file.c_str());
+}
+
+/** kernelsMatchScalar
+ *
+ * @note integrates 37 neurons getting currents around 1.0 and EPSP in Cell
+ * 		 with every kernel supported by the cpu and with the scalar kernel
+ */
+template<typename Cell>
+static void kernelsMatchScalar()
+{
+	const int n(37);
+	const int steps(3000);
+	const Precision precision(CellTraits<Cell>::precision);
+
+	for(int k(SCALAR + 1); k < kernelTypeSize; ++k){
+
+		KernelType kernel(static_cast<KernelType>(k));
+		if(not isSupported(kernel)) continue;
+
+		std::vector<Cell> v(n, CellTraits<Cell>::encode(v_res)), input(n, 0), vRef(v), inputRef(input);
+		std::vector<typename CellTraits<Cell>::Real> refractory(n, 0), refractoryRef(n, 0), drive(n);
+		std::vector<int> spiking(n), spikingRef(n);
+
+		for(int i(0); i < n; ++i){
+			drive[i] = c2*(0.99 + 0.001*i);
+		}
+
+		for(int step(0); step < steps; ++step){
+
+			if(step%7 == 0){
+				for(int i(0); i < n; i += 3){
+					input[i] += Cell(cellUnits(precision, i%2 ? J_i : J_e));
+					inputRef[i] += Cell(cellUnits(precision, i%2 ? J_i : J_e));
+				}
+			}
+
+			BasicIntegrationArgs<Cell> args = {n, v.data(), refractory.data(), input.data(), drive.data(), spiking.data(),
+											   MembraneConstants::defaults()};
+			BasicIntegrationArgs<Cell> argsRef = {n, vRef.data(), refractoryRef.data(), inputRef.data(), drive.data(), spikingRef.data(),
+												  MembraneConstants::defaults()};
+			int count(integrate(kernel, args));
+			int countRef(integrate(SCALAR, argsRef));
+
+			ASSERT_EQ(countRef, count) << kernelName(kernel) << " " << precisionName(precision) << " at step " << step;
+			for(int s(0); s < count; ++s){
+				EXPECT_EQ(spikingRef[s], spiking[s]) << kernelName(kernel);
+			}
+			for(int i(0); i < n; ++i){
+				ASSERT_EQ(vRef[i], v[i]) << kernelName(kernel) << " " << precisionName(precision) << " neuron " << i << " at step " << step;
+				EXPECT_EQ(0, input[i]);
+			}
+		}
+	}
+}
+
+/** KernelsMatchScalar
+ *  @test KernelsMatchScalar
+ *  @note integrates the same neurons in float and in fixed point with every
+ *  	  kernel supported by the cpu
+ *  @brief the vectorized conversions should round like the scalar ones : the
+ *  	   cells and the spikes should be exactly those of the scalar kernel
+ *  @throw error if one cell differs by a single bit or if the spikes differ
+ */
+TEST (Precision, KernelsMatchScalar) {
+
+	kernelsMatchScalar<float>();
+	kernelsMatchScalar<int32_t>();
+}
+
+/** UpdateTestDrift
+ *  @test UpdateTestDrift
+ *  @note the scenarios of the neuron tests : a current of 1.0, of 0, of 1.01,
+ *  	  and of 1.0 with EPSP, in float and in fixed point against double
+ *  @brief the potentials should stay within 1e-3 mV of double and every spike
+ *  	   should be at the same step
+ *  @throw error if a potential drifts further or a spike moves
+ */
+TEST (Precision, UpdateTestDrift) {
+
+	const double currents[] = {1.0, 0.0, 1.01, 1.0};
+	const int periods[] = {0, 0, 0, 7};
+	const Precision reduced[] = {SINGLE_PRECISION, FIXED_POINT};
+
+	for(Precision precision : reduced){
+		for(int s(0); s < 4; ++s){
+
+			PopulationDrift drift(populationDrift(precision, currents[s], periods[s], 16, 4000));
+
+			EXPECT_GT(1e-3, drift.maxV) << precisionName(precision) << " current " << currents[s];
+			EXPECT_EQ(drift.referenceSpikes, drift.spikes) << precisionName(precision) << " current " << currents[s];
+			EXPECT_EQ(0, drift.shifted) << precisionName(precision) << " current " << currents[s];
+		}
+		EXPECT_EQ(0, populationDrift(precision, 0.0, 0, 16, 100).maxV);
+	}
+
+	// La double est la référence : aucune dérive
+	PopulationDrift exact(populationDrift(DOUBLE_PRECISION, 1.0, 7, 16, 1000));
+	EXPECT_EQ(0, exact.maxV);
+	EXPECT_EQ(0, exact.shifted);
+}
+
+/** FiringDrift
+ *  @test FiringDrift
+ *  @note simulates a network of 2000 neurons for two seeds in every precision
+ *  @brief the rate and the CV of the excitatory neurons in float and in fixed
+ *  	   point should be within 5 % of those in double, and double should
+ *  	   not drift from itself
+ *  @throw error if a statistic differs more
+ */
+TEST (Precision, FiringDrift) {
+
+	Parameters parameters;
+	parameters.N = 2000;
+	parameters.batch = "5:2";
+	parameters.seed = 7;
+	parameters.randomSeed = false;
+	parameters.stopTime = 300;
+	parameters.plotStartTime = 100;
+	parameters.plotStopTime = 300;
+
+	std::vector<NetworkFiring> reference(networkFiring(parameters, 2));
+	ASSERT_LT(0, reference[0].excitatory.spikes);
+
+	std::vector<FiringDrift> same(firingDrift(reference, reference));
+	for(size_t k(0); k < same.size(); ++k){
+		EXPECT_EQ(0, same[k].relative);
+		EXPECT_EQ(0, same[k].z);
+	}
+
+	const Precision reduced[] = {SINGLE_PRECISION, FIXED_POINT};
+	for(Precision precision : reduced){
+
+		parameters.precision = precision;
+		std::vector<FiringDrift> drift(firingDrift(networkFiring(parameters, 2), reference));
+
+		ASSERT_EQ(3u, drift.size());
+		EXPECT_GT(0.05, std::fabs(drift[0].relative)) << precisionName(precision) << " rate";
+		EXPECT_GT(0.05, std::fabs(drift[1].relative)) << precisionName(precision) << " cv";
+	}
+}
@@ -0,0 +1,118 @@
+/**
+ * @file   profiler_unittest.cpp
+ * @author Jonathan Haab
+ * @date   Automn, 2017
+ * @brief  Contains the googletests of the profiler
+ */
+
+
+#include "profiler.hpp"
+#include "network.hpp"
+#include "gtest/gtest.h"
+#include <sstream>
+#include <fstream>
+#include <string>
+#include <stdexcept>
+#include <cstdio>
+
+/** countLines
+ *
+ * @param text 	a text
+ * @return the number of lines of text
+ */
+static int countLines(const std::string& text)
+{
+	int lines(0);
+	std::string line;
+	std::istringstream in(text);
+	while(std::getline(in, line)) ++lines;
+	return lines;
+}
+
+/** PhasesAndCounters
+ *  @test PhasesAndCounters
+ *  @note two threads time their phases and count their work during three windows
+ *  @brief the sums, the number of windows and the reports should match what was added
+ *  @throw error if a phase, a counter or a line of the reports is missing
+ */
+TEST (Profiler, PhasesAndCounters) {
+
+	Profiler profiler(2);
+	profiler.setTracing(true);
+
+	for(int window(0); window < 3; ++window){
+		for(int t(0); t < 2; ++t){
+			uint64_t since(Profiler::ticks());
+			since = profiler.lap(t, INTEGRATE, since - 1000);
+			profiler.lap(t, DELIVER, since - 10);
+			profiler.count(t, SYNAPTIC_EVENTS, 100);
+			profiler.endWindow(t, 15*window, 15, 4);
+		}
+	}
+
+	EXPECT_GE(profiler.getTicks(INTEGRATE), 6000u);
+	EXPECT_GE(profiler.getTicks(DELIVER), 60u);
+	EXPECT_EQ(0u, profiler.getTicks(EXCHANGE));
+	EXPECT_EQ(600u, profiler.getCount(SYNAPTIC_EVENTS));
+	EXPECT_EQ(3u, profiler.getCount(WINDOWS));
+	EXPECT_EQ(45u, profiler.getCount(STEPS));
+	EXPECT_EQ(24u, profiler.getCount(SPIKES));
+	EXPECT_GT(profiler.getTicksPerSecond(), 0);
+
+	std::ostringstream report, trace;
+	profiler.write(report, 123);
+	profiler.writeTrace(trace);
+
+	EXPECT_NE(std::string::npos, report.str().find("\"synapticEvents\": 600"));
+	EXPECT_NE(std::string::npos, report.str().find("\"bytesWritten\": 123"));
+	EXPECT_NE(std::string::npos, report.str().find("\"integrate\""));
+	EXPECT_EQ(4, countLines(trace.str()));
+	EXPECT_EQ(0u, trace.str().find("begin\tsteps\tspikes\tintegrate"));
+	EXPECT_NE(std::string::npos, trace.str().find("\n15\t15\t8\t"));
+}
+
+/** NetworkReport
+ *  @test NetworkReport
+ *  @note simulates 100 ms of a network of 1000 neurons with the report and the trace
+ *  @brief the reports should count the windows and the size of the spike file, a build
+ *  	   without NEURONS_PROFILE should refuse them
+ *  @throw error if a report is wrong, or accepted without the profiler
+ */
+TEST (Profiler, NetworkReport) {
+
+	Parameters parameters;
+	parameters.N = 1000;
+	parameters.connectionRatio = 0.1;
+	parameters.seed = 5;
+	parameters.threads = 2;
+	parameters.plotStartTime = 0;
+	parameters.plotStopTime = 1e9;
+	parameters.profile = "profiler_unittest.json";
+	parameters.profileTrace = "profiler_unittest_trace.txt";
+
+#ifdef NEURONS_PROFILE
+	{
+		Network network("profiler_unittest_spikes.txt", parameters);
+		network.update(1000);
+		network.writeProfile();
+	}
+
+	std::ostringstream report, trace;
+	report << std::ifstream("profiler_unittest.json").rdbuf();
+	trace << std::ifstream("profiler_unittest_trace.txt").rdbuf();
+	std::ifstream spikes("profiler_unittest_spikes.txt", std::ios::binary | std::ios::ate);
+
+	// 1000 steps en fenêtres de bufferDelay steps, et la ligne des titres
+	EXPECT_EQ(1 + (1000 + parameters.bufferDelay - 1)/parameters.bufferDelay, countLines(trace.str()));
+	EXPECT_NE(std::string::npos, report.str().find("\"steps\": 1000,"));
+	EXPECT_NE(std::string::npos, report.str().find("\"bytesWritten\": " + std::to_string(spikes.tellg())));
+	EXPECT_EQ(std::string::npos, report.str().find("\"synapticEvents\": 0,"));
+
+	std::remove("profiler_unittest.json");
+	std::remove("profiler_unittest_trace.txt");
+	std::remove("profiler_unittest_spikes.txt");
+#else
+	EXPECT_THROW(Network("profiler_unittest_spikes.txt", parameters), std::runtime_error);
+	std::remove("profiler_unittest_spikes.txt");
+#endif
+}
@@ -0,0 +1,129 @@
+/**
+ * @file   spikeFile_unittest.cpp
+ * @author Jonathan Haab
+ * @date   Automn, 2017
+ * @brief  Contains the googletests of the binary spike files
+ */
+
+
+#include "spikeFile.hpp"
+#include "asyncSpikeWriter.hpp"
+#include "gtest/gtest.h"
+#include <vector>
+#include <fstream>
+#include <sstream>
+#include <cstdio>
+#include <thread>
+#include <chrono>
+
+/** BinaryMatchesText
+ *  @test BinaryMatchesText
+ *  @note writes the same spikes (empty steps, ids above 2^14, a gap between the steps
+ *  	  and more steps than a chunk) in both formats, then converts the binary file
+ *  @brief the reader should give back every spike and the converted file should be the text one
+ *  @throw error if one spike or one character differs
+ */
+TEST (SpikeFile, BinaryMatchesText) {
+
+	const long firstStep(1000);
+	std::vector<std::vector<int>> steps(300);
+	for(size_t s(0); s < steps.size(); ++s){
+		for(int id(int(s)%7); id < 40000; id += 1 + int(s*s)%3001){
+			steps[s].push_back(id);
+		}
+	}
+
+	{
+		TextSpikeWriter text("spikeFile_unittest.txt", h);
+		BinarySpikeWriter binary("spikeFile_unittest.bin", h, 40000, 64);
+		for(size_t s(0); s < steps.size(); ++s){
+			long step(firstStep + s + (s >= 200 ? 50 : 0));
+			text.writeStep(step, steps[s].data(), steps[s].size());
+			binary.writeStep(step, steps[s].data(), steps[s].size());
+		}
+	}
+
+	{
+		SpikeReader reader("spikeFile_unittest.bin");
+		EXPECT_EQ(h, reader.getH());
+		EXPECT_EQ(40000, reader.getNeurons());
+
+		size_t s(0);
+		std::vector<int> ids;
+		for(size_t c(0); c < reader.chunkCount(); ++c){
+			SpikeReader::Chunk chunk(reader.chunk(c));
+			EXPECT_LE(chunk.steps, 64u);
+			for(uint32_t k(0); k < chunk.steps; ++k, ++s){
+				EXPECT_EQ(long(firstStep + s + (s >= 200 ? 50 : 0)), chunk.firstStep + k);
+				SpikeReader::readStep(chunk, k, ids);
+				ASSERT_EQ(steps[s], ids) << "step " << s;
+			}
+		}
+		EXPECT_EQ(steps.size(), s);
+	}
+
+	convertToText("spikeFile_unittest.bin", "spikeFile_unittest_converted.txt");
+
+	std::stringstream text, converted;
+	text << std::ifstream("spikeFile_unittest.txt").rdbuf();
+	converted << std::ifstream("spikeFile_unittest_converted.txt").rdbuf();
+	EXPECT_EQ(text.str(), converted.str());
+
+	std::remove("spikeFile_unittest.txt");
+	std::remove("spikeFile_unittest.bin");
+	std::remove("spikeFile_unittest_converted.txt");
+}
+
+/** StepsRecorder
+ *  keeps the spikes it receives, slowly, so that the pages pile up
+ */
+class StepsRecorder : public SpikeWriter
+{
+	public :
+
+		StepsRecorder(std::vector<long>& steps, std::vector<std::vector<int>>& ids)
+			: steps(steps), ids(ids) {}
+
+		void writeStep(long step, const int* first, size_t count) override
+		{
+			if(step%50 == 0) std::this_thread::sleep_for(std::chrono::milliseconds(1));
+			steps.push_back(step);
+			ids.push_back(std::vector<int>(first, first + count));
+		}
+
+	private :
+
+		std::vector<long>& steps;
+		std::vector<std::vector<int>>& ids;
+};
+
+/** AsyncKeepsEverySpike
+ *  @test AsyncKeepsEverySpike
+ *  @note writes 2000 steps through a background writer of two pages of 100 spikes,
+ *  	  with a step larger than a page, to a writer slower than the simulation
+ *  @brief once the writer is destroyed, every step should be written once, in order
+ *  @throw error if a step is lost, duplicated or changed
+ */
+TEST (SpikeFile, AsyncKeepsEverySpike) {
+
+	std::vector<long> steps;
+	std::vector<std::vector<int>> ids;
+	long stalls;
+
+	{
+		AsyncSpikeWriter writer(new StepsRecorder(steps, ids), 0, 100);
+		std::vector<int> spikes;
+		for(long step(0); step < 2000; ++step){
+			spikes.assign(step == 1000 ? 250 : step%9, int(step));
+			writer.writeStep(step, spikes.data(), spikes.size());
+		}
+		stalls = writer.getStalls();
+	}
+
+	ASSERT_EQ(2000u, steps.size());
+	for(long step(0); step < 2000; ++step){
+		EXPECT_EQ(step, steps[step]);
+		EXPECT_EQ(std::vector<int>(step == 1000 ? 250 : step%9, int(step)), ids[step]);
+	}
+	EXPECT_GT(stalls, 0);
+}
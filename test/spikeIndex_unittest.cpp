@@ -0,0 +1,166 @@
+/**
+ * @file   spikeIndex_unittest.cpp
+ * @author Jonathan Haab
+ * @date   Automn, 2017
+ * @brief  Contains the googletests of the indexed spike files
+ */
+
+
+#include "spikeIndex.hpp"
+#include "network.hpp"
+#include "gtest/gtest.h"
+#include <vector>
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <cstdio>
+
+/** IndexedQueries
+ *  @test IndexedQueries
+ *  @note writes spikes (empty steps, ids out of order, a gap of several buckets,
+ *  	  more steps than a bucket) in the indexed format, directly and from a
+ *  	  binary file, then queries ranges of neurons in windows that cut the buckets
+ *  @brief every query should give exactly the spikes and the counts of the
+ *  	   recorded ones, in the order of the spike files
+ *  @throw error if one spike or one count differs
+ */
+TEST (SpikeIndex, IndexedQueries) {
+
+	const int neurons(5000);
+	std::vector<SpikeEvent> recorded;
+
+	{
+		IndexedSpikeWriter indexed("spikeIndex_unittest.idx", h, neurons, 64);
+		BinarySpikeWriter binary("spikeIndex_unittest.bin", h, neurons, 50);
+		std::vector<int> ids;
+
+		for(long s(0); s < 400; ++s){
+
+			long step(100 + s + (s >= 300 ? 1000 : 0));
+			ids.clear();
+			for(int id(int(s)%11); id < neurons; id += 1 + int(s*s)%301) ids.push_back(id);
+			if(s%5 == 0) ids.clear();
+			if(s%7 == 0 and ids.size() > 2) std::swap(ids[0], ids[2]);
+
+			indexed.writeStep(step, ids.data(), ids.size());
+			binary.writeStep(step, ids.data(), ids.size());
+
+			std::vector<int> sorted(ids);
+			std::sort(sorted.begin(), sorted.end());
+			for(size_t k(0); k < sorted.size(); ++k) recorded.push_back(SpikeEvent{step, sorted[k]});
+		}
+	}
+	indexSpikes("spikeIndex_unittest.bin", "spikeIndex_unittest_converted.idx", 64);
+
+	std::stringstream direct, converted;
+	direct << std::ifstream("spikeIndex_unittest.idx", std::ios::binary).rdbuf();
+	converted << std::ifstream("spikeIndex_unittest_converted.idx", std::ios::binary).rdbuf();
+	EXPECT_EQ(direct.str(), converted.str());
+
+	{
+		SpikeIndex index("spikeIndex_unittest.idx");
+		EXPECT_EQ(h, index.getH());
+		EXPECT_EQ(neurons, index.getNeurons());
+		EXPECT_EQ(64, index.getBucketSteps());
+		EXPECT_EQ(recorded.size(), index.spikeCount());
+		EXPECT_EQ(64, index.firstStep());
+		EXPECT_EQ(1536, index.endStep());
+
+		const int ranges[][2] = {{0, neurons}, {0, 30}, {1234, 1300}, {4990, 6000}, {-5, 3}, {40, 40}};
+		const long windows[][2] = {{0, 2000}, {100, 164}, {130, 131}, {150, 1300}, {390, 1390}, {500, 1200}, {200, 100}};
+
+		for(const auto& range : ranges){
+			for(const auto& window : windows){
+
+				std::vector<SpikeEvent> expected;
+				std::vector<uint64_t> expectedCounts(std::max(range[1] - range[0], 0), 0);
+				for(size_t k(0); k < recorded.size(); ++k){
+					const SpikeEvent& spike(recorded[k]);
+					if(spike.id >= range[0] and spike.id < range[1] and spike.step >= window[0] and spike.step < window[1]){
+						expected.push_back(spike);
+						expectedCounts[spike.id - range[0]] += 1;
+					}
+				}
+
+				std::vector<SpikeEvent> spikes;
+				std::vector<uint64_t> counts;
+				index.spikes(range[0], range[1], window[0], window[1], spikes);
+				index.counts(range[0], range[1], window[0], window[1], counts);
+
+				ASSERT_EQ(expected.size(), spikes.size()) << range[0] << " " << range[1] << " " << window[0] << " " << window[1];
+				for(size_t k(0); k < spikes.size(); ++k){
+					EXPECT_EQ(expected[k].step, spikes[k].step);
+					EXPECT_EQ(expected[k].id, spikes[k].id);
+				}
+				EXPECT_EQ(expectedCounts, counts) << range[0] << " " << range[1] << " " << window[0] << " " << window[1];
+			}
+		}
+	}
+
+	EXPECT_THROW(SpikeIndex("spikeIndex_unittest.bin"), std::runtime_error);
+
+	std::remove("spikeIndex_unittest.idx");
+	std::remove("spikeIndex_unittest.bin");
+	std::remove("spikeIndex_unittest_converted.idx");
+}
+
+/** NetworkWritesIndexed
+ *  @test NetworkWritesIndexed
+ *  @note simulates the same network with the binary and with the indexed format
+ *  @brief the indexed file should give back every spike of the binary one
+ *  @throw error if one spike differs
+ */
+TEST (SpikeIndex, NetworkWritesIndexed) {
+
+	Parameters parameters;
+	parameters.N = 2000;
+	parameters.batch = "5:2";
+	parameters.seed = 7;
+	parameters.randomSeed = false;
+	parameters.stopTime = 300;
+	parameters.plotStartTime = 100;
+	parameters.plotStopTime = 300;
+
+	const SpikeFormat formats[] = {BINARY, INDEXED};
+	const char* files[] = {"spikeIndex_unittest.bin", "spikeIndex_unittest.idx"};
+
+	for(int f(0); f < 2; ++f){
+		parameters.format = formats[f];
+		Network network(files[f], parameters);
+		double simStep(network.getStep()), totalSteps(parameters.totalSteps());
+
+		while(simStep < totalSteps){
+			simStep = std::min(simStep + network.getWindow(), totalSteps);
+			network.update(simStep);
+		}
+	}
+
+	std::vector<SpikeEvent> written;
+	{
+		SpikeReader reader(files[0]);
+		std::vector<int> ids;
+		for(size_t c(0); c < reader.chunkCount(); ++c){
+			SpikeReader::Chunk chunk(reader.chunk(c));
+			for(uint32_t s(0); s < chunk.steps; ++s){
+				SpikeReader::readStep(chunk, s, ids);
+				for(size_t k(0); k < ids.size(); ++k) written.push_back(SpikeEvent{chunk.firstStep + s, ids[k]});
+			}
+		}
+	}
+	ASSERT_LT(100u, written.size());
+
+	{
+		SpikeIndex index(files[1]);
+		std::vector<SpikeEvent> spikes;
+		index.spikes(0, parameters.N, index.firstStep(), index.endStep(), spikes);
+
+		ASSERT_EQ(written.size(), spikes.size());
+		for(size_t k(0); k < spikes.size(); ++k){
+			EXPECT_EQ(written[k].step, spikes[k].step);
+			EXPECT_EQ(written[k].id, spikes[k].id);
+		}
+	}
+
+	std::remove(files[0]);
+	std::remove(files[1]);
+}
@@ -0,0 +1,90 @@
+/**
+ * @file   spikeRaster_unittest.cpp
+ * @author Jonathan Haab
+ * @date   Automn, 2017
+ * @brief  Contains the googletests of the spike raster
+ */
+
+
+#include "spikeRaster.hpp"
+#include "gtest/gtest.h"
+#include <vector>
+
+/** LogsAndRetention
+ *  @test LogsAndRetention
+ *  @note appends the spikes of 10 neurons in 2 logs, merges them in 3 logs after 100 steps,
+ *  	  then appends 100 more steps, with a retention of 150 steps
+ *  @brief every neuron should get back its spikes of the last 150 steps, in increasing order
+ *  @throw error if a spike is lost, duplicated or kept after the retention
+ */
+TEST (SpikeRaster, LogsAndRetention) {
+
+	SpikeRaster raster(10, 150);
+	raster.setLogs(2);
+	std::vector<std::vector<long>> expected(10);
+
+	for(long step(0); step < 200; ++step){
+
+		if(step == 100) raster.setLogs(3);
+		int logs(step < 100 ? 2 : 3);
+
+		// le neurone i spike tous les i+1 steps, les neurones sont répartis entre les logs
+		for(int l(0); l < logs; ++l){
+			std::vector<int> ids;
+			for(int i(l*10/logs); i < (l+1)*10/logs; ++i){
+				if(step%(i+1) == 0){
+					ids.push_back(i);
+					if(step >= 50) expected[i].push_back(step);
+				}
+			}
+			raster.append(l, step, ids.data(), ids.size());
+		}
+	}
+
+	for(int i(0); i < 10; ++i){
+		SpikeTimes times(raster.spikesOf(i));
+		EXPECT_EQ(expected[i], std::vector<long>(times.begin(), times.end())) << "neuron " << i;
+	}
+	EXPECT_LT(raster.bytes(), size_t(20000));
+}
+
+/** BoundedRing
+ *  @test BoundedRing
+ *  @note appends the spikes of 100 neurons that spike as soon as their refractory time
+ *  	  of 20 steps is over, in 4 logs, for 5000 steps with a retention of 1000 steps
+ *  @brief the logs should be allocated once : the memory after the first window
+ *  	   should stay the same, and the last 1000 steps of every neuron be kept
+ *  @throw error if the memory changes or a spike is lost
+ */
+TEST (SpikeRaster, BoundedRing) {
+
+	SpikeRaster raster(100, 1000, 20);
+	raster.setLogs(4);
+	std::vector<int> ids;
+	size_t bytes(0);
+
+	for(long step(0); step < 5000; ++step){
+
+		if(step == 1000){
+			raster.spikesOf(0);
+			bytes = raster.bytes();
+		}
+		for(int l(0); l < 4; ++l){
+			// le neurone i spike aux steps i modulo 21
+			ids.clear();
+			for(int i(l*25); i < (l+1)*25; ++i){
+				if(step%21 == i%21) ids.push_back(i);
+			}
+			raster.append(l, step, ids.data(), ids.size());
+		}
+	}
+
+	for(int i(0); i < 100; ++i){
+		SpikeTimes times(raster.spikesOf(i));
+		ASSERT_FALSE(times.empty());
+		EXPECT_EQ(4999 - (4999 - i%21)%21, times.back()) << "neuron " << i;
+		EXPECT_LE(4000, times[0]) << "neuron " << i;
+		EXPECT_GT(4021, times[0]) << "neuron " << i;
+	}
+	EXPECT_EQ(bytes, raster.bytes());
+}
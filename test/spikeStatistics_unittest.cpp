@@ -0,0 +1,170 @@
+/**
+ * @file   spikeStatistics_unittest.cpp
+ * @author Jonathan Haab
+ * @date   Automn, 2017
+ * @brief  Contains the googletests of the statistics of the spikes
+ */
+
+
+#include "spikeStatistics.hpp"
+#include "network.hpp"
+#include "gtest/gtest.h"
+#include <vector>
+#include <random>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <cstdio>
+
+/** RegularNeuron
+ *  @test RegularNeuron
+ *  @note the excitatory neuron 0 spikes every 100 steps of 0.1 ms during one second,
+ *  	  the inhibitory neuron 3 never spikes
+ *  @brief the neuron 0 should spike at 100 Hz, 50 Hz for its population of two, with a CV and a Fano factor of 0
+ *  @throw error if a statistic is wrong
+ */
+TEST (SpikeStatistics, RegularNeuron) {
+
+	SpikeStatistics statistics(4, 2, 0.1, 10, 1000);
+	int spiking(0);
+
+	for(long step(1); step <= 10000; ++step){
+		statistics.record(step, &spiking, step%100 == 0 ? 1 : 0);
+	}
+
+	PopulationSummary excitatory(statistics.summary(true));
+	EXPECT_EQ(2, excitatory.neurons);
+	EXPECT_EQ(100, excitatory.spikes);
+	EXPECT_NEAR(50, excitatory.rate, 1e-9);
+	EXPECT_NEAR(50, excitatory.rateStd, 1e-9);
+	EXPECT_EQ(1, excitatory.cvNeurons);
+	EXPECT_NEAR(0, excitatory.cv, 1e-9);
+	EXPECT_EQ(1, excitatory.fanoNeurons);
+	EXPECT_NEAR(0, excitatory.fano, 1e-9);
+
+	PopulationSummary inhibitory(statistics.summary(false));
+	EXPECT_EQ(0, inhibitory.spikes);
+	EXPECT_EQ(0, inhibitory.rate);
+	EXPECT_EQ(0, inhibitory.cvNeurons);
+
+	// Un bin de 10 steps sur 10 contient un spike : 1 spike / (2 neurones * 1 ms)
+	std::vector<double> rates(statistics.populationRate(true));
+	ASSERT_EQ(1000u, rates.size());
+	EXPECT_NEAR(0, rates[0], 1e-9);
+	EXPECT_NEAR(500, rates[9], 1e-9);
+}
+
+/** PoissonNeurons
+ *  @test PoissonNeurons
+ *  @note 100 neurons spike independently with a probability 0.01 at each of 100000 steps
+ *  @brief the CV and the Fano factor should be close to the ones of a Poisson process, 1
+ *  @throw error if the CV or the Fano factor are not within 5 %
+ */
+TEST (SpikeStatistics, PoissonNeurons) {
+
+	const int neurons(100);
+	SpikeStatistics statistics(neurons, 80, 0.1, 10, 1000);
+	std::mt19937 generator(3);
+	std::bernoulli_distribution spike(0.01);
+	std::vector<int> ids;
+
+	for(long step(0); step < 100000; ++step){
+		ids.clear();
+		for(int i(0); i < neurons; ++i){
+			if(spike(generator)) ids.push_back(i);
+		}
+		statistics.record(step, ids.data(), ids.size());
+	}
+
+	for(int population(0); population < 2; ++population){
+		PopulationSummary summary(statistics.summary(population == 1));
+		EXPECT_NEAR(100, summary.rate, 5);
+		EXPECT_NEAR(1, summary.cv, 0.05);
+		EXPECT_NEAR(1, summary.fano, 0.05);
+	}
+}
+
+/** SameSpikesAsFile
+ *  @test SameSpikesAsFile
+ *  @note simulates 200 ms of a network of 1000 neurons with a spike file and
+ *  	  statistics, then without the spike file
+ *  @brief the statistics should count every spike of the file, and be the same without it
+ *  @throw error if a spike is missing or the statistics differ
+ */
+TEST (SpikeStatistics, SameSpikesAsFile) {
+
+	Parameters parameters;
+	parameters.N = 1000;
+	parameters.connectionRatio = 0.1;
+	parameters.seed = 5;
+	parameters.plotStartTime = 0;
+	parameters.plotStopTime = 1e9;
+	parameters.statistics = "spikeStatistics_unittest_file.txt";
+
+	{
+		Network network("spikeStatistics_unittest_spikes.txt", parameters);
+		network.update(2000);
+		network.writeStatistics();
+	}
+
+	parameters.format = NO_SPIKE_FILE;
+	parameters.statistics = "spikeStatistics_unittest_none.txt";
+	{
+		Network network("spikeStatistics_unittest_missing.txt", parameters);
+		network.update(2000);
+		network.writeStatistics();
+	}
+	EXPECT_FALSE(std::ifstream("spikeStatistics_unittest_missing.txt").good());
+
+	long lines(0), spikes(0);
+	std::string line;
+	std::ifstream file("spikeStatistics_unittest_spikes.txt");
+	while(std::getline(file, line)) ++lines;
+
+	std::ifstream summary("spikeStatistics_unittest_file.txt");
+	while(std::getline(summary, line)){
+		std::istringstream in(line);
+		std::string key, equal;
+		long value;
+		if(in >> key >> equal >> value and (key == "excitatory.spikes" or key == "inhibitory.spikes")) spikes += value;
+	}
+
+	EXPECT_GT(lines, 100);
+	EXPECT_EQ(lines, spikes);
+
+	std::ostringstream withFile, withoutFile;
+	withFile << std::ifstream("spikeStatistics_unittest_file.txt").rdbuf();
+	withoutFile << std::ifstream("spikeStatistics_unittest_none.txt").rdbuf();
+	EXPECT_TRUE(withFile.str() == withoutFile.str());
+
+	std::remove("spikeStatistics_unittest_spikes.txt");
+	std::remove("spikeStatistics_unittest_file.txt");
+	std::remove("spikeStatistics_unittest_none.txt");
+}
+
+/** DefaultRecording
+ *  @test DefaultRecording
+ *  @note simulates a network of 1000 neurons up to the end of the default recording,
+ *  	  from 1000 to 1200 ms whose last step is not recorded, with Fano windows of 100 ms
+ *  @brief both windows should count : the Fano factors should not be 0
+ *  @throw error if a Fano factor is 0
+ */
+TEST (SpikeStatistics, DefaultRecording) {
+
+	Parameters parameters;
+	parameters.N = 1000;
+	parameters.connectionRatio = 0.1;
+	parameters.seed = 5;
+	parameters.format = NO_SPIKE_FILE;
+	parameters.statistics = "spikeStatistics_unittest_default.txt";
+
+	Network network("spikeStatistics_unittest_default_spikes.txt", parameters);
+	network.update(parameters.plotStopTime/parameters.h);
+
+	for(int population(0); population < 2; ++population){
+		PopulationSummary summary(network.getStatistics()->summary(population == 1));
+		EXPECT_GT(summary.spikes, 0);
+		EXPECT_GT(summary.fanoNeurons, 0);
+		EXPECT_GT(summary.fano, 0);
+	}
+}
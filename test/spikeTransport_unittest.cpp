@@ -0,0 +1,111 @@
+/**
+ * @file   spikeTransport_unittest.cpp
+ * @author Jonathan Haab
+ * @date   Automn, 2017
+ * @brief  Contains the googletests of the distributed simulation
+ */
+
+
+#include "spikeTransport.hpp"
+#include "network.hpp"
+#include "gtest/gtest.h"
+#include <vector>
+#include <thread>
+#include <fstream>
+#include <sstream>
+#include <cstdio>
+
+/** SocketAllGather
+ *  @test SocketAllGather
+ *  @note three ranks, run by three threads, gather three times values of different sizes
+ *  @brief every rank should receive the values of every rank, in the order of the ranks
+ *  @throw error if one value is lost or misplaced
+ */
+TEST (SpikeTransport, SocketAllGather) {
+
+	const int ranks(3);
+	std::vector<std::vector<std::vector<int>>> received(ranks);
+	std::vector<std::thread> processes;
+
+	for(int r(0); r < ranks; ++r){
+		processes.push_back(std::thread([r, &received](){
+
+			SocketTransport transport("spikeTransport_unittest.sock", r, ranks);
+			EXPECT_EQ(r, transport.getRank());
+
+			for(int round(0); round < 3; ++round){
+				std::vector<int> sent(r*round);
+				for(size_t k(0); k < sent.size(); ++k) sent[k] = 100*r + k;
+
+				transport.allGather(sent, received[r]);
+			}
+		}));
+	}
+	for(int r(0); r < ranks; ++r) processes[r].join();
+
+	for(int r(0); r < ranks; ++r){
+		ASSERT_EQ(size_t(ranks), received[r].size());
+		for(int q(0); q < ranks; ++q){
+			ASSERT_EQ(size_t(2*q), received[r][q].size());
+			for(size_t k(0); k < received[r][q].size(); ++k){
+				EXPECT_EQ(int(100*q + k), received[r][q][k]);
+			}
+		}
+	}
+}
+
+/** SameSpikesAsSingleProcess
+ *  @test SameSpikesAsSingleProcess
+ *  @note simulates 300 ms of a network of 1000 neurons in one process, then
+ *  	  split in three ranks connected by a unix socket, for both connectivities
+ *  @brief the spike files should be exactly the same
+ *  @throw error if a spike differs
+ */
+TEST (SpikeTransport, SameSpikesAsSingleProcess) {
+
+	for(int mode(STORED); mode < connectivityModeSize; ++mode){
+
+		Parameters parameters;
+		parameters.N = 1000;
+		parameters.connectionRatio = 0.1;
+		parameters.connectivity = ConnectivityMode(mode);
+		parameters.seed = 3;
+		parameters.plotStartTime = 0;
+		parameters.plotStopTime = 1e9;
+		parameters.format = BINARY;
+		parameters.socket = "spikeTransport_unittest.sock";
+
+		{
+			Network single("spikeTransport_unittest_single.bin", parameters);
+			single.update(3000);
+		}
+
+		const int ranks(3);
+		std::vector<std::thread> processes;
+
+		for(int r(0); r < ranks; ++r){
+			processes.push_back(std::thread([r, parameters](){
+
+				Parameters rank(parameters);
+				rank.ranks = ranks;
+				rank.rank = r;
+				rank.threads = 2;
+
+				Network network("spikeTransport_unittest_ranks.bin", rank);
+				EXPECT_EQ(r, network.getRank());
+				network.update(3000);
+			}));
+		}
+		for(int r(0); r < ranks; ++r) processes[r].join();
+
+		std::ostringstream single, distributed;
+		single << std::ifstream("spikeTransport_unittest_single.bin").rdbuf();
+		distributed << std::ifstream("spikeTransport_unittest_ranks.bin").rdbuf();
+
+		EXPECT_GT(single.str().size(), 1000u);
+		EXPECT_TRUE(single.str() == distributed.str());
+
+		std::remove("spikeTransport_unittest_single.bin");
+		std::remove("spikeTransport_unittest_ranks.bin");
+	}
+}
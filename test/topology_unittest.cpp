@@ -0,0 +1,113 @@
+/**
+ * @file   topology_unittest.cpp
+ * @author Jonathan Haab
+ * @date   Automn, 2017
+ * @brief  Contains the googletests of the topology and of the placement of the threads
+ */
+
+
+#include "topology.hpp"
+#include "network.hpp"
+#include "gtest/gtest.h"
+#include <vector>
+#include <string>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <cstdio>
+
+/** CpuLists
+ *  @test CpuLists
+ *  @note reads the lists of cpus written by linux in /sys/devices/system/node
+ *  @brief every range should be expanded and sorted, a wrong list should throw
+ *  @throw error if a cpu is missing or a wrong list is accepted
+ */
+TEST (Topology, CpuLists) {
+
+	EXPECT_EQ(std::vector<int>({0, 1, 2, 3, 8, 10, 11}), Topology::parseCpuList("0-3,8,10-11\n"));
+	EXPECT_EQ(std::vector<int>({5}), Topology::parseCpuList("5"));
+	EXPECT_TRUE(Topology::parseCpuList("\n").empty());
+	EXPECT_THROW(Topology::parseCpuList("3-1"), std::invalid_argument);
+	EXPECT_THROW(Topology::parseCpuList("a"), std::invalid_argument);
+
+	// La machine a au moins un nœud d'au moins un cpu
+	Topology machine;
+	ASSERT_GE(machine.nodes(), 1);
+	EXPECT_FALSE(machine.cpusOf(0).empty());
+}
+
+/** ThreadsOverNodes
+ *  @test ThreadsOverNodes
+ *  @note places 2, 4 and 12 threads on two nodes of 4 cpus
+ *  @brief the threads should fill the nodes in contiguous groups, one cpu each while there are enough
+ *  @throw error if a thread is on the wrong node or cpu
+ */
+TEST (Topology, ThreadsOverNodes) {
+
+	Topology topology({{0, 1, 2, 3}, {4, 5, 6, 7}});
+	ASSERT_EQ(2, topology.nodes());
+
+	EXPECT_EQ(std::vector<int>({0, 1}), topology.threadNodes(2));
+	EXPECT_EQ(std::vector<int>({0, 4}), topology.threadCpus(2));
+	EXPECT_EQ(std::vector<int>({0, 0, 1, 1}), topology.threadNodes(4));
+	EXPECT_EQ(std::vector<int>({0, 1, 4, 5}), topology.threadCpus(4));
+
+	std::vector<int> cpus(topology.threadCpus(12));
+	std::vector<int> nodes(topology.threadNodes(12));
+	ASSERT_EQ(12u, cpus.size());
+	for(int t(0); t < 12; ++t){
+		EXPECT_EQ(t < 6 ? 0 : 1, nodes[t]);
+		EXPECT_EQ(nodes[t], cpus[t]/4);
+	}
+}
+
+/** PlacedNetwork
+ *  @test PlacedNetwork
+ *  @note simulates 30 ms of a network of 10000 neurons with 3 threads, pinned on the
+ *  	  nodes with huge pages and without, for both connectivities
+ *  @brief the placement only moves the memory : the spikes should be exactly the same,
+ *  	   and the report should give a line for each thread
+ *  @throw error if a spike differs or the report misses a thread
+ */
+TEST (Topology, PlacedNetwork) {
+
+	for(int mode(STORED); mode < connectivityModeSize; ++mode){
+
+		Parameters parameters;
+		parameters.N = 10000;
+		parameters.connectionRatio = 0.005;
+		parameters.connectivity = ConnectivityMode(mode);
+		parameters.seed = 11;
+		parameters.threads = 3;
+		parameters.plotStartTime = 0;
+		parameters.plotStopTime = 1e9;
+		parameters.format = BINARY;
+		parameters.set("batch", "5:2");
+
+		{
+			Network network("topology_unittest_default.bin", parameters);
+			network.update(300);
+		}
+
+		parameters.numa = true;
+		parameters.hugePages = true;
+		std::ostringstream report;
+		{
+			Network network("topology_unittest_placed.bin", parameters);
+			network.writePlacement(report);
+			network.update(300);
+		}
+
+		std::ostringstream unplaced, placed;
+		unplaced << std::ifstream("topology_unittest_default.bin").rdbuf();
+		placed << std::ifstream("topology_unittest_placed.bin").rdbuf();
+
+		EXPECT_GT(unplaced.str().size(), 1000u);
+		EXPECT_TRUE(unplaced.str() == placed.str());
+		EXPECT_NE(std::string::npos, report.str().find("thread 2 : cpu "));
+		EXPECT_NE(std::string::npos, report.str().find("huge pages : advised"));
+
+		std::remove("topology_unittest_default.bin");
+		std::remove("topology_unittest_placed.bin");
+	}
+}